@@ -3,89 +3,174 @@
 #include <hb-ft.h> // HarfBuzz FreeType integration
 #include <hb.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <filesystem>
 #include <iomanip>
+#include <limits>
+#include <mutex>
+#include <numeric>
 #include <string>
+#include <thread>
 
+#include "AtlasService.h"
+#include "DynamicAtlas.h"
+#include "Effects.h"
+#include "FontFileRegistry.h"
 #include "FontInfo.h"
 #include "ProgramOptions.h"
+#include "TextureFile.h"
+#include "UnicodeBlocks.h"
 #include "external/lodepng/lodepng.h"
 #include "utils/extractFileName.h"
 #include "utils/getNumberLen.h"
 
 // TODO: read .bmfc files (BMFont configuration file)
 
-std::set<std::uint32_t> App::collectAllChars(const ft::Font& font) {
+CharSet App::collectAllChars(const ft::Font& font) {
     return font.collectChars();
 }
 
+// Metrics of the subpixel phases 1..phases-1 of every visible glyph (phase 0 is the glyph as collected).
+void App::collectSubpixelPhases(Glyphs &glyphs, const FontChain &fonts, const std::uint32_t phases, Stats &stats)
+{
+    if (phases < 2)
+        return;
+
+    const auto phase = stats.phase("subpixel phases");
+    for (auto &kv : glyphs)
+    {
+        auto &glyph = kv.second;
+        if (glyph.isEmpty())
+            continue;
+        const auto &glyphFont = fonts[glyph.font];
+        glyph.phases.resize(phases);
+        glyph.phases[0].width = glyph.width;
+        glyph.phases[0].xOffset = glyph.xOffset;
+        for (std::uint32_t p = 1; p < phases; ++p)
+        {
+            const auto metrics = glyphFont.renderGlyph(nullptr, 0, 0, 0, 0, getGlyphIndex(kv.first), 0, static_cast<int>(p * 64 / phases));
+            glyph.phases[p].width = metrics.width;
+            glyph.phases[p].xOffset = metrics.horiBearingX;
+            stats.addCounter("glyph metrics loads", 1);
+        }
+    }
+}
+
+// Width of one cell of the phase row, the widest phase decides (phases differ by a column at most).
+std::uint32_t App::getPhaseCellWidth(const GlyphInfo &glyph, const std::uint32_t additionalWidth, const Config &config)
+{
+    const auto cellSize = config.getMipmapCellSize();
+    const auto gutter = config.getMipmapGutter();
+    const auto alignmentHor = std::lcm(config.alignment.hor, cellSize);
+
+    std::uint32_t width = glyph.width;
+    for (const auto &phase : glyph.phases)
+        width = std::max(width, phase.width);
+    width += additionalWidth + gutter;
+    return ((width + alignmentHor - 1) / alignmentHor) * alignmentHor;
+}
+
 std::vector<rbp::RectSize> App::getGlyphRectangles(const Glyphs &glyphs, const std::uint32_t additionalWidth, const std::uint32_t additionalHeight,
                                                    const Config &config)
 {
+    // Mipmap layout: cells on the grid of the smallest level, with a gutter covering the filter reach,
+    // so glyphs never share (or filter into) a texel of any level.
+    const auto cellSize = config.getMipmapCellSize();
+    const auto gutter = config.getMipmapGutter();
+    const auto alignmentHor = std::lcm(config.alignment.hor, cellSize);
+    const auto alignmentVer = std::lcm(config.alignment.ver, cellSize);
+
     std::vector<rbp::RectSize> result;
     for (const auto &kv : glyphs)
     {
         const auto &glyphInfo = kv.second;
-        if (!glyphInfo.isEmpty())
+        if (!glyphInfo.isEmpty() && !glyphInfo.phases.empty())
+        {
+            // All phases of a glyph share a row, so they cost one rectangle and one height
+            auto height = glyphInfo.height + additionalHeight + gutter;
+            height = ((height + alignmentVer - 1) / alignmentVer) * alignmentVer;
+            const auto width = getPhaseCellWidth(glyphInfo, additionalWidth, config) * static_cast<std::uint32_t>(glyphInfo.phases.size());
+            result.emplace_back(width, height, kv.first);
+        }
+        else if (!glyphInfo.isEmpty())
         {
-            auto width = glyphInfo.width + additionalWidth;
-            auto height = glyphInfo.height + additionalHeight;
-            width = ((width + config.alignment.hor - 1) / config.alignment.hor) * config.alignment.hor;
-            height = ((height + config.alignment.ver - 1) / config.alignment.ver) * config.alignment.ver;
+            auto width = glyphInfo.width + additionalWidth + gutter;
+            auto height = glyphInfo.height + additionalHeight + gutter;
+            width = ((width + alignmentHor - 1) / alignmentHor) * alignmentHor;
+            height = ((height + alignmentVer - 1) / alignmentVer) * alignmentVer;
             result.emplace_back(width, height, kv.first);
         }
     }
     return result;
 }
 
-std::set<std::tuple<std::uint32_t, std::uint32_t, bool>> App::shapeGlyphs(const ft::Font &font, const ft::Font &secondaryFont, const std::set<std::uint32_t> &utf32codes, bool tabularNumbers,
-                                                                          bool slashedZero)
+std::string App::formatCharRanges(const CharSet &chars)
 {
+    const size_t maxRanges = 16;
 
-    std::vector<uint32_t> utf32codesVector;
-    std::set<std::tuple<std::uint32_t, std::uint32_t, bool>> shaped_glyphs;
-
-    for (const auto &id : utf32codes)
+    std::stringstream ss;
+    size_t count = 0;
+    for (const auto &r : chars.ranges())
     {
-        bool glyphIndexFound = false;
-        // Handle numbers only for tabular case
-        if (id >= 0x30 && id <= 0x39)
-        {
-            utf32codesVector.push_back(id);
-            // Not good, we always assume we have numbers
-            glyphIndexFound = true;
-        }
-        else
+        if (count == maxRanges)
         {
-            FT_UInt glyphIndex = FT_Get_Char_Index(font.face, id);
-            if (glyphIndex == 0) 
-            {
-                if (secondaryFont.valid)
-                {
-                    glyphIndex = FT_Get_Char_Index(secondaryFont.face, id);
-                    if (glyphIndex) 
-                    {
-                        shaped_glyphs.insert({glyphIndex, id, true});
-                        glyphIndexFound = true;
-                    }
-                }
-            } 
-            else 
-            {
-                shaped_glyphs.insert({glyphIndex, id, false});
-                glyphIndexFound = true;
-            }
-        }
-        if (!glyphIndexFound) {
-            std::cout << "warning: glyph " << id << " not found";
-            if (id == 65279)
-                std::cout << " (it looks like Unicode byte order mark (BOM))";
-            std::cout << "." << std::endl;
+            ss << ", ... (" << chars.ranges().size() - maxRanges << " more ranges)";
+            break;
         }
+        if (count++)
+            ss << ", ";
+        ss << r.first;
+        if (r.last != r.first)
+            ss << "-" << r.last;
+    }
+    return ss.str();
+}
+
+void App::warnMissingChars(const CharSet &missing)
+{
+    if (missing.empty())
+        return;
+    std::stringstream ss;
+    ss << "warning: " << missing.size() << " glyph(s) not found: " << formatCharRanges(missing);
+    if (missing.contains(65279))
+        ss << " (65279 looks like Unicode byte order mark (BOM))";
+    ss << ".\n";
+
+    // --all-faces shapes on several threads, a warning is written in one piece
+    static std::mutex mutex;
+    const std::lock_guard<std::mutex> lock(mutex);
+    std::cout << ss.str();
+}
+
+App::ShapedGlyphs App::shapeGlyphs(const FontChain &fonts, const CharSet &utf32codes, bool tabularNumbers, bool slashedZero)
+{
+
+    std::vector<uint32_t> utf32codesVector;
+    ShapedGlyphs shaped_glyphs;
+
+    // Handle numbers only for tabular case
+    // Not good, we always assume we have numbers
+    CharSet digits;
+    digits.insert(0x30, 0x39);
+    digits = utf32codes.intersection(digits);
+    utf32codesVector.assign(digits.begin(), digits.end());
+
+    const auto requested = utf32codes.difference(digits);
+    CharSet found;
+    for (const auto &c : fonts.getCoverage(requested))
+    {
+        shaped_glyphs.insert({c.glyphIndex, c.utf32, c.font});
+        found.insert(c.utf32);
     }
 
+    warnMissingChars(requested.difference(found));
+
     if (utf32codesVector.size()) 
     {
-        hb_font_t *hb_font = hb_ft_font_create(font.face, nullptr);
+        hb_font_t *hb_font = fonts.primary().createHbFont();
         hb_buffer_t *hb_buffer = hb_buffer_create();
 
         for (auto id : utf32codesVector) 
@@ -122,7 +207,7 @@ std::set<std::tuple<std::uint32_t, std::uint32_t, bool>> App::shapeGlyphs(const
         for (unsigned int i = 0; i < glyph_count; i++)
         {
             hb_codepoint_t glyph_index = glyph_info[i].codepoint;
-            shaped_glyphs.insert({glyph_index, utf32codesVector[i], false});
+            shaped_glyphs.insert({glyph_index, utf32codesVector[i], 0});
         }
 
         hb_buffer_destroy(hb_buffer);
@@ -132,44 +217,223 @@ std::set<std::tuple<std::uint32_t, std::uint32_t, bool>> App::shapeGlyphs(const
     return shaped_glyphs;
 }
 
-App::Glyphs App::collectGlyphInfo(const ft::Font &font, const ft::Font &secondaryFont, const std::set<std::uint32_t> &utf32codes, bool tabularNumbers, bool slashedZero)
+App::Glyphs App::collectGlyphInfo(const FontChain &fonts, const CharSet &utf32codes, bool tabularNumbers, bool slashedZero, Stats &stats)
+{
+    ShapedGlyphs shaped_glyphs;
+    {
+        const auto phase = stats.phase("shape glyphs");
+        shaped_glyphs = shapeGlyphs(fonts, utf32codes, tabularNumbers, slashedZero);
+    }
+    stats.addCounter("requested chars", utf32codes.size());
+    stats.addCounter("shaped glyphs", shaped_glyphs.size());
+
+    return collectGlyphMetrics(shaped_glyphs, fonts, stats);
+}
+
+App::Glyphs App::collectGlyphMetrics(const ShapedGlyphs &shaped_glyphs, const FontChain &fonts, Stats &stats)
 {
     Glyphs result;
 
-    const auto shaped_glyphs = shapeGlyphs(font, secondaryFont, utf32codes, tabularNumbers, slashedZero);
+    const auto phase = stats.phase("glyph metrics");
     for (const auto &id : shaped_glyphs)
     {
         if (std::get<0>(id))
         {
             GlyphInfo glyphInfo;
-            ft::Font::GlyphMetrics glyphMetrics{};
-            if (std::get<2>(id) && secondaryFont.valid) {
-                glyphMetrics = secondaryFont.renderGlyph(nullptr, 0, 0, 0, 0, std::get<0>(id), 0);
-            } else {
-                glyphMetrics = font.renderGlyph(nullptr, 0, 0, 0, 0, std::get<0>(id), 0);
-            }
+            const auto glyphMetrics = fonts[std::get<2>(id)].renderGlyph(nullptr, 0, 0, 0, 0, std::get<0>(id), 0);
             glyphInfo.utf32 = std::get<1>(id);
             glyphInfo.width = glyphMetrics.width;
             glyphInfo.height = glyphMetrics.height;
             glyphInfo.xAdvance = glyphMetrics.horiAdvance;
             glyphInfo.xOffset = glyphMetrics.horiBearingX;
-            glyphInfo.yOffset = font.ascent - glyphMetrics.horiBearingY;
-            glyphInfo.secondaryFont = std::get<2>(id);
-            result[std::get<0>(id)] = glyphInfo;
+            glyphInfo.yOffset = fonts.primary().ascent - glyphMetrics.horiBearingY;
+            glyphInfo.font = std::get<2>(id);
+            glyphInfo.color = glyphMetrics.color;
+            result[getGlyphKey(std::get<2>(id), std::get<0>(id))] = glyphInfo;
+            stats.addCounter("glyph metrics loads", 1);
+        }
+    }
+
+    return result;
+}
+
+// Strings are split into runs of chars of the same font of the chain, each shaped with its script and
+// direction guessed by HarfBuzz and the default features (ligatures and contextual forms included).
+// Runs of fonts follow each other in logical order, there is no bidi reordering between them.
+std::vector<App::ShapedString> App::shapeStrings(const FontChain &fonts, const std::vector<std::u32string> &strings, bool tabularNumbers, bool slashedZero)
+{
+    std::vector<hb_font_t *> hbFonts(fonts.size(), nullptr);
+    hb_buffer_t *hb_buffer = hb_buffer_create();
+
+    hb_feature_t feature[2] = {};
+    feature[0].tag = HB_TAG('t', 'n', 'u', 'm');
+    feature[0].value = tabularNumbers ? 1 : 0;
+    feature[0].start = 0;
+    feature[0].end = (unsigned int)-1;
+    feature[1].tag = HB_TAG('z', 'e', 'r', 'o');
+    feature[1].value = slashedZero ? 1 : 0;
+    feature[1].start = 0;
+    feature[1].end = (unsigned int)-1;
+
+    std::vector<ShapedString> result;
+    result.reserve(strings.size());
+    for (const auto &text : strings)
+    {
+        const std::vector<std::uint32_t> utf32(text.begin(), text.end());
+        auto codes = utf32;
+        std::sort(codes.begin(), codes.end());
+        CharSet chars;
+        for (const auto code : codes)
+            chars.insert(code);
+        std::map<std::uint32_t, std::uint32_t> fontOfChar;
+        for (const auto &c : fonts.getCoverage(chars))
+            fontOfChar[c.utf32] = c.font;
+
+        // Chars missing in every font (and so shaped as .notdef) stay in the current run
+        const auto fontAt = [&](const std::size_t i, const std::uint32_t current)
+        {
+            const auto it = fontOfChar.find(utf32[i]);
+            return it == fontOfChar.end() ? current : it->second;
+        };
+
+        ShapedString shaped;
+        for (std::size_t start = 0; start < utf32.size();)
+        {
+            const auto font = fontAt(start, 0);
+            auto end = start + 1;
+            while (end < utf32.size() && fontAt(end, font) == font)
+                ++end;
+
+            if (!hbFonts[font])
+                hbFonts[font] = fonts[font].createHbFont();
+            hb_buffer_clear_contents(hb_buffer);
+            hb_buffer_add_utf32(hb_buffer, utf32.data(), static_cast<int>(utf32.size()), static_cast<unsigned int>(start), static_cast<int>(end - start));
+            hb_buffer_guess_segment_properties(hb_buffer);
+            hb_shape(hbFonts[font], hb_buffer, &feature[0], 2);
+
+            unsigned int glyph_count = 0;
+            const hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(hb_buffer, &glyph_count);
+            const hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(hb_buffer, &glyph_count);
+            for (unsigned int i = 0; i < glyph_count; ++i)
+            {
+                if (glyph_info[i].codepoint)
+                    shaped.glyphs.push_back({getGlyphKey(font, glyph_info[i].codepoint), shaped.advance + glyph_pos[i].x_offset, -glyph_pos[i].y_offset});
+                shaped.advance += glyph_pos[i].x_advance;
+            }
+            start = end;
         }
+        result.push_back(std::move(shaped));
     }
 
+    hb_buffer_destroy(hb_buffer);
+    for (const auto hbFont : hbFonts)
+        if (hbFont)
+            hb_font_destroy(hbFont);
     return result;
 }
 
-std::vector<Config::Size> App::arrangeGlyphs(Glyphs &glyphs, const Config &config)
+void App::addStringGlyphs(Glyphs &glyphs, const std::vector<ShapedString> &strings, const FontChain &fonts, Stats &stats)
+{
+    ShapedGlyphs missing;
+    for (const auto &s : strings)
+        for (const auto &g : s.glyphs)
+            if (!glyphs.contains(g.key))
+                missing.insert({getGlyphIndex(g.key), 0, g.key >> 24});
+
+    auto stringGlyphs = collectGlyphMetrics(missing, fonts, stats);
+    for (auto &kv : stringGlyphs)
+        kv.second.stringOnly = true;
+    stats.addCounter("string only glyphs", stringGlyphs.size());
+    glyphs.merge(stringGlyphs);
+}
+
+std::vector<Config::Size> App::arrangeGlyphs(Glyphs &glyphs, const Config &config, Stats &stats)
 {
+    if (config.textureArray)
+        return arrangeGlyphsInLayers(glyphs, config, stats);
+
+    // Each page group gets pages of its own, groups are ordered by their smallest char (string only glyphs last)
+    if (config.pageGroups != Config::PageGroups::None)
+    {
+        std::map<std::string, std::pair<std::uint64_t, Glyphs>> groups;
+        for (const auto &kv : glyphs)
+        {
+            auto &group = groups[getPageGroup(kv.second, config)];
+            if (group.second.empty())
+                group.first = std::numeric_limits<std::uint64_t>::max();
+            if (!kv.second.stringOnly)
+                group.first = std::min<std::uint64_t>(group.first, kv.second.utf32);
+            group.second.insert(kv);
+        }
+        std::vector<std::pair<std::uint64_t, Glyphs *>> orderedGroups;
+        for (auto &kv : groups)
+            orderedGroups.emplace_back(kv.second.first, &kv.second.second);
+        std::sort(orderedGroups.begin(), orderedGroups.end());
+
+        auto groupConfig = config;
+        groupConfig.pageGroups = Config::PageGroups::None;
+        std::vector<Config::Size> pages;
+        glyphs.clear();
+        for (const auto &group : orderedGroups)
+        {
+            const auto groupPages = arrangeGlyphs(*group.second, groupConfig, stats);
+            // Empty glyphs are not placed, they stay on page 0
+            for (auto &kv : *group.second)
+                if (!kv.second.isEmpty())
+                    kv.second.page += static_cast<std::uint32_t>(pages.size());
+            pages.insert(pages.end(), groupPages.begin(), groupPages.end());
+            glyphs.merge(*group.second);
+        }
+        stats.addCounter("page groups", groups.size());
+        return pages;
+    }
+
+    // Color glyphs get pages of their own, after the coverage pages
+    const auto isColor = [](const Glyphs::value_type &kv) { return kv.second.color; };
+    if (std::any_of(glyphs.begin(), glyphs.end(), isColor) && !std::all_of(glyphs.begin(), glyphs.end(), isColor))
+    {
+        Glyphs coverageGlyphs;
+        Glyphs colorGlyphs;
+        for (const auto &kv : glyphs)
+            (kv.second.color ? colorGlyphs : coverageGlyphs).insert(kv);
+
+        auto pages = arrangeGlyphs(coverageGlyphs, config, stats);
+        const auto colorPages = arrangeGlyphs(colorGlyphs, config, stats);
+        // Empty glyphs are not placed, they stay on page 0
+        for (auto &kv : colorGlyphs)
+            if (!kv.second.isEmpty())
+                kv.second.page += static_cast<std::uint32_t>(pages.size());
+        pages.insert(pages.end(), colorPages.begin(), colorPages.end());
+        stats.addCounter("color glyphs", colorGlyphs.size());
+
+        glyphs = std::move(coverageGlyphs);
+        glyphs.merge(colorGlyphs);
+        return pages;
+    }
+
     const auto additionalWidth = config.spacing.hor + config.padding.left + config.padding.right;
     const auto additionalHeight = config.spacing.ver + config.padding.up + config.padding.down;
     std::vector<Config::Size> result;
 
     auto glyphRectangles = getGlyphRectangles(glyphs, additionalWidth, additionalHeight, config);
 
+    // With char frequencies, pages are filled in descending frequency order and a page ends at the first
+    // glyph that does not fit: page 0 holds the most frequent glyphs, following pages rarer ones.
+    const auto frequencyOrder = !config.charFrequencies.empty();
+    if (frequencyOrder)
+    {
+        const auto frequency = [&](const rbp::RectSize &r) -> std::uint64_t
+        {
+            const auto &glyph = glyphs[r.tag];
+            const auto it = config.charFrequencies.find(glyph.utf32);
+            return glyph.stringOnly || it == config.charFrequencies.end() ? 0 : it->second;
+        };
+        std::stable_sort(glyphRectangles.begin(), glyphRectangles.end(), [&](const rbp::RectSize &a, const rbp::RectSize &b)
+                         { return frequency(a) > frequency(b); });
+    }
+
+    const auto offset = config.getPackingOffset();
+    const auto margin = config.getMipmapMargin();
     rbp::MaxRectsBinPack mrbp;
 
     for (;;)
@@ -187,8 +451,8 @@ std::vector<Config::Size> App::arrangeGlyphs(Glyphs &glyphs, const Config &confi
             const auto &ss = config.textureSizeList[i];
 
             // TODO: check workAreaW,H
-            const auto workAreaW = ss.w - config.spacing.hor;
-            const auto workAreaH = ss.h - config.spacing.ver;
+            const auto workAreaW = ss.w - offset.hor;
+            const auto workAreaH = ss.h - offset.ver;
 
             uint64_t textureSquare = static_cast<uint64_t>(workAreaW) * workAreaH;
             if (textureSquare < allGlyphSquare && i + 1 < config.textureSizeList.size())
@@ -198,7 +462,10 @@ std::vector<Config::Size> App::arrangeGlyphs(Glyphs &glyphs, const Config &confi
             glyphRectangles = glyphRectanglesCopy;
 
             mrbp.Init(workAreaW, workAreaH);
-            mrbp.Insert(glyphRectangles, arrangedRectangles, rbp::MaxRectsBinPack::RectBestAreaFit);
+            if (frequencyOrder)
+                mrbp.InsertInOrder(glyphRectangles, arrangedRectangles, rbp::MaxRectsBinPack::RectBestAreaFit);
+            else
+                mrbp.Insert(glyphRectangles, arrangedRectangles, rbp::MaxRectsBinPack::RectBestAreaFit);
 
             if (glyphRectangles.empty())
                 break;
@@ -213,13 +480,17 @@ std::vector<Config::Size> App::arrangeGlyphs(Glyphs &glyphs, const Config &confi
 
         std::uint32_t maxX = 0;
         std::uint32_t maxY = 0;
+        Stats::PageUsage usage;
         for (const auto &r : arrangedRectangles)
         {
-            std::uint32_t x = r.x + config.spacing.hor;
-            std::uint32_t y = r.y + config.spacing.ver;
+            ++usage.glyphs;
+            usage.usedArea += static_cast<std::uint64_t>(r.width) * r.height;
 
-            glyphs[r.tag].x = x;
-            glyphs[r.tag].y = y;
+            std::uint32_t x = r.x + offset.hor;
+            std::uint32_t y = r.y + offset.ver;
+
+            glyphs[r.tag].x = x + margin;
+            glyphs[r.tag].y = y + margin;
             glyphs[r.tag].page = static_cast<std::uint32_t>(result.size());
 
             if (maxX < x + r.width)
@@ -227,114 +498,429 @@ std::vector<Config::Size> App::arrangeGlyphs(Glyphs &glyphs, const Config &confi
             if (maxY < y + r.height)
                 maxY = y + r.height;
         }
+        // Cropped sizes stay multiples of the compression block size
+        const auto multiple = config.getTextureSizeMultiple();
         if (config.cropTexturesWidth)
-            lastSize.w = maxX;
+            lastSize.w = (maxX + multiple - 1) / multiple * multiple;
         if (config.cropTexturesHeight)
-            lastSize.h = maxY;
+            lastSize.h = (maxY + multiple - 1) / multiple * multiple;
 
+        usage.w = lastSize.w;
+        usage.h = lastSize.h;
+        stats.addPage(usage);
         result.push_back(lastSize);
     }
 
     return result;
 }
 
-void App::savePng(const std::string &fileName, const std::uint32_t *buffer, const std::uint32_t w, const std::uint32_t h, const bool withAlpha)
+// Texture array mode: all layers get one size. The size of the list needing the fewest layers wins (the
+// smaller one on a tie), then the glyph area is spread evenly over the layers, largest glyphs first.
+std::vector<Config::Size> App::arrangeGlyphsInLayers(Glyphs &glyphs, const Config &config, Stats &stats)
 {
-    std::vector<std::uint8_t> png;
-    lodepng::State state;
+    const auto additionalWidth = config.spacing.hor + config.padding.left + config.padding.right;
+    const auto additionalHeight = config.spacing.ver + config.padding.up + config.padding.down;
+    const auto glyphRectangles = getGlyphRectangles(glyphs, additionalWidth, additionalHeight, config);
+    if (glyphRectangles.empty())
+        return {};
 
-    state.encoder.add_id = 0; // Don't add LodePNG version chunk to save more bytes
-    state.encoder.auto_convert = 0;
-    state.info_png.color.colortype = withAlpha ? LCT_RGBA : LCT_RGB;
-    state.encoder.zlibsettings.windowsize = 32768; // Use maximum possible window size for best compression
+    std::uint64_t allGlyphSquare = 0;
+    for (const auto &r : glyphRectangles)
+        allGlyphSquare += static_cast<std::uint64_t>(r.width) * r.height;
 
-    auto error = lodepng::encode(png, reinterpret_cast<const unsigned char *>(buffer), w, h, state);
-    if (error)
-        throw std::runtime_error("png encoder error " + std::to_string(error) + ": " + lodepng_error_text(error));
+    typedef std::vector<std::vector<rbp::Rect>> Layers;
+    const auto offset = config.getPackingOffset();
+    const auto margin = config.getMipmapMargin();
+    rbp::MaxRectsBinPack mrbp;
+
+    // Fills layers one after the other; empty if a glyph does not fit or more than maxLayers are needed
+    const auto packGreedy = [&](const Config::Size &size, const std::size_t maxLayers)
+    {
+        Layers layers;
+        auto rest = glyphRectangles;
+        while (!rest.empty())
+        {
+            if (layers.size() == maxLayers)
+                return Layers();
+            std::vector<rbp::Rect> arranged;
+            mrbp.Init(size.w - offset.hor, size.h - offset.ver);
+            mrbp.Insert(rest, arranged, rbp::MaxRectsBinPack::RectBestAreaFit);
+            if (arranged.empty())
+                return Layers();
+            layers.push_back(std::move(arranged));
+        }
+        return layers;
+    };
+
+    Layers best;
+    Config::Size bestSize;
+    for (const auto &size : config.textureSizeList)
+    {
+        const auto workArea = static_cast<std::uint64_t>(size.w - offset.hor) * (size.h - offset.ver);
+        if (workArea == 0)
+            continue;
+        const auto minLayers = (allGlyphSquare + workArea - 1) / workArea;
+        const auto maxLayers = best.empty() ? std::numeric_limits<std::size_t>::max() : best.size();
+        if (minLayers > maxLayers)
+            continue;
+        auto layers = packGreedy(size, maxLayers);
+        if (layers.empty())
+            continue;
+        if (best.empty() || layers.size() < best.size()
+            || (layers.size() == best.size() && static_cast<std::uint64_t>(size.w) * size.h < static_cast<std::uint64_t>(bestSize.w) * bestSize.h))
+        {
+            best = std::move(layers);
+            bestSize = size;
+        }
+    }
+    if (best.empty())
+        throw std::runtime_error("can not fit glyphs into texture");
+
+    // Balance: the greedy fill leaves the last layer nearly empty, so distribute the glyphs by area and
+    // pack every layer again. The greedy layers are kept if any of the balanced ones overflows.
+    if (best.size() > 1)
+    {
+        auto sorted = glyphRectangles;
+        std::stable_sort(sorted.begin(), sorted.end(), [](const rbp::RectSize &a, const rbp::RectSize &b)
+                         { return static_cast<std::uint64_t>(a.width) * a.height > static_cast<std::uint64_t>(b.width) * b.height; });
+        std::vector<std::vector<rbp::RectSize>> assigned(best.size());
+        std::vector<std::uint64_t> assignedArea(best.size(), 0);
+        for (const auto &r : sorted)
+        {
+            const auto layer = std::min_element(assignedArea.begin(), assignedArea.end()) - assignedArea.begin();
+            assigned[layer].push_back(r);
+            assignedArea[layer] += static_cast<std::uint64_t>(r.width) * r.height;
+        }
+
+        Layers balanced;
+        for (auto &rects : assigned)
+        {
+            std::vector<rbp::Rect> arranged;
+            mrbp.Init(bestSize.w - offset.hor, bestSize.h - offset.ver);
+            mrbp.Insert(rects, arranged, rbp::MaxRectsBinPack::RectBestAreaFit);
+            if (!rects.empty())
+                break;
+            balanced.push_back(std::move(arranged));
+        }
+        if (balanced.size() == best.size())
+            best = std::move(balanced);
+        else
+            stats.addCounter("unbalanced layers", 1);
+    }
+
+    std::uint32_t maxX = 0;
+    std::uint32_t maxY = 0;
+    std::vector<Stats::PageUsage> usages(best.size());
+    for (std::uint32_t layer = 0; layer < best.size(); ++layer)
+    {
+        for (const auto &r : best[layer])
+        {
+            ++usages[layer].glyphs;
+            usages[layer].usedArea += static_cast<std::uint64_t>(r.width) * r.height;
+
+            const std::uint32_t x = r.x + offset.hor;
+            const std::uint32_t y = r.y + offset.ver;
+            glyphs[r.tag].x = x + margin;
+            glyphs[r.tag].y = y + margin;
+            glyphs[r.tag].page = layer;
+            maxX = std::max(maxX, x + r.width);
+            maxY = std::max(maxY, y + r.height);
+        }
+    }
+    // Layers are cropped together, so they keep one size
+    const auto multiple = config.getTextureSizeMultiple();
+    if (config.cropTexturesWidth)
+        bestSize.w = (maxX + multiple - 1) / multiple * multiple;
+    if (config.cropTexturesHeight)
+        bestSize.h = (maxY + multiple - 1) / multiple * multiple;
+
+    for (auto &usage : usages)
+    {
+        usage.w = bestSize.w;
+        usage.h = bestSize.h;
+        stats.addPage(usage);
+    }
+    return std::vector<Config::Size>(best.size(), bestSize);
+}
 
-    error = lodepng::save_file(png, fileName);
+void App::savePng(const std::string &fileName, const std::uint32_t *buffer, const std::uint32_t w, const std::uint32_t h, const bool withAlpha)
+{
+    const auto png = TextureFile::encodePng(buffer, w, h, withAlpha);
+    const auto error = lodepng::save_file(png, fileName);
     if (error)
         throw std::runtime_error("png save to file error " + std::to_string(error) + ": " + lodepng_error_text(error));
 }
 
-std::vector<std::string> App::renderTextures(const Glyphs &glyphs, const Config &config, const ft::Font &font, const ft::Font &secondaryFont, const std::vector<Config::Size> &pages)
+std::vector<std::string> App::renderTextures(const Glyphs &glyphs, const Config &config, const FontChain &fonts, const std::vector<Config::Size> &pages,
+                                             Stats &stats)
 {
     std::vector<std::string> fileNames;
-    if (pages.empty())
-        return {};
 
-    const auto pageNameDigits = getNumberLen(pages.size() - 1);
+    if (config.textureArray)
+    {
+        std::vector<std::vector<std::uint32_t>> surfaces;
+        auto renderPhase = stats.phase("render textures");
+        for (std::uint32_t page = 0; page < pages.size(); ++page)
+            surfaces.push_back(renderPage(glyphs, config, fonts, pages[page], page, stats));
+        renderPhase.stop();
+        if (surfaces.empty())
+            return fileNames;
+
+        // One file, every page of the descriptor refers to it (page is the layer index)
+        const auto fileName = getPageFileName(config, 0, pages.size());
+        fileNames.assign(pages.size(), extractFileName(fileName));
+        {
+            const auto phase = stats.phase("encode texture");
+            std::vector<const std::uint32_t *> layers;
+            for (const auto &surface : surfaces)
+                layers.push_back(surface.data());
+            TextureFile::saveArray(fileName, layers, pages.front().w, pages.front().h, config.backgroundTransparent, config);
+        }
+        stats.addFile(fileName);
+        return fileNames;
+    }
 
+    const auto colorPages = getColorPages(glyphs);
+    const auto colorPageConfig = getColorPageConfig(config);
     for (std::uint32_t page = 0; page < pages.size(); ++page)
     {
         const Config::Size &s = pages[page];
-        std::vector<std::uint32_t> surface(s.w * s.h, config.color.getBGR());
-
-        // Render every glyph
-        // TODO: do not repeat same glyphs (with same index)
-        for (const auto &kv : glyphs)
+        const auto isColorPage = std::binary_search(colorPages.begin(), colorPages.end(), page);
+        const auto &pageConfig = isColorPage ? colorPageConfig : config;
+        if (config.renderStripHeight)
         {
-            const auto &glyph = kv.second;
-            if (glyph.page != page)
-                continue;
+            // Rendering and encoding are interleaved, both are counted as rendering
+            const auto phase = stats.phase("render textures");
+            const auto fileName = getPageFileName(config, page, pages.size());
+            TextureFile::StripWriter writer(fileName, s.w, s.h, config.backgroundTransparent, pageConfig);
+            renderPageStrips(glyphs, config, fonts, s, page, config.renderStripHeight,
+                             [&](const std::uint32_t *pixels, const std::uint32_t rows) { writer.write(pixels, rows); }, stats);
+            writer.finish();
+            fileNames.push_back(extractFileName(fileName));
+            stats.addFile(fileName);
+            continue;
+        }
 
-            if (!glyph.isEmpty())
-            {
-                const auto x = glyph.x + config.padding.left;
-                const auto y = glyph.y + config.padding.up;
+        auto renderPhase = stats.phase("render textures");
+        const auto surface = renderPage(glyphs, config, fonts, s, page, stats);
 
-                if (glyph.secondaryFont && secondaryFont.valid) {
-                    secondaryFont.renderGlyph(&surface[0], s.w, s.h, x, y, kv.first, config.color.getBGR());
-                } else {
-                    font.renderGlyph(&surface[0], s.w, s.h, x, y, kv.first, config.color.getBGR());
-                }
-            }
-        }
+        const auto fileName = getPageFileName(config, page, pages.size());
+        fileNames.push_back(extractFileName(fileName));
+        renderPhase.stop();
 
-        if (!config.backgroundTransparent)
         {
-            auto cur = surface.data();
-            const auto end = &surface.back();
+            const auto phase = stats.phase(config.textureFormat == Config::TextureFormat::Png ? "encode png" : "encode texture");
+            TextureFile::save(fileName, &surface[0], s.w, s.h, config.backgroundTransparent, pageConfig);
+        }
+        stats.addFile(fileName);
+    }
 
-            const auto fgColor = config.color.getBGR();
-            const auto bgColor = config.backgroundColor.getBGR();
+    return fileNames;
+}
 
-            while (cur <= end)
-            {
-                const std::uint32_t a0 = (*cur) >> 24u;
-                const std::uint32_t a1 = 256 - a0;
-                const std::uint32_t rb1 = (a1 * (bgColor & 0xFF00FFu)) >> 8u;
-                const std::uint32_t rb2 = (a0 * (fgColor & 0xFF00FFu)) >> 8u;
-                const std::uint32_t g1 = (a1 * (bgColor & 0x00FF00u)) >> 8u;
-                const std::uint32_t g2 = (a0 * (fgColor & 0x00FF00u)) >> 8u;
-                *cur = ((rb1 | rb2) & 0xFF00FFu) + ((g1 | g2) & 0x00FF00u);
-                ++cur;
-            }
+std::vector<std::uint32_t> App::getColorPages(const Glyphs &glyphs)
+{
+    std::set<std::uint32_t> pages;
+    for (const auto &kv : glyphs)
+        if (kv.second.color)
+            pages.insert(kv.second.page);
+    return std::vector<std::uint32_t>(pages.begin(), pages.end());
+}
+
+// Glyphs outside of any Unicode block or chars file are in the "Other" group, glyphs only used by shaped
+// strings in the "Strings" group.
+std::string App::getPageGroup(const GlyphInfo &glyph, const Config &config)
+{
+    if (glyph.stringOnly)
+        return "Strings";
+    if (config.pageGroups == Config::PageGroups::CharsFile)
+    {
+        for (const auto &group : config.charGroups)
+            if (group.second.contains(glyph.utf32))
+                return group.first;
+        return "Other";
+    }
+    const auto block = UnicodeBlocks::find(glyph.utf32);
+    if (!block)
+        return "Other";
+    return std::string(config.pageGroups == Config::PageGroups::Script ? block->script : block->name);
+}
+
+// Pages of each group holding visible glyphs, groups are arranged on consecutive pages (see arrangeGlyphs).
+std::vector<FontInfo::PageGroup> App::getPageGroups(const Glyphs &glyphs, const Config &config)
+{
+    std::map<std::string, std::pair<std::uint32_t, std::uint32_t>> pages; // first and last page
+    for (const auto &kv : glyphs)
+    {
+        if (kv.second.isEmpty())
+            continue;
+        const auto page = kv.second.page;
+        const auto it = pages.try_emplace(getPageGroup(kv.second, config), page, page).first;
+        it->second.first = std::min(it->second.first, page);
+        it->second.second = std::max(it->second.second, page);
+    }
+
+    std::vector<FontInfo::PageGroup> result;
+    for (const auto &kv : pages)
+        result.push_back({kv.first, kv.second.first, kv.second.second - kv.second.first + 1});
+    std::sort(result.begin(), result.end(), [](const FontInfo::PageGroup &a, const FontInfo::PageGroup &b)
+              { return a.firstPage < b.firstPage; });
+    return result;
+}
+
+// Color pages keep RGBA texels: coverage only formats are replaced by their RGBA counterparts.
+Config App::getColorPageConfig(const Config &config)
+{
+    auto result = config;
+    result.textureChannels = Config::TextureChannels::Rgba;
+    if (result.textureCompression == Config::TextureCompression::Bc4)
+        result.textureCompression = Config::TextureCompression::Bc7;
+    if (result.textureCompression == Config::TextureCompression::Eac)
+        result.textureCompression = Config::TextureCompression::Etc2;
+    return result;
+}
+
+std::string App::getPageFileName(const Config &config, const std::uint32_t page, const std::size_t pageCount)
+{
+    std::stringstream ss;
+    ss << config.output;
+    if (config.textureNameSuffix != Config::TextureNameSuffix::None && !config.textureArray)
+    {
+        ss << "_";
+        if (config.textureNameSuffix == Config::TextureNameSuffix::IndexAligned)
+            ss << std::setfill('0') << std::setw(getNumberLen(pageCount - 1));
+        ss << page;
+    }
+    ss << "." << TextureFile::getExtension(config.textureFormat);
+    return ss.str();
+}
+
+std::vector<std::uint32_t> App::renderPage(const Glyphs &glyphs, const Config &config, const FontChain &fonts, const Config::Size &s,
+                                           const std::uint32_t page, Stats &stats)
+{
+    // With effects RGB hold the effect channels instead of the color
+    const auto color = config.effects.enabled() ? 0u : config.color.getBGR();
+    std::vector<std::uint32_t> surface(s.w * s.h, color);
+
+    // Render every glyph
+    // TODO: do not repeat same glyphs (with same index)
+    for (const auto &kv : glyphs)
+        if (kv.second.page == page && !kv.second.isEmpty())
+            renderGlyphCell(surface.data(), s.w, s.h, 0, kv.first, kv.second, color, config, fonts, stats);
+
+    if (!config.backgroundTransparent)
+        blendBackground(surface.data(), surface.data() + surface.size(), config);
+
+    return surface;
+}
+
+// Glyphs are rendered in the order of their cell tops into a window of stripHeight rows plus the tallest cell:
+// a glyph starting in the strip is rendered whole, the rows below the strip are carried over to the next one.
+void App::renderPageStrips(const Glyphs &glyphs, const Config &config, const FontChain &fonts, const Config::Size &s, const std::uint32_t page,
+                           std::uint32_t stripHeight, const std::function<void(const std::uint32_t *, std::uint32_t)> &writeStrip, Stats &stats)
+{
+    const auto color = config.effects.enabled() ? 0u : config.color.getBGR();
+
+    std::vector<Glyphs::const_pointer> pageGlyphs;
+    std::uint32_t maxCellHeight = 0;
+    for (const auto &kv : glyphs)
+        if (kv.second.page == page && !kv.second.isEmpty())
+        {
+            pageGlyphs.push_back(&kv);
+            maxCellHeight = std::max(maxCellHeight, kv.second.height + config.padding.up + config.padding.down);
         }
+    std::stable_sort(pageGlyphs.begin(), pageGlyphs.end(), [](const Glyphs::const_pointer a, const Glyphs::const_pointer b)
+                     { return a->second.y < b->second.y; });
+
+    stripHeight = std::min(stripHeight, s.h);
+    const auto windowHeight = stripHeight + maxCellHeight;
+    std::vector<std::uint32_t> window(static_cast<std::size_t>(s.w) * windowHeight, color);
+    std::vector<std::uint32_t> strip;
+    auto next = pageGlyphs.begin();
+    for (std::uint32_t top = 0; top < s.h; top += stripHeight)
+    {
+        for (; next != pageGlyphs.end() && (*next)->second.y < top + stripHeight; ++next)
+            renderGlyphCell(window.data(), s.w, windowHeight, top, (*next)->first, (*next)->second, color, config, fonts, stats);
 
-        std::stringstream ss;
-        ss << config.output;
-        if (config.textureNameSuffix != Config::TextureNameSuffix::None)
+        const auto rows = std::min(stripHeight, s.h - top);
+        const auto stripEnd = window.begin() + static_cast<std::ptrdiff_t>(static_cast<std::size_t>(s.w) * rows);
+        if (config.backgroundTransparent)
+            writeStrip(window.data(), rows);
+        else
         {
-            ss << "_";
-            if (config.textureNameSuffix == Config::TextureNameSuffix::IndexAligned)
-                ss << std::setfill('0') << std::setw(pageNameDigits);
-            ss << page;
+            strip.assign(window.begin(), stripEnd);
+            blendBackground(strip.data(), strip.data() + strip.size(), config);
+            writeStrip(strip.data(), rows);
         }
-        ss << ".png";
-        const auto fileName = ss.str();
-        fileNames.push_back(extractFileName(fileName));
 
-        savePng(fileName, &surface[0], s.w, s.h, config.backgroundTransparent);
+        // Rows below the strip move up, the rest of the window is cleared
+        const auto carried = std::copy(window.begin() + static_cast<std::ptrdiff_t>(static_cast<std::size_t>(s.w) * stripHeight), window.end(), window.begin());
+        std::fill(carried, window.end(), color);
     }
+}
 
-    return fileNames;
+// Renders a glyph cell (and its subpixel phases and effects) into a surface holding the page rows from top.
+void App::renderGlyphCell(std::uint32_t *surface, const std::uint32_t surfaceW, const std::uint32_t surfaceH, const std::uint32_t top,
+                          const std::uint32_t glyphKey, const GlyphInfo &glyph, const std::uint32_t color, const Config &config,
+                          const FontChain &fonts, Stats &stats)
+{
+    const auto x = glyph.x + config.padding.left;
+    const auto y = glyph.y + config.padding.up - top;
+    const auto cellY = glyph.y - top;
+
+    const auto &glyphFont = fonts[glyph.font];
+    const auto glyphIndex = getGlyphIndex(glyphKey);
+    const auto cellHeight = glyph.height + config.padding.up + config.padding.down;
+    if (glyph.phases.empty())
+    {
+        glyphFont.renderGlyph(surface, surfaceW, surfaceH, x, y, glyphIndex, color);
+        stats.addCounter("rasterized glyphs", 1);
+        if (config.effects.enabled() && !glyph.color)
+        {
+            Effects::render(surface, surfaceW, glyph.x, cellY, glyph.width + config.padding.left + config.padding.right, cellHeight,
+                            glyphFont, glyphIndex, 0, config);
+            stats.addCounter("effect glyphs", 1);
+        }
+        return;
+    }
+
+    const auto cellWidth = getPhaseCellWidth(glyph, config.spacing.hor + config.padding.left + config.padding.right, config);
+    const auto phases = static_cast<std::uint32_t>(glyph.phases.size());
+    for (std::uint32_t p = 0; p < phases; ++p)
+    {
+        const auto shift = static_cast<int>(p * 64 / phases);
+        glyphFont.renderGlyph(surface, surfaceW, surfaceH, x + p * cellWidth, y, glyphIndex, color, shift);
+        if (config.effects.enabled() && !glyph.color)
+            Effects::render(surface, surfaceW, glyph.x + p * cellWidth, cellY, glyph.phases[p].width + config.padding.left + config.padding.right,
+                            cellHeight, glyphFont, glyphIndex, shift, config);
+    }
+    stats.addCounter("rasterized glyphs", phases);
+    if (config.effects.enabled() && !glyph.color)
+        stats.addCounter("effect glyphs", phases);
+}
+
+// Replaces rendered coverage (alpha) by the foreground color blended over the opaque background color.
+void App::blendBackground(std::uint32_t *begin, std::uint32_t *end, const Config &config)
+{
+    const auto fgColor = config.color.getBGR();
+    const auto bgColor = config.backgroundColor.getBGR();
+
+    for (auto cur = begin; cur < end; ++cur)
+    {
+        const std::uint32_t a0 = (*cur) >> 24u;
+        const std::uint32_t a1 = 256 - a0;
+        const std::uint32_t rb1 = (a1 * (bgColor & 0xFF00FFu)) >> 8u;
+        const std::uint32_t rb2 = (a0 * (fgColor & 0xFF00FFu)) >> 8u;
+        const std::uint32_t g1 = (a1 * (bgColor & 0x00FF00u)) >> 8u;
+        const std::uint32_t g2 = (a0 * (fgColor & 0x00FF00u)) >> 8u;
+        *cur = ((rb1 | rb2) & 0xFF00FFu) + ((g1 | g2) & 0x00FF00u);
+    }
 }
 
-void App::writeFontInfoFile(const Glyphs &glyphs, const Config &config, const ft::Font &font, const ft::Font &secondaryFont, const std::vector<std::string> &fileNames,
-                            const std::vector<Config::Size> &pages)
+FontInfo App::buildFontInfo(const Glyphs &glyphs, const Config &config, const ft::Font &font, const std::vector<std::string> &fileNames,
+                            const std::vector<Config::Size> &pages, Stats &stats)
 {
-    if (!fileNames.empty())
+    if (!fileNames.empty() && !config.textureArray)
         for (size_t i = 0; i < fileNames.size() - 1; ++i)
             for (size_t k = i + 1; k < fileNames.size(); ++k)
                 if (fileNames[i] == fileNames[k])
@@ -383,9 +969,20 @@ void App::writeFontInfoFile(const Glyphs &glyphs, const Config &config, const ft
     f.common.redChnl = 4;
     f.common.greenChnl = 4;
     f.common.blueChnl = 4;
+    if (config.effects.enabled())
+    {
+        // 1 is the BMFont outline channel, 3 holds zero; shadow (5) and glow (6) are fontbm extensions
+        f.info.outline = static_cast<std::uint8_t>(config.effects.outline);
+        f.common.redChnl = config.effects.outline ? 1 : 3;
+        f.common.greenChnl = config.effects.shadow ? 5 : 3;
+        f.common.blueChnl = config.effects.glow ? 6 : 3;
+    }
     f.common.totalHeight = static_cast<std::uint16_t>(font.totalHeight);
 
     f.pages = fileNames;
+    f.colorPages = getColorPages(glyphs);
+    if (config.pageGroups != Config::PageGroups::None)
+        f.groups = getPageGroups(glyphs, config);
 
     std::vector<GlyphInfo> sortedGlyphs;
     sortedGlyphs.reserve(glyphs.size());
@@ -394,6 +991,41 @@ void App::writeFontInfoFile(const Glyphs &glyphs, const Config &config, const ft
     std::sort(sortedGlyphs.begin(), sortedGlyphs.end(), [](const GlyphInfo &a, const GlyphInfo &b)
               { return a.utf32 < b.utf32; });
 
+    f.common.subpixelPhases = static_cast<std::uint8_t>(config.subpixelPhases);
+    const auto additionalWidth = config.spacing.hor + config.padding.left + config.padding.right;
+    for (const auto &glyph : sortedGlyphs)
+    {
+        if (glyph.stringOnly)
+            continue;
+        const auto c = getCharInfo(glyph, config);
+        if (glyph.phases.empty())
+        {
+            f.chars.push_back(c);
+            continue;
+        }
+        // One entry per phase, runtimes pick the one of the fractional pen position
+        const auto cellWidth = getPhaseCellWidth(glyph, additionalWidth, config);
+        for (std::uint32_t p = 0; p < glyph.phases.size(); ++p)
+        {
+            auto phaseChar = c;
+            phaseChar.phase = static_cast<std::uint8_t>(p);
+            phaseChar.x = static_cast<std::uint16_t>(c.x + p * cellWidth);
+            phaseChar.width = static_cast<std::uint16_t>(glyph.phases[p].width + config.padding.left + config.padding.right);
+            phaseChar.xoffset = static_cast<std::int16_t>(glyph.phases[p].xOffset - config.padding.left);
+            f.chars.push_back(phaseChar);
+        }
+    }
+
+    f.kernings = getKerningPairs(glyphs, config, font, stats);
+    stats.addCounter("kerning pairs", f.kernings.size());
+
+    f.extraInfo = config.extraInfo;
+
+    return f;
+}
+
+FontInfo::Char App::getCharInfo(const GlyphInfo &glyph, const Config &config)
+{
     // Official unicode characters with property White_Space = yes
     static const std::set<char32_t> white_space = {
         U'\u0009', // CHARACTER TABULATION (HT)
@@ -423,30 +1055,92 @@ void App::writeFontInfoFile(const Glyphs &glyphs, const Config &config, const ft
         U'\u3000'  // IDEOGRAPHIC SPACE
     };
 
-    for (const auto &glyph : sortedGlyphs)
+    // TODO: page = 0 for empty glyphs.
+    FontInfo::Char c;
+    if (!glyph.isEmpty() || white_space.count(glyph.utf32) > 0)
     {
-        // TODO: page = 0 for empty glyphs.
-        FontInfo::Char c;
-        if (!glyph.isEmpty() || white_space.count(glyph.utf32) > 0)
+        c.id = static_cast<std::uint32_t>(glyph.utf32);
+        c.x = static_cast<std::uint16_t>(glyph.x);
+        c.y = static_cast<std::uint16_t>(glyph.y);
+        c.width = static_cast<std::uint16_t>(glyph.width + config.padding.left + config.padding.right);
+        c.height = static_cast<std::uint16_t>(glyph.height + config.padding.up + config.padding.down);
+        c.page = static_cast<std::uint8_t>(glyph.page);
+        c.xoffset = static_cast<std::int16_t>(glyph.xOffset - config.padding.left);
+        c.yoffset = static_cast<std::int16_t>(glyph.yOffset - config.padding.up);
+    }
+    c.xadvance = static_cast<std::int16_t>(glyph.xAdvance);
+    c.chnl = 15;
+    return c;
+}
+
+// Run glyphs are placed at whole pixels: the pen position is rounded, or its fraction picks the nearest
+// subpixel phase. Empty lines get no run.
+std::vector<FontInfo::Run> App::getRuns(const std::vector<ShapedString> &strings, const Glyphs &glyphs, const Config &config)
+{
+    std::vector<FontInfo::Run> result;
+    const auto additionalWidth = config.spacing.hor + config.padding.left + config.padding.right;
+    for (std::size_t i = 0; i < strings.size(); ++i)
+    {
+        const auto &s = strings[i];
+        if (s.glyphs.empty() && !s.advance)
+            continue;
+
+        FontInfo::Run run;
+        run.id = static_cast<std::uint32_t>(i);
+        run.xadvance = static_cast<std::int16_t>(std::lround(s.advance / 64.0));
+        for (const auto &g : s.glyphs)
         {
-            c.id = static_cast<std::uint32_t>(glyph.utf32);
-            c.x = static_cast<std::uint16_t>(glyph.x);
-            c.y = static_cast<std::uint16_t>(glyph.y);
-            c.width = static_cast<std::uint16_t>(glyph.width + config.padding.left + config.padding.right);
-            c.height = static_cast<std::uint16_t>(glyph.height + config.padding.up + config.padding.down);
-            c.page = static_cast<std::uint8_t>(glyph.page);
-            c.xoffset = static_cast<std::int16_t>(glyph.xOffset - config.padding.left);
-            c.yoffset = static_cast<std::int16_t>(glyph.yOffset - config.padding.up);
-        }
-        c.xadvance = static_cast<std::int16_t>(glyph.xAdvance);
-        c.chnl = 15;
+            const auto it = glyphs.find(g.key);
+            if (it == glyphs.end() || it->second.isEmpty())
+                continue;
+            const auto &glyph = it->second;
+
+            auto x = static_cast<std::int32_t>(std::floor(g.x / 64.0));
+            const auto fraction = static_cast<std::uint32_t>(g.x - x * 64);
+            auto atlasX = glyph.x;
+            auto width = glyph.width;
+            auto xOffset = glyph.xOffset;
+            if (glyph.phases.empty())
+            {
+                if (fraction >= 32)
+                    ++x;
+            }
+            else
+            {
+                const auto phases = static_cast<std::uint32_t>(glyph.phases.size());
+                auto p = (fraction * phases + 32) / 64;
+                if (p == phases)
+                {
+                    p = 0;
+                    ++x;
+                }
+                atlasX += p * getPhaseCellWidth(glyph, additionalWidth, config);
+                width = glyph.phases[p].width;
+                xOffset = glyph.phases[p].xOffset;
+            }
 
-        f.chars.push_back(c);
+            FontInfo::Run::Glyph runGlyph;
+            runGlyph.x = static_cast<std::uint16_t>(atlasX);
+            runGlyph.y = static_cast<std::uint16_t>(glyph.y);
+            runGlyph.width = static_cast<std::uint16_t>(width + config.padding.left + config.padding.right);
+            runGlyph.height = static_cast<std::uint16_t>(glyph.height + config.padding.up + config.padding.down);
+            runGlyph.xoffset = static_cast<std::int16_t>(x + xOffset - static_cast<int>(config.padding.left));
+            runGlyph.yoffset = static_cast<std::int16_t>(std::lround(g.y / 64.0) + glyph.yOffset - static_cast<int>(config.padding.up));
+            runGlyph.page = static_cast<std::int8_t>(glyph.page);
+            run.glyphs.push_back(runGlyph);
+        }
+        result.push_back(std::move(run));
     }
+    return result;
+}
+
+std::vector<FontInfo::Kerning> App::getKerningPairs(const Glyphs &glyphs, const Config &config, const ft::Font &font, Stats &stats)
+{
+    std::vector<FontInfo::Kerning> result;
 
     if (config.kerningPairs != Config::KerningPairs::Disabled)
     {
-        auto chars = shapeGlyphs(font, secondaryFont, config.chars, config.tabularNumbers, config.slashedZero);
+        const auto phase = stats.phase("kerning pairs");
 
         ft::Font::KerningMode kerningMode = ft::Font::KerningMode::Basic;
         if (config.kerningPairs == Config::KerningPairs::Regular)
@@ -454,6 +1148,29 @@ void App::writeFontInfoFile(const Glyphs &glyphs, const Config &config, const ft
         if (config.kerningPairs == Config::KerningPairs::Extended)
             kerningMode = ft::Font::KerningMode::Extended;
 
+        // All glyph pairs, or only the char pairs found in the corpus (--kerning-corpus-file)
+        const auto forEachPair = [&](const auto &kern)
+        {
+            if (!config.useKerningCorpus)
+            {
+                for (const auto &ch0 : glyphs)
+                    for (const auto &ch1 : glyphs)
+                        kern(ch0, ch1);
+                return;
+            }
+            std::map<std::uint32_t, const Glyphs::value_type *> glyphOfChar;
+            for (const auto &kv : glyphs)
+                if (!kv.second.stringOnly)
+                    glyphOfChar[kv.second.utf32] = &kv;
+            for (const auto &[first, second] : config.kerningCorpusPairs)
+            {
+                const auto ch0 = glyphOfChar.find(first);
+                const auto ch1 = glyphOfChar.find(second);
+                if (ch0 != glyphOfChar.end() && ch1 != glyphOfChar.end())
+                    kern(*ch0->second, *ch1->second);
+            }
+        };
+
         // Extended means we capture calculated kerning values if we can
         if (kerningMode == ft::Font::KerningMode::Extended)
         {
@@ -462,145 +1179,142 @@ void App::writeFontInfoFile(const Glyphs &glyphs, const Config &config, const ft
             size_t specialCount = 0;
             size_t reshapeCount = 0;
 
-            hb_font_t *hb_font = hb_ft_font_create(font.face, nullptr);
+            hb_font_t *hb_font = font.createHbFont();
             int x_scale = 0;
             int y_scale = 0;
             hb_font_get_scale(hb_font, &x_scale, &y_scale);
-            for (const auto &ch0 : glyphs)
+            forEachPair([&](const Glyphs::value_type &ch0, const Glyphs::value_type &ch1)
             {
-                for (const auto &ch1 : glyphs)
+                // Sorry harfbuzz devs; I know this is the worst thing
+                // to do and will break in many ways. But it works for
+                // our use case.
+
+                // No kerning pairs if a fallback font or a glyph without char is involved
+                if ( std::get<1>(ch0).font || std::get<1>(ch0).stringOnly ||
+                     std::get<1>(ch1).font || std::get<1>(ch1).stringOnly ) {
+                    return;
+                }
+
+                hb_codepoint_t codepoint_l = std::get<0>(ch0);
+                hb_codepoint_t codepoint_r = std::get<0>(ch1);
+                hb_codepoint_t utf32_l = std::get<1>(ch0).utf32;
+                hb_codepoint_t utf32_r = std::get<1>(ch1).utf32;
+
+                hb_buffer_t *hb_buffer = hb_buffer_create();
+                hb_buffer_set_direction(hb_buffer, HB_DIRECTION_LTR);
+                hb_buffer_set_script(hb_buffer, HB_SCRIPT_COMMON);
+                hb_buffer_set_language(hb_buffer, hb_language_from_string("en", -1));
+                hb_buffer_add_utf32(hb_buffer, &utf32_l, 1, 0, -1);
+                hb_buffer_add_utf32(hb_buffer, &utf32_r, 1, 0, -1);
+
+                hb_feature_t feature[3] = {};
+                feature[0].tag = HB_TAG('t', 'n', 'u', 'm');      // Tag for Tabular Figures
+                feature[0].value = config.tabularNumbers ? 1 : 0; // 1 to enable, 0 to disable
+                feature[0].start = 0;                             // Apply from the start of the buffer
+                feature[0].end = (unsigned int)-1;                // Apply to the end of the buffer
+
+                feature[1].tag = HB_TAG('z', 'e', 'r', 'o');   // Tag for slashed zeros
+                feature[1].value = config.slashedZero ? 1 : 0; // 1 to enable, 0 to disable
+                feature[1].start = 0;                          // Apply from the start of the buffer
+                feature[1].end = (unsigned int)-1;             // Apply to the end of the buffer
+
+                // Required otherwise we get tons of ligatures with modern fonts like SF-Pro
+                feature[2].tag = HB_TAG('l', 'i', 'g', 'a'); // Tag for enabling ligatures
+                feature[2].value = 0;                        // 1 to enable, 0 to disable
+                feature[2].start = 0;                        // Apply from the start of the buffer
+                feature[2].end = (unsigned int)-1;           // Apply to the end of the buffer
+
+                hb_shape(hb_font, hb_buffer, &feature[0], 3);
+
+                unsigned int glyph_count = 0;
+                hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(hb_buffer, &glyph_count);
+                // Make sure that hb_shape has not added glyphs
+                if (glyph_count != 2)
                 {
-                    // Sorry harfbuzz devs; I know this is the worst thing
-                    // to do and will break in many ways. But it works for
-                    // our use case.
-
-                    // No kerning pairs if secondary font is involved
-                    if ( std::get<1>(ch0).secondaryFont ||
-                         std::get<1>(ch1).secondaryFont ) {
-                        continue;
-                    }
-
-                    hb_codepoint_t codepoint_l = std::get<0>(ch0);
-                    hb_codepoint_t codepoint_r = std::get<0>(ch1);
-                    hb_codepoint_t utf32_l = std::get<1>(ch0).utf32;
-                    hb_codepoint_t utf32_r = std::get<1>(ch1).utf32;
-
-                    hb_buffer_t *hb_buffer = hb_buffer_create();
-                    hb_buffer_set_direction(hb_buffer, HB_DIRECTION_LTR);
-                    hb_buffer_set_script(hb_buffer, HB_SCRIPT_COMMON);
-                    hb_buffer_set_language(hb_buffer, hb_language_from_string("en", -1));
-                    hb_buffer_add_utf32(hb_buffer, &utf32_l, 1, 0, -1);
-                    hb_buffer_add_utf32(hb_buffer, &utf32_r, 1, 0, -1);
-
-                    hb_feature_t feature[3] = {};
-                    feature[0].tag = HB_TAG('t', 'n', 'u', 'm');      // Tag for Tabular Figures
-                    feature[0].value = config.tabularNumbers ? 1 : 0; // 1 to enable, 0 to disable
-                    feature[0].start = 0;                             // Apply from the start of the buffer
-                    feature[0].end = (unsigned int)-1;                // Apply to the end of the buffer
-
-                    feature[1].tag = HB_TAG('z', 'e', 'r', 'o');   // Tag for slashed zeros
-                    feature[1].value = config.slashedZero ? 1 : 0; // 1 to enable, 0 to disable
-                    feature[1].start = 0;                          // Apply from the start of the buffer
-                    feature[1].end = (unsigned int)-1;             // Apply to the end of the buffer
-
-                    // Required otherwise we get tons of ligatures with modern fonts like SF-Pro
-                    feature[2].tag = HB_TAG('l', 'i', 'g', 'a'); // Tag for enabling ligatures
-                    feature[2].value = 0;                        // 1 to enable, 0 to disable
-                    feature[2].start = 0;                        // Apply from the start of the buffer
-                    feature[2].end = (unsigned int)-1;           // Apply to the end of the buffer
-
-                    hb_shape(hb_font, hb_buffer, &feature[0], 3);
-
-                    unsigned int glyph_count = 0;
-                    hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(hb_buffer, &glyph_count);
-                    // Make sure that hb_shape has not added glyphs
-                    if (glyph_count != 2)
-                    {
-                        reshapeCount++;
-                        hb_buffer_destroy(hb_buffer);
-                        continue;
-                    }
-
-                    // Make sure that hb_shape has not changed glyphs on us.
-                    if (glyph_info[0].codepoint != codepoint_l || glyph_info[1].codepoint != codepoint_r)
-                    {
-                        reshapeCount++;
-                        hb_buffer_destroy(hb_buffer);
-                        continue;
-                    }
-
-                    // Make sure that hb_shape has not added glyphs
-                    hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(hb_buffer, &glyph_count);
-                    if (glyph_count != 2)
-                    {
-                        reshapeCount++;
-                        hb_buffer_destroy(hb_buffer);
-                        continue;
-                    }
-
-                    // Convert back to pixel size
-                    float advance = float(config.fontSize) * float(glyph_pos[0].x_advance) / float(x_scale);
-
-                    // Convert back to integer pixels
-                    // We use ceil/floor here to favor the original advance and reduce pairs.
-                    int advanceInt = int(ceil(advance));
-                    if ( advance > float(std::get<1>(ch0).xAdvance)) {
-                        advanceInt = int(floor(advance));
-                    }
-
-                    // If we have something else than a regular advance and things look good,
-                    // i.e. there has been no reshaping we can actually record it as a new 'kerning' value
-                    if (advanceInt != std::get<1>(ch0).xAdvance)
-                    {
-                        FontInfo::Kerning kerning;
-                        kerning.first = std::get<1>(ch0).utf32;
-                        kerning.second = std::get<1>(ch1).utf32;
-                        kerning.amount = advanceInt - std::get<1>(ch0).xAdvance;
-                        f.kernings.push_back(kerning);
-                        specialCount++;
-                    }
-                    else
-                    {
-                        regularCount++;
-                    }
+                    reshapeCount++;
                     hb_buffer_destroy(hb_buffer);
+                    return;
                 }
-            }
+
+                // Make sure that hb_shape has not changed glyphs on us.
+                if (glyph_info[0].codepoint != codepoint_l || glyph_info[1].codepoint != codepoint_r)
+                {
+                    reshapeCount++;
+                    hb_buffer_destroy(hb_buffer);
+                    return;
+                }
+
+                // Make sure that hb_shape has not added glyphs
+                hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(hb_buffer, &glyph_count);
+                if (glyph_count != 2)
+                {
+                    reshapeCount++;
+                    hb_buffer_destroy(hb_buffer);
+                    return;
+                }
+
+                // Convert back to pixel size
+                float advance = float(config.fontSize) * float(glyph_pos[0].x_advance) / float(x_scale);
+
+                // Convert back to integer pixels
+                // We use ceil/floor here to favor the original advance and reduce pairs.
+                int advanceInt = int(ceil(advance));
+                if ( advance > float(std::get<1>(ch0).xAdvance)) {
+                    advanceInt = int(floor(advance));
+                }
+
+                // If we have something else than a regular advance and things look good,
+                // i.e. there has been no reshaping we can actually record it as a new 'kerning' value
+                if (advanceInt != std::get<1>(ch0).xAdvance)
+                {
+                    FontInfo::Kerning kerning;
+                    kerning.first = std::get<1>(ch0).utf32;
+                    kerning.second = std::get<1>(ch1).utf32;
+                    kerning.amount = advanceInt - std::get<1>(ch0).xAdvance;
+                    result.push_back(kerning);
+                    specialCount++;
+                }
+                else
+                {
+                    regularCount++;
+                }
+                hb_buffer_destroy(hb_buffer);
+            });
             hb_font_destroy(hb_font);
-            (void)specialCount;
-            (void)regularCount;
-            (void)reshapeCount;
-            // printf("Regular advances %d, special advances %d, reshape events %d\n", int(regularCount), int(specialCount), int(reshapeCount));
+            stats.addCounter("kerning regular advances", regularCount);
+            stats.addCounter("kerning special advances", specialCount);
+            stats.addCounter("kerning reshape events", reshapeCount);
         }
         else
         { // Don't do the old extended method using FT, the above will give way better results
-            for (const auto &ch0 : glyphs)
+            forEachPair([&](const Glyphs::value_type &ch0, const Glyphs::value_type &ch1)
             {
-                for (const auto &ch1 : glyphs)
+                // No kerning pairs if a fallback font or a glyph without char is involved
+                if ( std::get<1>(ch0).font || std::get<1>(ch0).stringOnly ||
+                     std::get<1>(ch1).font || std::get<1>(ch1).stringOnly ) {
+                    return;
+                }
+
+                const auto k = static_cast<std::int16_t>(font.getKerning(std::get<1>(ch0).utf32, std::get<1>(ch1).utf32, kerningMode));
+                if (k)
                 {
-                    // No kerning pairs if secondary font is involved
-                    if ( std::get<1>(ch0).secondaryFont ||
-                         std::get<1>(ch1).secondaryFont ) {
-                        continue;
-                    }
-
-                    const auto k = static_cast<std::int16_t>(font.getKerning(std::get<1>(ch0).utf32, std::get<1>(ch1).utf32, kerningMode));
-                    if (k)
-                    {
-                        FontInfo::Kerning kerning;
-                        kerning.first = std::get<1>(ch0).utf32;
-                        kerning.second = std::get<1>(ch1).utf32;
-                        kerning.amount = k;
-                        f.kernings.push_back(kerning);
-                    }
+                    FontInfo::Kerning kerning;
+                    kerning.first = std::get<1>(ch0).utf32;
+                    kerning.second = std::get<1>(ch1).utf32;
+                    kerning.amount = k;
+                    result.push_back(kerning);
                 }
-            }
+            });
         }
     }
 
-    f.extraInfo = config.extraInfo;
+    return result;
+}
 
+void App::writeFontInfoFile(const FontInfo &f, const Config &config, Stats &stats)
+{
     const auto dataFileName = config.output + ".fnt";
+    const auto phase = stats.phase("write descriptor");
     switch (config.dataFormat)
     {
     case Config::DataFormat::Xml:
@@ -619,23 +1333,210 @@ void App::writeFontInfoFile(const Glyphs &glyphs, const Config &config, const ft
         f.writeToCborFile(dataFileName);
         break;
     }
+    stats.addFile(dataFileName);
 }
 
 void App::execute(const int argc, char *argv[])
 {
+    Stats stats;
+    auto parsePhase = stats.phase("parse options");
     const auto config = ProgramOptions::parseCommandLine(argc, argv);
+    parsePhase.stop();
+
+    if (!config.convertFile.empty())
+    {
+        convert(config, stats);
+        if (config.stats)
+            stats.print(std::cout);
+        if (!config.statsJsonFile.empty())
+            stats.writeToJsonFile(config.statsJsonFile);
+        return;
+    }
 
     ft::Library library;
+    // stdout carries the protocol in service mode
+    auto& log = config.serve ? std::cerr : std::cout;
     if (config.verbose)
-        std::cout << "freetype " << library.getVersionString() << "\n";
+        log << "freetype " << library.getVersionString() << "\n";
+
+    auto loadPhase = stats.phase("load fonts");
+    FontFileRegistry fontFiles;
+    auto fonts = FontChain::load(library, fontFiles, config);
+    loadPhase.stop();
+    if (fonts.size() > 1)
+        stats.addCounter("fallback fonts", fonts.size() - 1);
+
+    if (config.serve)
+    {
+        DynamicAtlas atlas(config, fonts);
+        AtlasService::run(atlas, config, fonts.primary(), std::cin, std::cout, stats);
+    }
+    else if (!config.fontInstances.empty())
+        generateInstances(config, fonts, stats);
+    else if (config.allFaces)
+        generateFaces(config, fontFiles, static_cast<std::uint32_t>(fonts.primary().getFaceCount()), stats);
+    else if (config.incremental && std::filesystem::exists(config.output + ".fnt"))
+        updateIncrementally(config, fonts, stats);
+    else
+        generate(config, fonts, stats);
+
+    if (config.stats)
+        stats.print(log);
+    if (!config.statsJsonFile.empty())
+        stats.writeToJsonFile(config.statsJsonFile);
+}
+
+void App::generate(const Config &config, const FontChain &fonts, Stats &stats)
+{
+    auto glyphs = collectGlyphInfo(fonts, config.allChars ? collectAllChars(fonts.primary()) : config.chars, config.tabularNumbers, config.slashedZero, stats);
+    generate(config, glyphs, fonts, stats);
+}
+
+// Instances of a variable font are generated from one loaded face. The cmap is shared, so missing characters
+// are reported once; glyphs are shaped per instance as FeatureVariations may substitute others.
+void App::generateInstances(const Config &config, FontChain &fonts, Stats &stats)
+{
+    auto &font = fonts.primary();
+    const auto setInstance = [&](const Config::FontInstance &instance)
+    {
+        const auto phase = stats.phase("set instance");
+        font.setVariations(instance.name, instance.axes);
+    };
+
+    auto chars = config.allChars ? collectAllChars(font) : config.chars;
+    stats.addCounter("requested chars", chars.size());
 
-    ft::Font font(library, config.fontFile, config.fontSize, 0, config.monochrome, config.lightHinting, config.noHinting);
-    ft::Font secondaryFont(library, config.secondaryFontFile, config.fontSize, 0, config.monochrome, config.lightHinting, config.noHinting);
-    auto glyphs = collectGlyphInfo(font, secondaryFont, config.allChars ? collectAllChars(font) : config.chars, config.tabularNumbers, config.slashedZero);
-    const auto pages = arrangeGlyphs(glyphs, config);
+    for (std::size_t i = 0; i < config.fontInstances.size(); ++i)
+    {
+        const auto &instance = config.fontInstances[i];
+        setInstance(instance);
+        ShapedGlyphs shapedGlyphs;
+        {
+            const auto phase = stats.phase("shape glyphs");
+            shapedGlyphs = shapeGlyphs(fonts, chars, config.tabularNumbers, config.slashedZero);
+        }
+        stats.addCounter("shaped glyphs", shapedGlyphs.size());
+        if (i == 0)
+            chars = fonts.filterChars(chars);
+
+        auto instanceConfig = config;
+        if (config.fontInstances.size() > 1)
+            instanceConfig.output = config.output + "_" + instance.getLabel();
+        auto glyphs = collectGlyphMetrics(shapedGlyphs, fonts, stats);
+        generate(instanceConfig, glyphs, fonts, stats);
+    }
+    stats.addCounter("font instances", config.fontInstances.size());
+}
+
+void App::generate(const Config &config, Glyphs &glyphs, const FontChain &fonts, Stats &stats)
+{
+    const auto fontInfo = generateFontInfo(config, glyphs, fonts, [&](const Glyphs &placedGlyphs, const std::vector<Config::Size> &pages)
+                                           { return renderTextures(placedGlyphs, config, fonts, pages, stats); }, stats);
+    writeFontInfoFile(fontInfo, config, stats);
+}
+
+FontInfo App::generateFontInfo(const Config &config, Glyphs &glyphs, const FontChain &fonts, const PageRenderer &renderPages, Stats &stats)
+{
+    std::vector<ShapedString> strings;
+    if (!config.strings.empty())
+    {
+        const auto phase = stats.phase("shape strings");
+        strings = shapeStrings(fonts, config.strings, config.tabularNumbers, config.slashedZero);
+        addStringGlyphs(glyphs, strings, fonts, stats);
+    }
+    collectSubpixelPhases(glyphs, fonts, config.subpixelPhases, stats);
+
+    std::vector<Config::Size> pages;
+    {
+        const auto phase = stats.phase("arrange glyphs");
+        pages = arrangeGlyphs(glyphs, config, stats);
+    }
     if (config.useMaxTextureCount && pages.size() > config.maxTextureCount)
         throw std::runtime_error("too many generated textures (more than --max-texture-count)");
 
-    const auto fileNames = renderTextures(glyphs, config, font, secondaryFont, pages);
-    writeFontInfoFile(glyphs, config, font, secondaryFont, fileNames, pages);
+    const auto fileNames = renderPages(glyphs, pages);
+    auto fontInfo = buildFontInfo(glyphs, config, fonts.primary(), fileNames, pages, stats);
+    if (!strings.empty())
+    {
+        fontInfo.runs = getRuns(strings, glyphs, config);
+        stats.addCounter("shaped strings", fontInfo.runs.size());
+    }
+    return fontInfo;
+}
+
+// Generates <output>_<face index> for every face of a collection, several faces at a time. The font file is
+// mapped once and shared; each worker has its own FreeType library, faces of a library can't be used concurrently.
+void App::generateFaces(const Config &config, FontFileRegistry &fontFiles, const std::uint32_t faceCount, Stats &stats)
+{
+    std::vector<Stats> faceStats(faceCount);
+    std::vector<std::exception_ptr> errors(faceCount);
+    std::atomic<std::uint32_t> next{0};
+    const auto worker = [&]()
+    {
+        ft::Library library;
+        for (auto face = next++; face < faceCount; face = next++)
+        {
+            try
+            {
+                auto faceConfig = config;
+                faceConfig.output = config.output + "_" + std::to_string(face);
+                auto loadPhase = faceStats[face].phase("load fonts");
+                const auto fonts = FontChain::load(library, fontFiles, config, static_cast<int>(face));
+                loadPhase.stop();
+                generate(faceConfig, fonts, faceStats[face]);
+            }
+            catch (...)
+            {
+                errors[face] = std::current_exception();
+            }
+        }
+    };
+
+    const auto threadCount = std::min(faceCount, std::max(std::thread::hardware_concurrency(), 1u));
+    std::vector<std::thread> threads;
+    for (std::uint32_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto &thread : threads)
+        thread.join();
+
+    for (const auto &error : errors)
+        if (error)
+            std::rethrow_exception(error);
+    for (const auto &s : faceStats)
+        stats.merge(s);
+    stats.addCounter("faces", faceCount);
+}
+
+// Re-emits an existing descriptor in Config::dataFormat (page files are left as they are).
+void App::convert(const Config &config, Stats &stats)
+{
+    FontInfo fontInfo;
+    {
+        const auto phase = stats.phase("read descriptor");
+        fontInfo = FontInfo::readFromFile(config.convertFile);
+    }
+    stats.addCounter("chars", fontInfo.chars.size());
+    stats.addCounter("kerning pairs", fontInfo.kernings.size());
+    writeFontInfoFile(fontInfo, config, stats);
+}
+
+// Keeps the glyphs of the previous <output>.fnt where they are and places only the new ones.
+void App::updateIncrementally(const Config &config, const FontChain &fonts, Stats &stats)
+{
+    FontInfo previous;
+    {
+        const auto phase = stats.phase("read previous descriptor");
+        previous = FontInfo::readFromFile(config.output + ".fnt");
+    }
+
+    const auto chars = config.allChars ? collectAllChars(fonts.primary()) : config.chars;
+    DynamicAtlas atlas(config, fonts);
+    atlas.restore(previous, chars, stats);
+    const auto update = atlas.add(chars, stats);
+    warnMissingChars(update.missing);
+    if (config.verbose)
+        std::cout << update.chars.size() << " new glyph(s), " << atlas.getPages().size() - update.firstNewPage << " new page(s)\n";
+
+    atlas.save(stats);
 }
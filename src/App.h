@@ -1,9 +1,16 @@
 #pragma once
 #include <cstdint>
+#include <functional>
 #include <map>
+#include <set>
+#include <string>
+#include <tuple>
 #include "external/maxRectsBinPack/MaxRectsBinPack.h"
 #include "Config.h"
+#include "FontChain.h"
+#include "FontInfo.h"
 #include "GlyphInfo.h"
+#include "Stats.h"
 #include "freeType/FtLibrary.h"
 #include "freeType/FtFont.h"
 
@@ -12,15 +19,80 @@ class App
 public:
     static void execute(int argc, char* argv[]) ;
 
-private:
+    // Keyed by glyph index, with the index of the font in the chain in the top byte (see getGlyphKey).
     typedef std::map<std::uint32_t, GlyphInfo> Glyphs;
+    // Glyph index, utf32 code, index of the font in the chain.
+    typedef std::set<std::tuple<std::uint32_t, std::uint32_t, std::uint32_t>> ShapedGlyphs;
+
+    static std::uint32_t getGlyphKey(std::uint32_t font, std::uint32_t glyphIndex)
+    {
+        return font << 24 | glyphIndex;
+    }
+    static std::uint32_t getGlyphIndex(std::uint32_t glyphKey)
+    {
+        return glyphKey & 0xFFFFFFu;
+    }
+
+    // Generation pipeline stages, called in this order by execute() (also used by benchmarks).
+    static CharSet collectAllChars(const ft::Font& font);
+    static Glyphs collectGlyphInfo(const FontChain& fonts, const CharSet& utf32codes, bool tabularNumbers, bool slashedZero, Stats& stats);
+    static ShapedGlyphs shapeGlyphs(const FontChain& fonts, const CharSet& utf32codes, bool tabularNumbers, bool slashedZero);
+    static Glyphs collectGlyphMetrics(const ShapedGlyphs& shapedGlyphs, const FontChain& fonts, Stats& stats);
 
-    static std::set<std::uint32_t> collectAllChars(const ft::Font& font);
+    // A line of --strings-file shaped by HarfBuzz, pen positions are in 26.6 pixels.
+    struct ShapedString
+    {
+        struct Glyph
+        {
+            std::uint32_t key = 0; // see getGlyphKey
+            std::int32_t x = 0;
+            std::int32_t y = 0; // down
+        };
+        std::vector<Glyph> glyphs;
+        std::int32_t advance = 0;
+    };
+    static std::vector<ShapedString> shapeStrings(const FontChain& fonts, const std::vector<std::u32string>& strings, bool tabularNumbers, bool slashedZero);
+    // Adds the glyphs of the strings that no char maps to (ligatures, contextual forms) as stringOnly glyphs.
+    static void addStringGlyphs(Glyphs& glyphs, const std::vector<ShapedString>& strings, const FontChain& fonts, Stats& stats);
+    static void collectSubpixelPhases(Glyphs& glyphs, const FontChain& fonts, std::uint32_t phases, Stats& stats);
+    static std::uint32_t getPhaseCellWidth(const GlyphInfo& glyph, std::uint32_t additionalWidth, const Config& config);
     static std::vector<rbp::RectSize> getGlyphRectangles(const Glyphs& glyphs, std::uint32_t additionalWidth, std::uint32_t additionalHeight, const Config& config);
-    static Glyphs collectGlyphInfo(const ft::Font& font, const ft::Font& secondaryFont, const std::set<std::uint32_t>& utf32codes, bool tabularNumbers, bool slashedZero);
-    static std::set<std::tuple<std::uint32_t, std::uint32_t, bool>> shapeGlyphs(const ft::Font& font, const ft::Font& secondaryFont, const std::set<std::uint32_t>& utf32codes, bool tabularNumbers, bool slashedZero);
-    static std::vector<Config::Size> arrangeGlyphs(Glyphs& glyphs, const Config& config);
-    static std::vector<std::string> renderTextures(const Glyphs& glyphs, const Config& config, const ft::Font& font, const ft::Font& secondaryFont, const std::vector<Config::Size>& pages);
+    static std::vector<Config::Size> arrangeGlyphs(Glyphs& glyphs, const Config& config, Stats& stats);
+    static std::string getPageGroup(const GlyphInfo& glyph, const Config& config);
+    static std::vector<FontInfo::PageGroup> getPageGroups(const Glyphs& glyphs, const Config& config);
+    static std::vector<std::uint32_t> renderPage(const Glyphs& glyphs, const Config& config, const FontChain& fonts, const Config::Size& size, std::uint32_t page, Stats& stats);
+    // Renders a page in strips of stripHeight rows (the last one may be shorter), top to bottom, each passed to writeStrip
+    // as rows of s.w pixels. Memory is bounded by the strip height plus the tallest glyph cell, not by the page area.
+    static void renderPageStrips(const Glyphs& glyphs, const Config& config, const FontChain& fonts, const Config::Size& s, std::uint32_t page,
+                                 std::uint32_t stripHeight, const std::function<void(const std::uint32_t*, std::uint32_t)>& writeStrip, Stats& stats);
+    static std::vector<std::string> renderTextures(const Glyphs& glyphs, const Config& config, const FontChain& fonts, const std::vector<Config::Size>& pages, Stats& stats);
+    static std::vector<std::uint32_t> getColorPages(const Glyphs& glyphs);
+    static Config getColorPageConfig(const Config& config);
+    static void blendBackground(std::uint32_t* begin, std::uint32_t* end, const Config& config);
+    static std::string getPageFileName(const Config& config, std::uint32_t page, std::size_t pageCount);
     static void savePng(const std::string& fileName, const std::uint32_t* buffer, std::uint32_t w, std::uint32_t h, bool withAlpha);
-    static void writeFontInfoFile(const Glyphs& glyphs, const Config& config, const ft::Font& font, const ft::Font& secondaryFont, const std::vector<std::string>& fileNames, const std::vector<Config::Size>& pages);
+    static FontInfo buildFontInfo(const Glyphs& glyphs, const Config& config, const ft::Font& font, const std::vector<std::string>& fileNames, const std::vector<Config::Size>& pages, Stats& stats);
+    static FontInfo::Char getCharInfo(const GlyphInfo& glyph, const Config& config);
+    static std::vector<FontInfo::Run> getRuns(const std::vector<ShapedString>& strings, const Glyphs& glyphs, const Config& config);
+    static std::vector<FontInfo::Kerning> getKerningPairs(const Glyphs& glyphs, const Config& config, const ft::Font& font, Stats& stats);
+    static void writeFontInfoFile(const FontInfo& fontInfo, const Config& config, Stats& stats);
+
+    // Makes pages of the placed glyphs (files or memory) and returns their file names.
+    typedef std::function<std::vector<std::string>(const Glyphs& glyphs, const std::vector<Config::Size>& pages)> PageRenderer;
+    // The generation pipeline shared by fontbm and libfontbm: adds the glyphs of Config::strings and the subpixel
+    // phases, places the glyphs on pages, has renderPages make them and returns the descriptor.
+    static FontInfo generateFontInfo(const Config& config, Glyphs& glyphs, const FontChain& fonts, const PageRenderer& renderPages, Stats& stats);
+
+private:
+    static void generate(const Config& config, const FontChain& fonts, Stats& stats);
+    static void generate(const Config& config, Glyphs& glyphs, const FontChain& fonts, Stats& stats);
+    static void generateInstances(const Config& config, FontChain& fonts, Stats& stats);
+    static void generateFaces(const Config& config, FontFileRegistry& fontFiles, std::uint32_t faceCount, Stats& stats);
+    static void updateIncrementally(const Config& config, const FontChain& fonts, Stats& stats);
+    static void convert(const Config& config, Stats& stats);
+    static void renderGlyphCell(std::uint32_t* surface, std::uint32_t surfaceW, std::uint32_t surfaceH, std::uint32_t top, std::uint32_t glyphKey,
+                                const GlyphInfo& glyph, std::uint32_t color, const Config& config, const FontChain& fonts, Stats& stats);
+    static std::vector<Config::Size> arrangeGlyphsInLayers(Glyphs& glyphs, const Config& config, Stats& stats);
+    static std::string formatCharRanges(const CharSet& chars);
+    static void warnMissingChars(const CharSet& missing);
 };
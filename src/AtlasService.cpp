@@ -0,0 +1,124 @@
+#include "AtlasService.h"
+#include <string>
+#include <vector>
+#include "ProgramOptions.h"
+#include "external/utf8cpp/utf8.h"
+#include "utils/encodeBase64.h"
+
+void AtlasService::run(DynamicAtlas& atlas, const Config& config, const ft::Font& font, std::istream& in, std::ostream& out, Stats& stats)
+{
+    const auto& pageSize = config.textureSizeList.back();
+    out << "common"
+        << " lineHeight=" << font.height
+        << " base=" << font.ascent
+        << " scaleW=" << pageSize.w
+        << " scaleH=" << pageSize.h
+        << "\n";
+    writeUpdate(atlas, atlas.add(config.allChars ? App::collectAllChars(font) : config.chars, stats), config, out);
+    out << "end" << std::endl;
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty())
+            continue;
+
+        const auto space = line.find(' ');
+        const auto command = line.substr(0, space);
+        const auto argument = space == std::string::npos ? std::string() : line.substr(space + 1);
+        if (command == "quit")
+            break;
+
+        try
+        {
+            if (command == "chars")
+                writeUpdate(atlas, atlas.add(ProgramOptions::parseCharsString(argument), stats), config, out);
+            else if (command == "text")
+            {
+                std::vector<std::uint32_t> codes;
+                utf8::utf8to32(argument.begin(), argument.end(), std::back_inserter(codes));
+                CharSet chars;
+                for (const auto code : codes)
+                    chars.insert(code);
+                writeUpdate(atlas, atlas.add(chars, stats), config, out);
+            }
+            else if (command == "save")
+                atlas.save(stats);
+            else
+                out << "error unknown command " << command << "\n";
+        }
+        catch (const std::exception& e)
+        {
+            out << "error " << e.what() << "\n";
+        }
+        out << "end" << std::endl;
+    }
+}
+
+void AtlasService::writeUpdate(const DynamicAtlas& atlas, const DynamicAtlas::Update& update, const Config& config, std::ostream& out)
+{
+    const auto& pages = atlas.getPages();
+    for (auto i = update.firstNewPage; i < pages.size(); ++i)
+        out << "page id=" << i << " width=" << pages[i].size.w << " height=" << pages[i].size.h << "\n";
+
+    for (const auto& c : update.chars)
+        out << "char"
+            << " id=" << c.id
+            << " x=" << c.x
+            << " y=" << c.y
+            << " width=" << c.width
+            << " height=" << c.height
+            << " xoffset=" << c.xoffset
+            << " yoffset=" << c.yoffset
+            << " xadvance=" << c.xadvance
+            << " page=" << static_cast<int>(c.page)
+            << " chnl=" << static_cast<int>(c.chnl)
+            << "\n";
+
+    for (const auto& k : update.kernings)
+        out << "kerning first=" << k.first << " second=" << k.second << " amount=" << k.amount << "\n";
+
+    // Pixels of each dirty rectangle, row by row, RGBA (or RGB with --background-color), base64 encoded
+    const auto channels = config.backgroundTransparent ? 4u : 3u;
+    std::vector<std::uint8_t> bytes;
+    for (const auto& rect : update.dirtyRects)
+    {
+        const auto& page = pages[rect.page];
+        bytes.clear();
+        bytes.reserve(static_cast<std::size_t>(rect.w) * rect.h * channels);
+        for (std::uint32_t y = rect.y; y < rect.y + rect.h; ++y)
+        {
+            const auto row = page.pixels.data() + y * page.size.w;
+            for (std::uint32_t x = rect.x; x < rect.x + rect.w; ++x)
+                for (std::uint32_t c = 0; c < channels; ++c)
+                    bytes.push_back(static_cast<std::uint8_t>(row[x] >> (c * 8u)));
+        }
+        out << "update"
+            << " page=" << rect.page
+            << " x=" << rect.x
+            << " y=" << rect.y
+            << " width=" << rect.w
+            << " height=" << rect.h
+            << " format=" << (channels == 4 ? "rgba8" : "rgb8")
+            << " data=" << encodeBase64(bytes.data(), bytes.size())
+            << "\n";
+    }
+
+    if (!update.missing.empty())
+    {
+        out << "missing ";
+        bool first = true;
+        for (const auto& r : update.missing.ranges())
+        {
+            if (!first)
+                out << ",";
+            first = false;
+            out << r.first;
+            if (r.last != r.first)
+                out << "-" << r.last;
+        }
+        out << "\n";
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <istream>
+#include <ostream>
+#include "Config.h"
+#include "DynamicAtlas.h"
+#include "Stats.h"
+#include "freeType/FtFont.h"
+
+// Line based protocol of the dynamic atlas service (--serve), see README.
+class AtlasService
+{
+public:
+    static void run(DynamicAtlas& atlas, const Config& config, const ft::Font& font, std::istream& in, std::ostream& out, Stats& stats);
+
+private:
+    static void writeUpdate(const DynamicAtlas& atlas, const DynamicAtlas::Update& update, const Config& config, std::ostream& out);
+};
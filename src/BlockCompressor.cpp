@@ -0,0 +1,531 @@
+#include "BlockCompressor.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Runs fn(row) for rows [0, rows) on all hardware threads.
+template <typename F>
+void forEachRow(const std::uint32_t rows, const F& fn)
+{
+    const auto threadCount = std::min(rows, std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<std::uint32_t> next{0};
+    const auto worker = [&]()
+    {
+        for (auto row = next++; row < rows; row = next++)
+            fn(row);
+    };
+
+    std::vector<std::thread> threads;
+    for (std::uint32_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads)
+        t.join();
+}
+
+int square(const int v)
+{
+    return v * v;
+}
+
+// Writes little-endian bit fields (BC7), the block must be zeroed.
+class BitWriter
+{
+public:
+    explicit BitWriter(std::uint8_t* data) : data(data) {}
+
+    void write(const std::uint32_t value, const unsigned bits)
+    {
+        for (unsigned i = 0; i < bits; ++i, ++pos)
+            if ((value >> i) & 1u)
+                data[pos >> 3u] |= static_cast<std::uint8_t>(1u << (pos & 7u));
+    }
+
+private:
+    std::uint8_t* data;
+    unsigned pos = 0;
+};
+
+void writeBigEndian(const std::uint64_t bits, std::uint8_t* block)
+{
+    for (int i = 0; i < 8; ++i)
+        block[i] = static_cast<std::uint8_t>(bits >> (56 - 8 * i));
+}
+
+const int eacModifiers[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14},
+    {-3, -7, -10, -13, 2, 6, 9, 12},
+    {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12},
+    {-3, -6, -8, -12, 2, 5, 7, 11},
+    {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10},
+    {-3, -5, -8, -11, 2, 4, 7, 10},
+    {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9},
+    {-2, -4, -8, -10, 1, 3, 7, 9},
+    {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},
+    {-1, -2, -3, -10, 0, 1, 2, 9},
+    {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8},
+};
+
+const int etcModifiers[8][4] = {
+    {2, 8, -2, -8},
+    {5, 17, -5, -17},
+    {9, 29, -9, -29},
+    {13, 42, -13, -42},
+    {18, 60, -18, -60},
+    {24, 80, -24, -80},
+    {33, 106, -33, -106},
+    {47, 183, -47, -183},
+};
+
+// EAC block: a base codeword, a multiplier and one of 16 modifier tables, texels stored in column order.
+// elevenBit selects R11 (base * 8 + 4, values decoded to 11 bits), otherwise it is the ETC2 alpha block.
+void encodeEac(const std::uint8_t* values, const bool elevenBit, std::uint8_t* block)
+{
+    const int maxValue = elevenBit ? 2047 : 255;
+    int targets[16];
+    int lo = maxValue;
+    int hi = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        targets[i] = elevenBit ? (values[i] * 2047 + 127) / 255 : values[i];
+        lo = std::min(lo, targets[i]);
+        hi = std::max(hi, targets[i]);
+    }
+
+    int bestError = std::numeric_limits<int>::max();
+    int bestBase = 0;
+    int bestMul = 0;
+    int bestTable = 0;
+    const auto evaluate = [&](const int base, const int mul, const int table)
+    {
+        const int baseValue = elevenBit ? base * 8 + 4 : base;
+        const int step = elevenBit ? (mul ? mul * 8 : 1) : mul;
+        int palette[8];
+        for (int i = 0; i < 8; ++i)
+            palette[i] = std::clamp(baseValue + eacModifiers[table][i] * step, 0, maxValue);
+
+        int error = 0;
+        for (int t = 0; t < 16 && error < bestError; ++t)
+        {
+            int texelError = std::numeric_limits<int>::max();
+            for (int i = 0; i < 8; ++i)
+                texelError = std::min(texelError, square(targets[t] - palette[i]));
+            error += texelError;
+        }
+        if (error < bestError)
+        {
+            bestError = error;
+            bestBase = base;
+            bestMul = mul;
+            bestTable = table;
+        }
+    };
+
+    // Base centering each table range on the value range; uniform blocks only need the smallest steps.
+    const int minMul = elevenBit ? 0 : 1;
+    const int maxMul = lo == hi ? 1 : 15;
+    for (int table = 0; table < 16 && bestError; ++table)
+        for (int mul = minMul; mul <= maxMul && bestError; ++mul)
+        {
+            const int step = elevenBit ? (mul ? mul * 8 : 1) : mul;
+            const int center = (lo + hi) / 2 - (eacModifiers[table][3] + eacModifiers[table][7]) * step / 2;
+            evaluate(std::clamp(elevenBit ? center / 8 : center, 0, 255), mul, table); // nearest base * 8 + 4 for R11
+        }
+    const auto centerBase = bestBase;
+    for (int base = std::max(centerBase - 2, 0); base <= std::min(centerBase + 2, 255) && bestError; ++base)
+        evaluate(base, bestMul, bestTable);
+
+    const int baseValue = elevenBit ? bestBase * 8 + 4 : bestBase;
+    const int step = elevenBit ? (bestMul ? bestMul * 8 : 1) : bestMul;
+    std::uint64_t bits = (static_cast<std::uint64_t>(bestBase) << 56u) | (static_cast<std::uint64_t>(bestMul) << 52u)
+        | (static_cast<std::uint64_t>(bestTable) << 48u);
+    for (int y = 0; y < 4; ++y)
+        for (int x = 0; x < 4; ++x)
+        {
+            const auto target = targets[y * 4 + x];
+            int bestIndex = 0;
+            int bestTexelError = std::numeric_limits<int>::max();
+            for (int i = 0; i < 8; ++i)
+            {
+                const auto e = square(target - std::clamp(baseValue + eacModifiers[bestTable][i] * step, 0, maxValue));
+                if (e < bestTexelError)
+                {
+                    bestTexelError = e;
+                    bestIndex = i;
+                }
+            }
+            bits |= static_cast<std::uint64_t>(bestIndex) << (45u - 3u * static_cast<unsigned>(x * 4 + y));
+        }
+    writeBigEndian(bits, block);
+}
+
+// ETC1 compatible ETC2 color block (individual or differential mode, both flips tried).
+void encodeEtcColor(const std::uint32_t* texels, std::uint8_t* block)
+{
+    int rgb[16][3];
+    for (int t = 0; t < 16; ++t)
+        for (int c = 0; c < 3; ++c)
+            rgb[t][c] = static_cast<int>((texels[t] >> (8u * static_cast<unsigned>(c))) & 0xFFu);
+
+    int bestError = std::numeric_limits<int>::max();
+    std::uint64_t bestBits = 0;
+    for (int flip = 0; flip < 2; ++flip)
+    {
+        const auto subblockOf = [flip](const int t) { return flip ? (t / 4 >= 2) : (t % 4 >= 2); };
+
+        int avg[2][3] = {};
+        for (int t = 0; t < 16; ++t)
+            for (int c = 0; c < 3; ++c)
+                avg[subblockOf(t)][c] += rgb[t][c];
+
+        int q[2][3];
+        bool differential = true;
+        for (int s = 0; s < 2; ++s)
+            for (int c = 0; c < 3; ++c)
+            {
+                avg[s][c] = (avg[s][c] + 4) / 8;
+                q[s][c] = (avg[s][c] * 31 + 127) / 255;
+            }
+        for (int c = 0; c < 3; ++c)
+            if (q[1][c] - q[0][c] < -4 || q[1][c] - q[0][c] > 3)
+                differential = false;
+
+        int base[2][3];
+        for (int s = 0; s < 2; ++s)
+            for (int c = 0; c < 3; ++c)
+            {
+                if (!differential)
+                    q[s][c] = (avg[s][c] * 15 + 127) / 255;
+                base[s][c] = differential ? (q[s][c] << 3) | (q[s][c] >> 2) : q[s][c] * 17;
+            }
+
+        std::uint64_t bits = 0;
+        int error = 0;
+        for (int s = 0; s < 2; ++s)
+        {
+            int bestSubblockError = std::numeric_limits<int>::max();
+            int bestTable = 0;
+            std::uint64_t bestIndices = 0;
+            for (int table = 0; table < 8; ++table)
+            {
+                int subblockError = 0;
+                std::uint64_t indices = 0;
+                for (int t = 0; t < 16; ++t)
+                {
+                    if (subblockOf(t) != s)
+                        continue;
+                    int bestIndex = 0;
+                    int bestTexelError = std::numeric_limits<int>::max();
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        int e = 0;
+                        for (int c = 0; c < 3; ++c)
+                            e += square(rgb[t][c] - std::clamp(base[s][c] + etcModifiers[table][i], 0, 255));
+                        if (e < bestTexelError)
+                        {
+                            bestTexelError = e;
+                            bestIndex = i;
+                        }
+                    }
+                    subblockError += bestTexelError;
+                    const auto k = static_cast<unsigned>((t % 4) * 4 + t / 4); // column order
+                    indices |= (static_cast<std::uint64_t>(bestIndex >> 1) << (16u + k)) | (static_cast<std::uint64_t>(bestIndex & 1) << k);
+                }
+                if (subblockError < bestSubblockError)
+                {
+                    bestSubblockError = subblockError;
+                    bestTable = table;
+                    bestIndices = indices;
+                }
+            }
+            error += bestSubblockError;
+            bits |= bestIndices | (static_cast<std::uint64_t>(bestTable) << (s ? 34u : 37u));
+        }
+
+        if (differential)
+            for (int c = 0; c < 3; ++c)
+                bits |= (static_cast<std::uint64_t>(q[0][c]) << (59u - 8u * static_cast<unsigned>(c)))
+                    | (static_cast<std::uint64_t>((q[1][c] - q[0][c]) & 7) << (56u - 8u * static_cast<unsigned>(c)));
+        else
+            for (int c = 0; c < 3; ++c)
+                bits |= (static_cast<std::uint64_t>(q[0][c]) << (60u - 8u * static_cast<unsigned>(c)))
+                    | (static_cast<std::uint64_t>(q[1][c]) << (56u - 8u * static_cast<unsigned>(c)));
+        bits |= (static_cast<std::uint64_t>(differential) << 33u) | (static_cast<std::uint64_t>(flip) << 32u);
+
+        if (error < bestError)
+        {
+            bestError = error;
+            bestBits = bits;
+        }
+    }
+    writeBigEndian(bestBits, block);
+}
+
+}
+
+std::size_t BlockCompressor::getBlockBytes(const Config::TextureCompression compression, const bool hasAlpha)
+{
+    switch (compression)
+    {
+    case Config::TextureCompression::Bc4:
+    case Config::TextureCompression::Eac:
+        return 8;
+    case Config::TextureCompression::Bc7:
+        return 16;
+    case Config::TextureCompression::Etc2:
+        return hasAlpha ? 16 : 8;
+    case Config::TextureCompression::None:
+        break;
+    }
+    throw std::logic_error("not a block compressed format");
+}
+
+std::vector<std::uint8_t> BlockCompressor::compress(const std::uint32_t* pixels, const std::uint32_t w, const std::uint32_t h,
+                                                    const Config::TextureCompression compression, const bool hasAlpha)
+{
+    if (w % blockDim || h % blockDim)
+        throw std::runtime_error("texture size " + std::to_string(w) + "x" + std::to_string(h) + " is not a multiple of the compression block size");
+
+    const auto blockBytes = getBlockBytes(compression, hasAlpha);
+    const auto blocksX = w / blockDim;
+    std::vector<std::uint8_t> result(static_cast<std::size_t>(blocksX) * (h / blockDim) * blockBytes);
+
+    forEachRow(h / blockDim, [&](const std::uint32_t blockY)
+    {
+        std::uint32_t texels[16];
+        std::uint8_t coverage[16];
+        for (std::uint32_t blockX = 0; blockX < blocksX; ++blockX)
+        {
+            for (std::uint32_t y = 0; y < blockDim; ++y)
+            {
+                const auto row = pixels + static_cast<std::size_t>(blockY * blockDim + y) * w + blockX * blockDim;
+                for (std::uint32_t x = 0; x < blockDim; ++x)
+                {
+                    texels[y * 4 + x] = hasAlpha ? row[x] : row[x] | 0xFF000000u;
+                    coverage[y * 4 + x] = static_cast<std::uint8_t>(row[x] >> 24u);
+                }
+            }
+
+            const auto block = result.data() + (static_cast<std::size_t>(blockY) * blocksX + blockX) * blockBytes;
+            switch (compression)
+            {
+            case Config::TextureCompression::Bc4:
+                encodeBc4(coverage, block);
+                break;
+            case Config::TextureCompression::Bc7:
+                encodeBc7(texels, block);
+                break;
+            case Config::TextureCompression::Etc2:
+                encodeEtc2(texels, hasAlpha, block);
+                break;
+            case Config::TextureCompression::Eac:
+                encodeEacR11(coverage, block);
+                break;
+            case Config::TextureCompression::None:
+                break;
+            }
+        }
+    });
+
+    return result;
+}
+
+void BlockCompressor::encodeBc4(const std::uint8_t* values, std::uint8_t* block)
+{
+    int lo = 255;
+    int hi = 0;
+    int innerLo = 255;
+    int innerHi = 0;
+    for (int t = 0; t < 16; ++t)
+    {
+        lo = std::min<int>(lo, values[t]);
+        hi = std::max<int>(hi, values[t]);
+        if (values[t] != 0 && values[t] != 255)
+        {
+            innerLo = std::min<int>(innerLo, values[t]);
+            innerHi = std::max<int>(innerHi, values[t]);
+        }
+    }
+
+    int bestError = std::numeric_limits<int>::max();
+    const auto tryEndpoints = [&](const int r0, const int r1)
+    {
+        // r0 > r1: 8 values interpolated between the endpoints, otherwise 6 values plus exact 0 and 255
+        int palette[8] = {r0, r1, 0, 0, 0, 0, 0, 255};
+        if (r0 > r1)
+            for (int i = 2; i < 8; ++i)
+                palette[i] = ((8 - i) * r0 + (i - 1) * r1 + 3) / 7;
+        else
+            for (int i = 2; i < 6; ++i)
+                palette[i] = ((6 - i) * r0 + (i - 1) * r1 + 2) / 5;
+
+        int error = 0;
+        std::uint64_t indices = 0;
+        for (int t = 0; t < 16; ++t)
+        {
+            int bestIndex = 0;
+            int bestTexelError = std::numeric_limits<int>::max();
+            for (int i = 0; i < 8; ++i)
+            {
+                const auto e = square(values[t] - palette[i]);
+                if (e < bestTexelError)
+                {
+                    bestTexelError = e;
+                    bestIndex = i;
+                }
+            }
+            error += bestTexelError;
+            indices |= static_cast<std::uint64_t>(bestIndex) << (3u * static_cast<unsigned>(t));
+        }
+
+        if (error < bestError)
+        {
+            bestError = error;
+            block[0] = static_cast<std::uint8_t>(r0);
+            block[1] = static_cast<std::uint8_t>(r1);
+            for (int i = 0; i < 6; ++i)
+                block[2 + i] = static_cast<std::uint8_t>(indices >> (8u * static_cast<unsigned>(i)));
+        }
+    };
+
+    tryEndpoints(hi, lo);
+    // Glyph edges: partial coverage between texels fully outside (0) and inside (255)
+    if (bestError && innerLo <= innerHi)
+        tryEndpoints(innerLo, innerHi);
+}
+
+void BlockCompressor::encodeBc7(const std::uint32_t* texels, std::uint8_t* block)
+{
+    // Mode 6: a single RGBA subset, 7 bit endpoints with a shared p-bit each and 4 bit indices.
+    static const int weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    int px[16][4];
+    int lo[4] = {255, 255, 255, 255};
+    int hi[4] = {0, 0, 0, 0};
+    int sum[4] = {};
+    for (int t = 0; t < 16; ++t)
+        for (int c = 0; c < 4; ++c)
+        {
+            px[t][c] = static_cast<int>((texels[t] >> (8u * static_cast<unsigned>(c))) & 0xFFu);
+            lo[c] = std::min(lo[c], px[t][c]);
+            hi[c] = std::max(hi[c], px[t][c]);
+            sum[c] += px[t][c];
+        }
+
+    // Endpoints on the bounding box diagonal, channels falling while the widest one rises are flipped.
+    int widest = 0;
+    for (int c = 1; c < 4; ++c)
+        if (hi[c] - lo[c] > hi[widest] - lo[widest])
+            widest = c;
+    int e0[4];
+    int e1[4];
+    for (int c = 0; c < 4; ++c)
+    {
+        int covariance = 0;
+        for (int t = 0; t < 16; ++t)
+            covariance += (16 * px[t][c] - sum[c]) * (16 * px[t][widest] - sum[widest]) / 16;
+        e0[c] = covariance < 0 ? hi[c] : lo[c];
+        e1[c] = covariance < 0 ? lo[c] : hi[c];
+    }
+
+    int bestError = std::numeric_limits<int>::max();
+    int bestQ[2][4] = {};
+    int bestP[2] = {};
+    int bestIndices[16] = {};
+    for (int p0 = 0; p0 < 2 && bestError; ++p0)
+        for (int p1 = 0; p1 < 2 && bestError; ++p1)
+        {
+            int q[2][4];
+            int endpoint[2][4];
+            for (int c = 0; c < 4; ++c)
+            {
+                q[0][c] = std::clamp((e0[c] - p0 + 1) / 2, 0, 127);
+                q[1][c] = std::clamp((e1[c] - p1 + 1) / 2, 0, 127);
+                endpoint[0][c] = (q[0][c] << 1) | p0;
+                endpoint[1][c] = (q[1][c] << 1) | p1;
+            }
+
+            int palette[16][4];
+            for (int i = 0; i < 16; ++i)
+                for (int c = 0; c < 4; ++c)
+                    palette[i][c] = ((64 - weights[i]) * endpoint[0][c] + weights[i] * endpoint[1][c] + 32) >> 6;
+
+            int error = 0;
+            int indices[16];
+            for (int t = 0; t < 16; ++t)
+            {
+                int bestTexelError = std::numeric_limits<int>::max();
+                for (int i = 0; i < 16; ++i)
+                {
+                    const auto e = square(px[t][0] - palette[i][0]) + square(px[t][1] - palette[i][1])
+                        + square(px[t][2] - palette[i][2]) + square(px[t][3] - palette[i][3]);
+                    if (e < bestTexelError)
+                    {
+                        bestTexelError = e;
+                        indices[t] = i;
+                    }
+                }
+                error += bestTexelError;
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                std::copy(&q[0][0], &q[0][0] + 8, &bestQ[0][0]);
+                bestP[0] = p0;
+                bestP[1] = p1;
+                std::copy(indices, indices + 16, bestIndices);
+            }
+        }
+
+    // The most significant bit of the first index is implicit (0)
+    if (bestIndices[0] >= 8)
+    {
+        for (int c = 0; c < 4; ++c)
+            std::swap(bestQ[0][c], bestQ[1][c]);
+        std::swap(bestP[0], bestP[1]);
+        for (auto& index : bestIndices)
+            index = 15 - index;
+    }
+
+    std::fill(block, block + 16, 0);
+    BitWriter bits(block);
+    bits.write(1u << 6u, 7);
+    for (int c = 0; c < 4; ++c)
+    {
+        bits.write(static_cast<std::uint32_t>(bestQ[0][c]), 7);
+        bits.write(static_cast<std::uint32_t>(bestQ[1][c]), 7);
+    }
+    bits.write(static_cast<std::uint32_t>(bestP[0]), 1);
+    bits.write(static_cast<std::uint32_t>(bestP[1]), 1);
+    for (int t = 0; t < 16; ++t)
+        bits.write(static_cast<std::uint32_t>(bestIndices[t]), t ? 4 : 3);
+}
+
+void BlockCompressor::encodeEacR11(const std::uint8_t* values, std::uint8_t* block)
+{
+    encodeEac(values, true, block);
+}
+
+void BlockCompressor::encodeEtc2(const std::uint32_t* texels, const bool withAlpha, std::uint8_t* block)
+{
+    if (withAlpha)
+    {
+        std::uint8_t alpha[16];
+        for (int t = 0; t < 16; ++t)
+            alpha[t] = static_cast<std::uint8_t>(texels[t] >> 24u);
+        encodeEac(alpha, false, block);
+        block += 8;
+    }
+    encodeEtcColor(texels, block);
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Config.h"
+
+// GPU block compression of rendered pages (--texture-compression), every format works on 4x4 texel blocks.
+// BC4 and EAC R11 store the glyph coverage (alpha) only, BC7 and ETC2 store RGBA.
+class BlockCompressor
+{
+public:
+    static const std::uint32_t blockDim = 4;
+
+    // Bytes per block, ETC2 carries an EAC alpha block only when the page has alpha.
+    static std::size_t getBlockBytes(Config::TextureCompression compression, bool hasAlpha);
+
+    // Compresses w * h RGBA8 pixels (R in the lowest byte), w and h must be multiples of blockDim.
+    // Block rows are encoded in parallel, blocks are stored in row order.
+    static std::vector<std::uint8_t> compress(const std::uint32_t* pixels, std::uint32_t w, std::uint32_t h,
+                                              Config::TextureCompression compression, bool hasAlpha);
+
+    // Single block encoders, the 16 texels are given in row order.
+    static void encodeBc4(const std::uint8_t* values, std::uint8_t* block);
+    static void encodeBc7(const std::uint32_t* texels, std::uint8_t* block);
+    static void encodeEacR11(const std::uint8_t* values, std::uint8_t* block);
+    static void encodeEtc2(const std::uint32_t* texels, bool withAlpha, std::uint8_t* block);
+};
@@ -0,0 +1,241 @@
+#include "external/catch.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include "BlockCompressor.h"
+
+namespace {
+
+// Reference decoders, texels in row order.
+
+std::uint64_t readBigEndian(const std::uint8_t* block)
+{
+    std::uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i)
+        bits = (bits << 8u) | block[i];
+    return bits;
+}
+
+void decodeBc4(const std::uint8_t* block, int* values)
+{
+    const int r0 = block[0];
+    const int r1 = block[1];
+    int palette[8] = {r0, r1, 0, 0, 0, 0, 0, 255};
+    for (int i = 2; i < (r0 > r1 ? 8 : 6); ++i)
+        palette[i] = r0 > r1 ? ((8 - i) * r0 + (i - 1) * r1 + 3) / 7 : ((6 - i) * r0 + (i - 1) * r1 + 2) / 5;
+    std::uint64_t indices = 0;
+    for (int i = 0; i < 6; ++i)
+        indices |= static_cast<std::uint64_t>(block[2 + i]) << (8u * static_cast<unsigned>(i));
+    for (int t = 0; t < 16; ++t)
+        values[t] = palette[(indices >> (3u * static_cast<unsigned>(t))) & 7u];
+}
+
+const int eacModifiers[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12}, {-2, -5, -8, -13, 1, 4, 7, 12}, {-2, -4, -6, -13, 1, 3, 5, 12},
+    {-3, -6, -8, -12, 2, 5, 7, 11}, {-3, -7, -9, -11, 2, 6, 8, 10}, {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10},
+    {-2, -6, -8, -10, 1, 5, 7, 9}, {-2, -5, -8, -10, 1, 4, 7, 9}, {-2, -4, -8, -10, 1, 3, 7, 9}, {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9}, {-1, -2, -3, -10, 0, 1, 2, 9}, {-4, -6, -8, -9, 3, 5, 7, 8}, {-3, -5, -7, -9, 2, 4, 6, 8},
+};
+
+// R11 values are scaled back to 8 bits
+void decodeEac(const std::uint8_t* block, const bool elevenBit, int* values)
+{
+    const auto bits = readBigEndian(block);
+    const int base = static_cast<int>(bits >> 56u);
+    const int mul = static_cast<int>((bits >> 52u) & 15u);
+    const auto& modifiers = eacModifiers[(bits >> 48u) & 15u];
+    for (int x = 0; x < 4; ++x)
+        for (int y = 0; y < 4; ++y)
+        {
+            const auto modifier = modifiers[(bits >> (45u - 3u * static_cast<unsigned>(x * 4 + y))) & 7u];
+            values[y * 4 + x] = elevenBit ? (std::clamp(base * 8 + 4 + modifier * (mul ? mul * 8 : 1), 0, 2047) * 255 + 1023) / 2047
+                                          : std::clamp(base + modifier * mul, 0, 255);
+        }
+}
+
+void decodeEtc(const std::uint8_t* block, int (*rgb)[3])
+{
+    static const int modifiers[8][4] = {{2, 8, -2, -8}, {5, 17, -5, -17}, {9, 29, -9, -29}, {13, 42, -13, -42},
+                                        {18, 60, -18, -60}, {24, 80, -24, -80}, {33, 106, -33, -106}, {47, 183, -47, -183}};
+    const auto bits = readBigEndian(block);
+    const bool differential = (bits >> 33u) & 1u;
+    const bool flip = (bits >> 32u) & 1u;
+    int base[2][3];
+    for (int c = 0; c < 3; ++c)
+    {
+        const auto shift = 56u - 8u * static_cast<unsigned>(c);
+        if (differential)
+        {
+            const int q0 = static_cast<int>((bits >> (shift + 3u)) & 31u);
+            int delta = static_cast<int>((bits >> shift) & 7u);
+            delta = delta >= 4 ? delta - 8 : delta;
+            const int q1 = q0 + delta;
+            REQUIRE(q1 >= 0);
+            REQUIRE(q1 <= 31);
+            base[0][c] = (q0 << 3) | (q0 >> 2);
+            base[1][c] = (q1 << 3) | (q1 >> 2);
+        }
+        else
+        {
+            base[0][c] = static_cast<int>((bits >> (shift + 4u)) & 15u) * 17;
+            base[1][c] = static_cast<int>((bits >> shift) & 15u) * 17;
+        }
+    }
+    const int tables[2] = {static_cast<int>((bits >> 37u) & 7u), static_cast<int>((bits >> 34u) & 7u)};
+    for (int y = 0; y < 4; ++y)
+        for (int x = 0; x < 4; ++x)
+        {
+            const auto k = static_cast<unsigned>(x * 4 + y);
+            const auto index = static_cast<int>((((bits >> (16u + k)) & 1u) << 1u) | ((bits >> k) & 1u));
+            const auto s = flip ? y >= 2 : x >= 2;
+            for (int c = 0; c < 3; ++c)
+                rgb[y * 4 + x][c] = std::clamp(base[s][c] + modifiers[tables[s]][index], 0, 255);
+        }
+}
+
+void decodeBc7Mode6(const std::uint8_t* block, int (*rgba)[4])
+{
+    static const int weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    unsigned pos = 0;
+    const auto read = [&](const unsigned bits)
+    {
+        int value = 0;
+        for (unsigned i = 0; i < bits; ++i, ++pos)
+            value |= ((block[pos >> 3u] >> (pos & 7u)) & 1) << i;
+        return value;
+    };
+    REQUIRE(read(7) == 64);
+    int endpoint[2][4];
+    for (int c = 0; c < 4; ++c)
+    {
+        endpoint[0][c] = read(7) << 1;
+        endpoint[1][c] = read(7) << 1;
+    }
+    const int p0 = read(1);
+    const int p1 = read(1);
+    for (int c = 0; c < 4; ++c)
+    {
+        endpoint[0][c] |= p0;
+        endpoint[1][c] |= p1;
+    }
+    for (int t = 0; t < 16; ++t)
+    {
+        const auto w = weights[read(t ? 4 : 3)];
+        for (int c = 0; c < 4; ++c)
+            rgba[t][c] = ((64 - w) * endpoint[0][c] + w * endpoint[1][c] + 32) >> 6;
+    }
+}
+
+int maxError(const std::uint8_t* expected, const int* actual)
+{
+    int result = 0;
+    for (int t = 0; t < 16; ++t)
+        result = std::max(result, std::abs(expected[t] - actual[t]));
+    return result;
+}
+
+std::uint32_t rgba(const int r, const int g, const int b, const int a)
+{
+    return static_cast<std::uint32_t>(r) | (static_cast<std::uint32_t>(g) << 8u) | (static_cast<std::uint32_t>(b) << 16u) | (static_cast<std::uint32_t>(a) << 24u);
+}
+
+}
+
+TEST_CASE("BlockCompressor coverage")
+{
+    const std::uint8_t edge[16] = {0, 0, 0, 0, 0, 0, 40, 255, 0, 90, 255, 255, 130, 255, 255, 255};
+    const std::uint8_t ramp[16] = {0, 17, 34, 51, 68, 85, 102, 119, 136, 153, 170, 187, 204, 221, 238, 255};
+    const std::uint8_t uniform[16] = {77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77};
+    std::uint8_t block[8];
+    int values[16];
+
+    SECTION("bc4")
+    {
+        BlockCompressor::encodeBc4(uniform, block);
+        decodeBc4(block, values);
+        REQUIRE(maxError(uniform, values) == 0);
+
+        BlockCompressor::encodeBc4(edge, block);
+        decodeBc4(block, values);
+        REQUIRE(maxError(edge, values) <= 10);
+
+        BlockCompressor::encodeBc4(ramp, block);
+        decodeBc4(block, values);
+        REQUIRE(maxError(ramp, values) <= 19);
+    }
+    SECTION("eac r11")
+    {
+        BlockCompressor::encodeEacR11(uniform, block);
+        decodeEac(block, true, values);
+        REQUIRE(maxError(uniform, values) == 0);
+
+        BlockCompressor::encodeEacR11(edge, block);
+        decodeEac(block, true, values);
+        REQUIRE(maxError(edge, values) <= 40);
+
+        BlockCompressor::encodeEacR11(ramp, block);
+        decodeEac(block, true, values);
+        REQUIRE(maxError(ramp, values) <= 24);
+    }
+}
+
+TEST_CASE("BlockCompressor color")
+{
+    std::uint32_t texels[16];
+    for (int t = 0; t < 16; ++t)
+        texels[t] = rgba(255, 200, 0, t * 17); // glyph color with varying coverage
+
+    SECTION("bc7")
+    {
+        std::uint8_t block[16];
+        int decoded[16][4];
+        BlockCompressor::encodeBc7(texels, block);
+        decodeBc7Mode6(block, decoded);
+        for (int t = 0; t < 16; ++t)
+        {
+            REQUIRE(std::abs(decoded[t][0] - 255) <= 1);
+            REQUIRE(std::abs(decoded[t][1] - 200) <= 1);
+            REQUIRE(std::abs(decoded[t][2] - 0) <= 1);
+            REQUIRE(std::abs(decoded[t][3] - t * 17) <= 6);
+        }
+    }
+    SECTION("etc2 with alpha")
+    {
+        std::uint8_t block[16];
+        std::uint8_t alpha[16];
+        int decodedAlpha[16];
+        int decoded[16][3];
+        for (int t = 0; t < 16; ++t)
+            alpha[t] = static_cast<std::uint8_t>(t * 17);
+        BlockCompressor::encodeEtc2(texels, true, block);
+        decodeEac(block, false, decodedAlpha);
+        REQUIRE(maxError(alpha, decodedAlpha) <= 24);
+        decodeEtc(block + 8, decoded);
+        for (int t = 0; t < 16; ++t)
+        {
+            REQUIRE(std::abs(decoded[t][0] - 255) <= 4);
+            REQUIRE(std::abs(decoded[t][1] - 200) <= 4);
+            REQUIRE(std::abs(decoded[t][2] - 0) <= 4);
+        }
+    }
+    SECTION("etc2 halves")
+    {
+        for (int t = 0; t < 16; ++t)
+            texels[t] = t / 4 < 2 ? rgba(0, 0, 128, 0) : rgba(255, 255, 255, 0); // background above foreground
+        std::uint8_t block[8];
+        int decoded[16][3];
+        BlockCompressor::encodeEtc2(texels, false, block);
+        decodeEtc(block, decoded);
+        for (int t = 0; t < 16; ++t)
+            for (int c = 0; c < 3; ++c)
+                REQUIRE(std::abs(decoded[t][c] - static_cast<int>((texels[t] >> (8u * static_cast<unsigned>(c))) & 0xFFu)) <= 8);
+    }
+}
+
+TEST_CASE("BlockCompressor pages")
+{
+    const std::vector<std::uint32_t> pixels(8 * 12, rgba(255, 255, 255, 255));
+    REQUIRE(BlockCompressor::compress(pixels.data(), 8, 12, Config::TextureCompression::Bc4, true).size() == 2 * 3 * 8);
+    REQUIRE(BlockCompressor::compress(pixels.data(), 8, 12, Config::TextureCompression::Bc7, true).size() == 2 * 3 * 16);
+    REQUIRE(BlockCompressor::compress(pixels.data(), 8, 12, Config::TextureCompression::Etc2, false).size() == 2 * 3 * 8);
+    REQUIRE_THROWS_AS(BlockCompressor::compress(pixels.data(), 12, 8 - 2, Config::TextureCompression::Eac, true), std::runtime_error);
+}
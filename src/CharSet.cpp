@@ -0,0 +1,134 @@
+#include "CharSet.h"
+#include <algorithm>
+
+CharSet::CharSet(std::initializer_list<std::uint32_t> codes)
+{
+    for (const auto code : codes)
+        insert(code);
+}
+
+void CharSet::insert(const std::uint32_t code)
+{
+    insert(code, code);
+}
+
+void CharSet::insert(std::uint32_t first, std::uint32_t last)
+{
+    if (first > last)
+        return;
+
+    // Fast path: appending in ascending order (cmap enumeration, sorted input).
+    if (ranges_.empty() || (ranges_.back().last != UINT32_MAX && ranges_.back().last + 1 < first))
+    {
+        ranges_.push_back({first, last});
+        return;
+    }
+
+    // First range which may touch [first, last] (its end is adjacent to or after first).
+    auto it = std::lower_bound(ranges_.begin(), ranges_.end(), first, [](const Range& r, std::uint32_t v)
+    {
+        return r.last != UINT32_MAX && r.last + 1 < v;
+    });
+
+    // Merge every range overlapping or adjacent to [first, last].
+    auto mergeEnd = it;
+    while (mergeEnd != ranges_.end() && (last == UINT32_MAX || mergeEnd->first <= last + 1))
+    {
+        first = std::min(first, mergeEnd->first);
+        last = std::max(last, mergeEnd->last);
+        ++mergeEnd;
+    }
+
+    if (it == mergeEnd)
+    {
+        ranges_.insert(it, {first, last});
+    }
+    else
+    {
+        *it = {first, last};
+        ranges_.erase(it + 1, mergeEnd);
+    }
+}
+
+void CharSet::insert(const CharSet& other)
+{
+    if (ranges_.empty())
+    {
+        ranges_ = other.ranges_;
+        return;
+    }
+
+    std::vector<Range> merged;
+    merged.reserve(ranges_.size() + other.ranges_.size());
+    std::merge(ranges_.begin(), ranges_.end(), other.ranges_.begin(), other.ranges_.end(), std::back_inserter(merged),
+               [](const Range& a, const Range& b) { return a.first < b.first; });
+
+    ranges_.clear();
+    for (const auto& r : merged)
+    {
+        if (!ranges_.empty() && (ranges_.back().last == UINT32_MAX || ranges_.back().last + 1 >= r.first))
+            ranges_.back().last = std::max(ranges_.back().last, r.last);
+        else
+            ranges_.push_back(r);
+    }
+}
+
+CharSet CharSet::intersection(const CharSet& other) const
+{
+    CharSet result;
+    auto a = ranges_.begin();
+    auto b = other.ranges_.begin();
+    while (a != ranges_.end() && b != other.ranges_.end())
+    {
+        const auto first = std::max(a->first, b->first);
+        const auto last = std::min(a->last, b->last);
+        if (first <= last)
+            result.ranges_.push_back({first, last});
+        if (a->last < b->last)
+            ++a;
+        else
+            ++b;
+    }
+    return result;
+}
+
+CharSet CharSet::difference(const CharSet& other) const
+{
+    CharSet result;
+    auto b = other.ranges_.begin();
+    for (const auto& r : ranges_)
+    {
+        std::uint64_t first = r.first;
+        while (b != other.ranges_.end() && b->last < first)
+            ++b;
+        for (auto cur = b; cur != other.ranges_.end() && cur->first <= r.last; ++cur)
+        {
+            if (cur->first > first)
+                result.ranges_.push_back({static_cast<std::uint32_t>(first), cur->first - 1});
+            first = static_cast<std::uint64_t>(cur->last) + 1;
+        }
+        if (first <= r.last)
+            result.ranges_.push_back({static_cast<std::uint32_t>(first), r.last});
+    }
+    return result;
+}
+
+bool CharSet::contains(const std::uint32_t code) const
+{
+    auto it = std::upper_bound(ranges_.begin(), ranges_.end(), code, [](std::uint32_t v, const Range& r)
+    {
+        return v < r.first;
+    });
+    if (it == ranges_.begin())
+        return false;
+    --it;
+    return code <= it->last;
+}
+
+std::size_t CharSet::size() const
+{
+    std::size_t result = 0;
+    for (const auto& r : ranges_)
+        result += static_cast<std::size_t>(r.last - r.first) + 1;
+    return result;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+// Set of utf32 code points stored as sorted, non-overlapping, non-adjacent ranges.
+// Large blocks (like 0-0x10FFFF) take a single range instead of one node per code point.
+class CharSet
+{
+public:
+    struct Range
+    {
+        std::uint32_t first;
+        std::uint32_t last; // inclusive
+
+        bool operator == (const Range& other) const
+        {
+            return first == other.first && last == other.last;
+        }
+    };
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::uint32_t*;
+        using reference = std::uint32_t;
+
+        const_iterator() = default;
+        const_iterator(std::vector<Range>::const_iterator range, std::vector<Range>::const_iterator rangeEnd)
+            : range(range), rangeEnd(rangeEnd), current(range == rangeEnd ? 0 : range->first) {}
+
+        std::uint32_t operator*() const
+        {
+            return current;
+        }
+
+        const_iterator& operator++()
+        {
+            if (current == range->last)
+            {
+                ++range;
+                current = range == rangeEnd ? 0 : range->first;
+            }
+            else
+                ++current;
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        bool operator == (const const_iterator& other) const
+        {
+            return range == other.range && current == other.current;
+        }
+
+        bool operator != (const const_iterator& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        std::vector<Range>::const_iterator range;
+        std::vector<Range>::const_iterator rangeEnd;
+        std::uint32_t current = 0;
+    };
+
+    CharSet() = default;
+    CharSet(std::initializer_list<std::uint32_t> codes);
+
+    void insert(std::uint32_t code);
+    void insert(std::uint32_t first, std::uint32_t last);
+    void insert(const CharSet& other);
+
+    CharSet intersection(const CharSet& other) const;
+    CharSet difference(const CharSet& other) const;
+
+    bool contains(std::uint32_t code) const;
+    bool empty() const
+    {
+        return ranges_.empty();
+    }
+    std::size_t size() const;
+    void clear()
+    {
+        ranges_.clear();
+    }
+
+    const std::vector<Range>& ranges() const
+    {
+        return ranges_;
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(ranges_.begin(), ranges_.end());
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(ranges_.end(), ranges_.end());
+    }
+
+    bool operator == (const CharSet& other) const
+    {
+        return ranges_ == other.ranges_;
+    }
+
+    bool operator != (const CharSet& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    std::vector<Range> ranges_;
+};
@@ -0,0 +1,88 @@
+#include "external/catch.hpp"
+#include "CharSet.h"
+
+namespace
+{
+    std::vector<std::uint32_t> toVector(const CharSet& s)
+    {
+        return std::vector<std::uint32_t>(s.begin(), s.end());
+    }
+}
+
+TEST_CASE("CharSet insert")
+{
+    CharSet s;
+    REQUIRE(s.empty());
+    REQUIRE(s.begin() == s.end());
+
+    s.insert(5);
+    s.insert(7);
+    REQUIRE(s.ranges().size() == 2);
+    s.insert(6);
+    REQUIRE(s.ranges().size() == 1);
+    REQUIRE(toVector(s) == std::vector<std::uint32_t>{5, 6, 7});
+
+    s.insert(1, 2);
+    s.insert(20, 30);
+    s.insert(3, 25);
+    REQUIRE(s.ranges().size() == 1);
+    REQUIRE(s.ranges().front().first == 1);
+    REQUIRE(s.ranges().front().last == 30);
+    REQUIRE(s.size() == 30);
+
+    s.insert(40, 30);
+    REQUIRE(s.size() == 30);
+
+    CharSet all;
+    all.insert(0, 0x10FFFF);
+    REQUIRE(all.ranges().size() == 1);
+    REQUIRE(all.size() == 0x110000);
+
+    CharSet max;
+    max.insert(UINT32_MAX);
+    max.insert(UINT32_MAX - 1);
+    REQUIRE(max.ranges().size() == 1);
+    REQUIRE(toVector(max) == std::vector<std::uint32_t>{UINT32_MAX - 1, UINT32_MAX});
+}
+
+TEST_CASE("CharSet contains")
+{
+    const CharSet s{1, 2, 3, 10, 12};
+    REQUIRE(!s.contains(0));
+    REQUIRE(s.contains(1));
+    REQUIRE(s.contains(3));
+    REQUIRE(!s.contains(4));
+    REQUIRE(s.contains(10));
+    REQUIRE(!s.contains(11));
+    REQUIRE(s.contains(12));
+    REQUIRE(!s.contains(13));
+}
+
+TEST_CASE("CharSet union, intersection, difference")
+{
+    CharSet a;
+    a.insert(0, 10);
+    a.insert(20, 30);
+    CharSet b;
+    b.insert(5, 22);
+    b.insert(40);
+
+    CharSet u = a;
+    u.insert(b);
+    REQUIRE(u.ranges().size() == 2);
+    REQUIRE(u.size() == 32);
+
+    const auto i = a.intersection(b);
+    REQUIRE(i.ranges().size() == 2);
+    REQUIRE(i.size() == 9);
+    REQUIRE(i.contains(5));
+    REQUIRE(i.contains(10));
+    REQUIRE(!i.contains(11));
+    REQUIRE(i.contains(22));
+
+    const auto d = a.difference(b);
+    REQUIRE(toVector(d) == std::vector<std::uint32_t>{0, 1, 2, 3, 4, 23, 24, 25, 26, 27, 28, 29, 30});
+    REQUIRE(b.difference(a) == CharSet{11, 12, 13, 14, 15, 16, 17, 18, 19, 40});
+    REQUIRE(a.difference(CharSet()) == a);
+    REQUIRE(CharSet().intersection(a).empty());
+}
@@ -1,10 +1,15 @@
 #pragma once
 
-#include <set>
+#include <algorithm>
 #include <cstdint>
+#include <map>
+#include <numeric>
+#include <sstream>
 #include <string>
 #include <stdexcept>
+#include <utility>
 #include <vector>
+#include "CharSet.h"
 
 struct Config
 {
@@ -23,6 +28,44 @@ struct Config
         Extended
     };
 
+    enum class TextureFormat {
+        Png,
+        Dds,
+        Ktx2,
+        Raw
+    };
+
+    enum class TextureChannels {
+        Rgba,
+        Alpha // coverage in a single 8 bit channel
+    };
+
+    enum class TextureSupercompression {
+        None,
+        Zstd
+    };
+
+    enum class TextureCompression {
+        None,
+        Bc4, // coverage only
+        Bc7,
+        Etc2, // ETC2 RGB, with EAC alpha when the background is transparent
+        Eac // EAC R11, coverage only
+    };
+
+    enum class MipmapFilter {
+        Box,
+        Kaiser
+    };
+
+    // Glyph groups packed on page sets of their own (--page-groups)
+    enum class PageGroups {
+        None,
+        Script, // see UnicodeBlocks
+        Block,
+        CharsFile // charGroups
+    };
+
     enum class TextureNameSuffix {
         IndexAligned,
         Index,
@@ -62,6 +105,45 @@ struct Config
         std::uint32_t left = 0;
     };
 
+    // Baked effects, each in its own channel of the RGBA pages (the glyph coverage stays in alpha, RGB no
+    // longer hold --color): outline in red, shadow in green, glow in blue.
+    struct Effects
+    {
+        std::uint32_t outline = 0; // stroke width in pixels, rendered with FT_Stroker
+        bool shadow = false;
+        int shadowOffsetX = 2;
+        int shadowOffsetY = 2;
+        std::uint32_t shadowBlur = 2; // blur radius in pixels
+        std::uint32_t glow = 0; // blur radius in pixels
+
+        bool enabled() const
+        {
+            return outline || shadow || glow;
+        }
+
+        // Room the effects need around the glyph, ProgramOptions adds it to the padding.
+        Padding getPadding() const
+        {
+            // Antialiasing and hinting may round the stroke out by a pixel
+            const int stroke = outline ? static_cast<int>(outline) + 1 : 0;
+            const int glowSize = glow ? stroke + static_cast<int>(glow) : 0;
+            const auto side = [&](const int shadowOffset)
+            {
+                auto size = std::max(stroke, glowSize);
+                if (shadow)
+                    size = std::max(size, stroke + static_cast<int>(shadowBlur) + shadowOffset);
+                return static_cast<std::uint32_t>(size);
+            };
+
+            Padding padding;
+            padding.up = side(-shadowOffsetY);
+            padding.right = side(shadowOffsetX);
+            padding.down = side(shadowOffsetY);
+            padding.left = side(-shadowOffsetX);
+            return padding;
+        }
+    };
+
     struct Spacing
     {
         std::uint32_t ver = 0;
@@ -74,9 +156,29 @@ struct Config
         std::uint32_t hor = 1;
     };
 
+    // Instance of a variable font (--font-instances): a named instance, axis values by tag, or both.
+    struct FontInstance
+    {
+        std::string name;
+        std::vector<std::pair<std::string, float>> axes;
+
+        // Output name suffix, like "SemiBold" or "wght650_wdth90"
+        std::string getLabel() const
+        {
+            std::stringstream ss;
+            for (const auto c : name)
+                if (c != ' ')
+                    ss << c;
+            for (const auto& axis : axes)
+                ss << (ss.tellp() > 0 ? "_" : "") << axis.first << axis.second;
+            return ss.str();
+        }
+    };
+
     std::string fontFile;
     std::string secondaryFontFile;
-    std::set<std::uint32_t> chars; // utf32
+    std::vector<std::string> fallbackFontFiles; // tried in order after secondaryFontFile
+    CharSet chars; // utf32
     Color color;
     Color backgroundColor;
     bool backgroundTransparent = true;
@@ -88,6 +190,8 @@ struct Config
     std::string output;
     DataFormat dataFormat = DataFormat::Text;
     KerningPairs kerningPairs = KerningPairs::Disabled;
+    bool useKerningCorpus = false; // kerning pairs only for kerningCorpusPairs
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> kerningCorpusPairs; // sorted char pairs of --kerning-corpus-file
     std::uint32_t maxTextureCount = 0;
     bool useMaxTextureCount = false;
     bool monochrome = false;
@@ -100,5 +204,71 @@ struct Config
     bool verbose = false;
     bool slashedZero = false;
     bool tabularNumbers = false;
+    bool stats = false;
+    std::string statsJsonFile;
+    bool serve = false;
+    bool incremental = false;
+    std::string convertFile;
     TextureNameSuffix textureNameSuffix = TextureNameSuffix::IndexAligned;
+    TextureFormat textureFormat = TextureFormat::Png;
+    TextureCompression textureCompression = TextureCompression::None;
+    TextureChannels textureChannels = TextureChannels::Rgba;
+    TextureSupercompression textureSupercompression = TextureSupercompression::None;
+    std::uint32_t mipmapLevels = 0; // downsampled levels stored after each page
+    MipmapFilter mipmapFilter = MipmapFilter::Box;
+    bool mipmapLayout = false; // glyph cells aligned to 2^mipmapLevels texels
+    bool textureArray = false; // pages of one size saved as the layers of a single texture
+    std::uint32_t subpixelPhases = 1; // horizontal subpixel variants rendered per glyph
+    bool allFaces = false; // every face of a font collection, output names get a _<face index> suffix
+    std::vector<FontInstance> fontInstances; // variable font instances, generated from one loaded face
+    Effects effects;
+    bool colorGlyphs = false; // color glyphs rendered in RGBA on pages of their own
+    std::map<std::uint32_t, std::uint64_t> charFrequencies; // glyphs are placed by descending char frequency when not empty
+    std::vector<std::u32string> strings; // lines of --strings-file, shaped into pre-positioned glyph runs
+    PageGroups pageGroups = PageGroups::None;
+    std::uint32_t renderStripHeight = 0; // pages are rendered and saved this many rows at a time, 0 renders whole pages
+    std::vector<std::pair<std::string, CharSet>> charGroups; // chars of each --chars-file, named after the file without extension
+
+    // Texture sizes are kept multiples of it (block compressed formats are made of 4x4 texel blocks,
+    // the mipmap layout keeps the glyph cell grid in every level).
+    std::uint32_t getTextureSizeMultiple() const
+    {
+        const std::uint32_t block = textureCompression == TextureCompression::None ? 1 : 4;
+        return std::lcm(block, getMipmapCellSize());
+    }
+
+    // Glyph cells of the mipmap layout are multiples of it, so no texel of the smallest level covers two glyphs.
+    std::uint32_t getMipmapCellSize() const
+    {
+        return mipmapLayout ? 1u << mipmapLevels : 1u;
+    }
+
+    // Page texels a texel of the smallest level depends on past its own footprint: the 8 Kaiser taps read
+    // 3 texels past the 2x2 footprint at every level, box stays inside it.
+    std::uint32_t getMipmapFilterReach() const
+    {
+        return mipmapFilter == MipmapFilter::Kaiser ? 3 * ((1u << mipmapLevels) - 1) : 0;
+    }
+
+    // Empty texels of a mipmap layout cell before its glyph (filter reach) and in total (the reach again
+    // after the glyph, at least one texel of the smallest level), so no level filters one glyph into another cell.
+    std::uint32_t getMipmapMargin() const
+    {
+        return mipmapLayout ? getMipmapFilterReach() : 0;
+    }
+
+    std::uint32_t getMipmapGutter() const
+    {
+        return mipmapLayout ? getMipmapMargin() + std::max(getMipmapCellSize(), getMipmapFilterReach()) : 0;
+    }
+
+    // Empty texels left of and above the packed glyph cells: the spacing, rounded up to the mipmap cell grid.
+    Spacing getPackingOffset() const
+    {
+        const auto cellSize = getMipmapCellSize();
+        Spacing result;
+        result.hor = (spacing.hor + cellSize - 1) / cellSize * cellSize;
+        result.ver = (spacing.ver + cellSize - 1) / cellSize * cellSize;
+        return result;
+    }
 };
@@ -0,0 +1,129 @@
+#include "Corpus.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+void Corpus::addFile(const std::string& fileName)
+{
+    std::ifstream fs(fileName, std::ifstream::binary);
+    if (!fs)
+        throw std::runtime_error("can't open corpus file " + fileName);
+
+    std::vector<char> block(1 << 16);
+    while (fs)
+    {
+        fs.read(block.data(), static_cast<std::streamsize>(block.size()));
+        add(std::string_view(block.data(), static_cast<std::size_t>(fs.gcount())));
+    }
+    // A file does not continue the next one
+    breakPair();
+    pendingBytes = 0;
+}
+
+void Corpus::add(const std::string_view text)
+{
+    for (const auto c : text)
+    {
+        const auto b = static_cast<std::uint8_t>(c);
+        if (pendingBytes)
+        {
+            if ((b & 0xC0u) == 0x80u)
+            {
+                code = code << 6u | (b & 0x3Fu);
+                if (--pendingBytes == 0)
+                    addCode(code);
+                continue;
+            }
+            // Truncated sequence, b starts the next one
+            pendingBytes = 0;
+            breakPair();
+        }
+
+        if (b < 0x80u)
+            addCode(b);
+        else if ((b & 0xE0u) == 0xC0u)
+        {
+            code = b & 0x1Fu;
+            pendingBytes = 1;
+        }
+        else if ((b & 0xF0u) == 0xE0u)
+        {
+            code = b & 0x0Fu;
+            pendingBytes = 2;
+        }
+        else if ((b & 0xF8u) == 0xF0u)
+        {
+            code = b & 0x07u;
+            pendingBytes = 3;
+        }
+        else
+            breakPair();
+    }
+}
+
+void Corpus::addCode(const std::uint32_t utf32)
+{
+    if (utf32 == U'\n' || utf32 == U'\r' || utf32 > 0x10FFFFu)
+    {
+        breakPair();
+        return;
+    }
+    if (utf32 < asciiCount)
+        ++asciiCounts[utf32];
+    else
+        ++counts[utf32];
+    if (hasPrevious)
+    {
+        if (previous < asciiCount && utf32 < asciiCount)
+            ++asciiPairs[previous * asciiCount + utf32];
+        else
+            ++pairs[static_cast<std::uint64_t>(previous) << 32u | utf32];
+    }
+    previous = utf32;
+    hasPrevious = true;
+}
+
+void Corpus::breakPair()
+{
+    hasPrevious = false;
+}
+
+std::uint64_t Corpus::getCount(const std::uint32_t utf32) const
+{
+    if (utf32 < asciiCount)
+        return asciiCounts[utf32];
+    const auto it = counts.find(utf32);
+    return it == counts.end() ? 0 : it->second;
+}
+
+std::uint64_t Corpus::getPairCount(const std::uint32_t first, const std::uint32_t second) const
+{
+    if (first < asciiCount && second < asciiCount)
+        return asciiPairs[first * asciiCount + second];
+    const auto it = pairs.find(static_cast<std::uint64_t>(first) << 32u | second);
+    return it == pairs.end() ? 0 : it->second;
+}
+
+std::vector<std::pair<std::uint32_t, std::uint64_t>> Corpus::getCounts() const
+{
+    std::vector<std::pair<std::uint32_t, std::uint64_t>> result;
+    for (std::uint32_t i = 0; i < asciiCount; ++i)
+        if (asciiCounts[i])
+            result.emplace_back(i, asciiCounts[i]);
+    result.insert(result.end(), counts.begin(), counts.end());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<Corpus::Pair> Corpus::getPairs(const std::uint64_t minCount) const
+{
+    std::vector<Pair> result;
+    for (std::uint32_t i = 0; i < asciiPairs.size(); ++i)
+        if (asciiPairs[i] && asciiPairs[i] >= minCount)
+            result.emplace_back(i / asciiCount, i % asciiCount);
+    for (const auto& kv : pairs)
+        if (kv.second >= minCount)
+            result.emplace_back(static_cast<std::uint32_t>(kv.first >> 32u), static_cast<std::uint32_t>(kv.first));
+    std::sort(result.begin(), result.end());
+    return result;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Code point and adjacent code point pair counts of UTF-8 text (--kerning-corpus-file, --frequency-corpus-file),
+// counted in one streaming pass. Line breaks are not counted and pairs do not span them; invalid UTF-8 bytes
+// are skipped and break pairs as well.
+class Corpus
+{
+public:
+    typedef std::pair<std::uint32_t, std::uint32_t> Pair;
+
+    // Read in blocks, memory does not grow with the file size (only with the distinct pairs).
+    void addFile(const std::string& fileName);
+    // Text may end inside a UTF-8 sequence, it is continued by the next call.
+    void add(std::string_view text);
+
+    std::uint64_t getCount(std::uint32_t utf32) const;
+    std::uint64_t getPairCount(std::uint32_t first, std::uint32_t second) const;
+
+    // Code points with their counts, ordered by code point.
+    std::vector<std::pair<std::uint32_t, std::uint64_t>> getCounts() const;
+
+    // Pairs seen at least minCount times, ordered by first then second code point.
+    std::vector<Pair> getPairs(std::uint64_t minCount = 1) const;
+
+private:
+    void addCode(std::uint32_t utf32);
+    void breakPair();
+
+    static constexpr std::uint32_t asciiCount = 128;
+
+    std::vector<std::uint64_t> asciiCounts = std::vector<std::uint64_t>(asciiCount);
+    std::unordered_map<std::uint32_t, std::uint64_t> counts; // non ascii codes
+    std::vector<std::uint64_t> asciiPairs = std::vector<std::uint64_t>(asciiCount * asciiCount);
+    std::unordered_map<std::uint64_t, std::uint64_t> pairs; // first << 32 | second, pairs with a non ascii code
+    std::uint32_t previous = 0;
+    bool hasPrevious = false;
+
+    // UTF-8 sequence being decoded
+    std::uint32_t code = 0;
+    std::uint32_t pendingBytes = 0;
+};
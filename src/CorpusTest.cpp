@@ -0,0 +1,51 @@
+#include "external/catch.hpp"
+#include "Corpus.h"
+
+TEST_CASE("Corpus pairs")
+{
+    Corpus corpus;
+    corpus.add("AVAV\nVA");
+    REQUIRE(corpus.getPairCount('A', 'V') == 2);
+    REQUIRE(corpus.getPairCount('V', 'A') == 2);
+    REQUIRE(corpus.getPairCount('V', '\n') == 0);
+    REQUIRE(corpus.getPairCount('\n', 'V') == 0);
+    REQUIRE((corpus.getPairs() == std::vector<Corpus::Pair>{{'A', 'V'}, {'V', 'A'}}));
+    REQUIRE(corpus.getPairs(3).empty());
+
+    // Continues the text: "AA", "Aя" split inside the two byte sequence of я (U+044F), "яя" and "я€" (U+20AC)
+    corpus.add("A\xD1");
+    corpus.add("\x8F\xD1\x8F\xE2\x82\xAC");
+    REQUIRE(corpus.getPairCount('A', 'A') == 1);
+    REQUIRE(corpus.getPairCount('A', 0x44F) == 1);
+    REQUIRE(corpus.getPairCount(0x44F, 0x44F) == 1);
+    REQUIRE(corpus.getPairCount(0x44F, 0x20AC) == 1);
+    REQUIRE((corpus.getPairs() == std::vector<Corpus::Pair>{{'A', 'A'}, {'A', 'V'}, {'A', 0x44F}, {'V', 'A'}, {0x44F, 0x44F}, {0x44F, 0x20AC}}));
+    REQUIRE((corpus.getPairs(2) == std::vector<Corpus::Pair>{{'A', 'V'}, {'V', 'A'}}));
+}
+
+TEST_CASE("Corpus counts")
+{
+    Corpus corpus;
+    corpus.add("abca\r\n\xE2\x82\xAC\xE2\x82\xAC");
+    REQUIRE(corpus.getCount('a') == 2);
+    REQUIRE(corpus.getCount('d') == 0);
+    REQUIRE(corpus.getCount(0x20AC) == 2);
+    REQUIRE((corpus.getCounts() == std::vector<std::pair<std::uint32_t, std::uint64_t>>{{'a', 2}, {'b', 1}, {'c', 1}, {0x20AC, 2}}));
+}
+
+TEST_CASE("Corpus invalid UTF-8")
+{
+    Corpus corpus;
+    // A stray continuation byte and a truncated sequence break the pairs around them
+    corpus.add("A\x80V\xD1" "AT\r\nTo");
+    REQUIRE(corpus.getPairCount('A', 'V') == 0);
+    REQUIRE(corpus.getPairCount('V', 'A') == 0);
+    REQUIRE(corpus.getPairCount('A', 'T') == 1);
+    REQUIRE(corpus.getPairCount('T', 'T') == 0);
+    REQUIRE(corpus.getPairCount('T', 'o') == 1);
+    REQUIRE(corpus.getPairs().size() == 2);
+    REQUIRE(corpus.getCount('T') == 2);
+    REQUIRE(corpus.getCount('\n') == 0);
+
+    REQUIRE_THROWS_AS(corpus.addFile("file/that/does/not/exist.txt"), std::runtime_error);
+}
@@ -0,0 +1,279 @@
+#include "DynamicAtlas.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include "TextureFile.h"
+#include "utils/extractFileName.h"
+
+DynamicAtlas::DynamicAtlas(const Config& config, const FontChain& fonts)
+    : config(config), fonts(fonts)
+{
+    if (config.textureSizeList.empty())
+        throw std::runtime_error("texture size required");
+    pageSize = config.textureSizeList.back();
+}
+
+void DynamicAtlas::restore(const FontInfo& previous, const CharSet& requested, Stats& stats)
+{
+    if (!pages.empty() || !glyphs.empty())
+        throw std::logic_error("atlas is not empty");
+    if (!previous.common.scaleW || !previous.common.scaleH)
+        throw std::runtime_error("previous pages have different sizes, incremental update is not possible");
+
+    pageSize = Config::Size(previous.common.scaleW, previous.common.scaleH);
+    for (std::size_t i = 0; i < previous.pages.size(); ++i)
+        addPage();
+
+    std::map<std::uint32_t, const FontInfo::Char*> previousChars;
+    CharSet kept;
+    for (const auto& c : previous.chars)
+    {
+        previousChars[c.id] = &c;
+        if (requested.contains(c.id))
+            kept.insert(c.id);
+    }
+
+    const auto found = fonts.filterChars(kept);
+    auto keptGlyphs = App::collectGlyphInfo(fonts, found, config.tabularNumbers, config.slashedZero, stats);
+
+    const auto phase = stats.phase("restore glyphs");
+    for (auto& kv : keptGlyphs)
+    {
+        auto& glyph = kv.second;
+        const auto& c = *previousChars.at(glyph.utf32);
+        if (glyph.isEmpty())
+            continue;
+        if (c.width != glyph.width + config.padding.left + config.padding.right || c.height != glyph.height + config.padding.up + config.padding.down
+            || static_cast<std::size_t>(c.page) >= pages.size())
+            throw std::runtime_error("char " + std::to_string(c.id) + " of the previous descriptor does not match the current options, run without --incremental");
+        glyph.x = c.x;
+        glyph.y = c.y;
+        glyph.page = static_cast<std::uint32_t>(c.page);
+    }
+
+    const auto additionalWidth = config.spacing.hor + config.padding.left + config.padding.right;
+    const auto additionalHeight = config.spacing.ver + config.padding.up + config.padding.down;
+    for (const auto& rect : App::getGlyphRectangles(keptGlyphs, additionalWidth, additionalHeight, config))
+    {
+        const auto& glyph = keptGlyphs[rect.tag];
+        // Packer coordinates start after the packing offset, the cell starts a mipmap margin before the glyph
+        rbp::Rect used;
+        used.x = static_cast<int>(static_cast<std::int64_t>(glyph.x) - config.getPackingOffset().hor - config.getMipmapMargin());
+        used.y = static_cast<int>(static_cast<std::int64_t>(glyph.y) - config.getPackingOffset().ver - config.getMipmapMargin());
+        used.width = rect.width;
+        used.height = rect.height;
+        used.tag = rect.tag;
+        // Other spacing, padding or mipmap options move the cells off the page or onto each other
+        if (!pages[glyph.page].packer.Reserve(used))
+            throw std::runtime_error("char " + std::to_string(glyph.utf32) + " of the previous descriptor is outside its page or overlaps another char"
+                                     " with the current options, run without --incremental");
+        render(rect.tag, glyph, stats);
+    }
+
+    glyphs = std::move(keptGlyphs);
+    chars = found;
+}
+
+DynamicAtlas::Update DynamicAtlas::add(const CharSet& requested, Stats& stats)
+{
+    Update update;
+    update.firstNewPage = static_cast<std::uint32_t>(pages.size());
+
+    const auto newChars = requested.difference(chars);
+    if (newChars.empty())
+        return update;
+
+    // Filtered here (and not by shapeGlyphs) so missing characters are reported to the client instead of stdout.
+    const auto found = fonts.filterChars(newChars);
+    update.missing = newChars.difference(found);
+
+    auto newGlyphs = App::collectGlyphInfo(fonts, found, config.tabularNumbers, config.slashedZero, stats);
+    for (auto it = newGlyphs.begin(); it != newGlyphs.end();)
+    {
+        if (glyphs.count(it->first))
+            it = newGlyphs.erase(it); // another character already uses this glyph
+        else
+            ++it;
+    }
+
+    {
+        const auto phase = stats.phase("arrange glyphs");
+        const auto additionalWidth = config.spacing.hor + config.padding.left + config.padding.right;
+        const auto additionalHeight = config.spacing.ver + config.padding.up + config.padding.down;
+        auto rects = App::getGlyphRectangles(newGlyphs, additionalWidth, additionalHeight, config);
+        // Larger glyphs first, the online insert packs better that way
+        std::sort(rects.begin(), rects.end(), [](const rbp::RectSize& a, const rbp::RectSize& b)
+                  { return a.height != b.height ? a.height > b.height : a.width > b.width; });
+        for (const auto& rect : rects)
+            place(rect.tag, newGlyphs[rect.tag], rect);
+    }
+
+    {
+        const auto phase = stats.phase("render textures");
+        for (const auto& kv : newGlyphs)
+            if (!kv.second.isEmpty())
+                update.dirtyRects.push_back(render(kv.first, kv.second, stats));
+    }
+
+    for (const auto& kv : newGlyphs)
+        update.chars.push_back(App::getCharInfo(kv.second, config));
+    std::sort(update.chars.begin(), update.chars.end(), [](const FontInfo::Char& a, const FontInfo::Char& b)
+              { return a.id < b.id; });
+
+    if (config.kerningPairs != Config::KerningPairs::Disabled)
+    {
+        const auto phase = stats.phase("kerning pairs");
+        auto kerningMode = ft::Font::KerningMode::Basic;
+        if (config.kerningPairs == Config::KerningPairs::Regular)
+            kerningMode = ft::Font::KerningMode::Regular;
+        if (config.kerningPairs == Config::KerningPairs::Extended)
+            kerningMode = ft::Font::KerningMode::Extended;
+
+        const auto addKerning = [&](const GlyphInfo& left, const GlyphInfo& right)
+        {
+            // No kerning pairs if a fallback font is involved
+            if (left.font || right.font)
+                return;
+            const auto k = static_cast<std::int16_t>(fonts.primary().getKerning(left.utf32, right.utf32, kerningMode));
+            if (k)
+            {
+                FontInfo::Kerning kerning;
+                kerning.first = left.utf32;
+                kerning.second = right.utf32;
+                kerning.amount = k;
+                update.kernings.push_back(kerning);
+            }
+        };
+
+        for (const auto& ch0 : newGlyphs)
+        {
+            for (const auto& ch1 : glyphs)
+            {
+                addKerning(ch0.second, ch1.second);
+                addKerning(ch1.second, ch0.second);
+            }
+            for (const auto& ch1 : newGlyphs)
+                addKerning(ch0.second, ch1.second);
+        }
+    }
+
+    glyphs.insert(newGlyphs.begin(), newGlyphs.end());
+    chars.insert(found);
+    return update;
+}
+
+void DynamicAtlas::addPage()
+{
+    Page page;
+    page.size = pageSize;
+    page.pixels.assign(static_cast<std::size_t>(pageSize.w) * pageSize.h, config.color.getBGR());
+    if (!config.backgroundTransparent)
+        App::blendBackground(page.pixels.data(), page.pixels.data() + page.pixels.size(), config);
+    page.packer.Init(pageSize.w - config.getPackingOffset().hor, pageSize.h - config.getPackingOffset().ver);
+    pages.push_back(std::move(page));
+}
+
+void DynamicAtlas::place(const std::uint32_t glyphKey, GlyphInfo& glyph, const rbp::RectSize& rect)
+{
+    for (std::uint32_t i = 0; ; ++i)
+    {
+        if (i == pages.size())
+        {
+            if (config.useMaxTextureCount && pages.size() >= config.maxTextureCount)
+                throw std::runtime_error("too many generated textures (more than --max-texture-count)");
+            const auto offset = config.getPackingOffset();
+            if (static_cast<std::uint32_t>(rect.width) > pageSize.w - offset.hor || static_cast<std::uint32_t>(rect.height) > pageSize.h - offset.ver)
+                throw std::runtime_error("can not fit glyph " + std::to_string(App::getGlyphIndex(glyphKey)) + " into texture");
+            addPage();
+        }
+
+        const auto r = pages[i].packer.Insert(rect.width, rect.height, rbp::MaxRectsBinPack::RectBestAreaFit);
+        if (r.height)
+        {
+            glyph.x = r.x + config.getPackingOffset().hor + config.getMipmapMargin();
+            glyph.y = r.y + config.getPackingOffset().ver + config.getMipmapMargin();
+            glyph.page = i;
+            return;
+        }
+    }
+}
+
+DynamicAtlas::DirtyRect DynamicAtlas::render(const std::uint32_t glyphKey, const GlyphInfo& glyph, Stats& stats)
+{
+    auto& page = pages[glyph.page];
+    const auto x = glyph.x + config.padding.left;
+    const auto y = glyph.y + config.padding.up;
+    fonts[glyph.font].renderGlyph(page.pixels.data(), page.size.w, page.size.h, x, y, App::getGlyphIndex(glyphKey), config.color.getBGR());
+    stats.addCounter("rasterized glyphs", 1);
+
+    DirtyRect rect;
+    rect.page = glyph.page;
+    rect.x = glyph.x;
+    rect.y = glyph.y;
+    rect.w = glyph.width + config.padding.left + config.padding.right;
+    rect.h = glyph.height + config.padding.up + config.padding.down;
+    if (!config.backgroundTransparent)
+        for (std::uint32_t row = rect.y; row < rect.y + rect.h; ++row)
+        {
+            const auto begin = page.pixels.data() + row * page.size.w + rect.x;
+            App::blendBackground(begin, begin + rect.w, config);
+        }
+    return rect;
+}
+
+std::vector<std::string> DynamicAtlas::getPageFileNames() const
+{
+    std::vector<std::string> fileNames;
+    for (std::uint32_t page = 0; page < pages.size(); ++page)
+        fileNames.push_back(App::getPageFileName(config, page, pages.size()));
+    return fileNames;
+}
+
+FontInfo DynamicAtlas::getFontInfo(Stats& stats) const
+{
+    std::vector<Config::Size> sizes;
+    for (const auto& page : pages)
+        sizes.push_back(page.size);
+
+    auto fileNames = getPageFileNames();
+    for (auto& fileName : fileNames)
+        fileName = extractFileName(fileName);
+
+    return App::buildFontInfo(glyphs, config, fonts.primary(), fileNames, sizes, stats);
+}
+
+void DynamicAtlas::save(Stats& stats) const
+{
+    if (config.output.empty())
+        throw std::runtime_error("--output required to save");
+
+    const auto fileNames = getPageFileNames();
+    if (config.textureArray && !pages.empty())
+    {
+        std::vector<const std::uint32_t*> layers;
+        for (const auto& page : pages)
+        {
+            if (page.size.w != pages.front().size.w || page.size.h != pages.front().size.h)
+                throw std::runtime_error("texture array layers have different sizes");
+            layers.push_back(page.pixels.data());
+        }
+        {
+            const auto phase = stats.phase("encode texture");
+            TextureFile::saveArray(fileNames.front(), layers, pages.front().size.w, pages.front().size.h, config.backgroundTransparent, config);
+        }
+        stats.addFile(fileNames.front());
+        App::writeFontInfoFile(getFontInfo(stats), config, stats);
+        return;
+    }
+
+    for (size_t i = 0; i < pages.size(); ++i)
+    {
+        {
+            const auto phase = stats.phase(config.textureFormat == Config::TextureFormat::Png ? "encode png" : "encode texture");
+            TextureFile::save(fileNames[i], pages[i].pixels.data(), pages[i].size.w, pages[i].size.h, config.backgroundTransparent, config);
+        }
+        stats.addFile(fileNames[i]);
+    }
+
+    App::writeFontInfoFile(getFontInfo(stats), config, stats);
+}
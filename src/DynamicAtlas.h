@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "App.h"
+#include "CharSet.h"
+#include "Config.h"
+#include "FontChain.h"
+#include "FontInfo.h"
+#include "Stats.h"
+#include "external/maxRectsBinPack/MaxRectsBinPack.h"
+#include "freeType/FtFont.h"
+
+// Atlas growing on demand (--serve): only glyphs that are not in it yet are rasterized, each one is placed with the
+// online MaxRects insert. Pages keep their pixels and packer between requests, existing glyphs never move.
+// Pages have the size of the last --texture-size entry (cropping is not supported).
+// Also used by --incremental to keep the glyph positions of a previous run.
+class DynamicAtlas
+{
+public:
+    struct Page
+    {
+        Config::Size size;
+        std::vector<std::uint32_t> pixels;
+        rbp::MaxRectsBinPack packer;
+    };
+
+    // Page area changed by an update (the rectangle of a new char, padding included).
+    struct DirtyRect
+    {
+        std::uint32_t page = 0;
+        std::uint32_t x = 0;
+        std::uint32_t y = 0;
+        std::uint32_t w = 0;
+        std::uint32_t h = 0;
+    };
+
+    struct Update
+    {
+        std::uint32_t firstNewPage = 0; // pages [firstNewPage, getPages().size()) were created by the update
+        std::vector<FontInfo::Char> chars;
+        std::vector<FontInfo::Kerning> kernings; // pairs with at least one new char
+        std::vector<DirtyRect> dirtyRects;
+        CharSet missing; // requested characters absent from the fonts
+    };
+
+    // The fonts must outlive the atlas.
+    DynamicAtlas(const Config& config, const FontChain& fonts);
+
+    // Puts the requested characters of a previous descriptor back at their old positions (--incremental),
+    // new pages then get the size of the previous ones. Must be called before add().
+    void restore(const FontInfo& previous, const CharSet& requested, Stats& stats);
+
+    // Adds the characters that are not in the atlas yet.
+    Update add(const CharSet& chars, Stats& stats);
+
+    const std::vector<Page>& getPages() const { return pages; }
+
+    // Descriptor of the whole atlas, page names are derived from Config::output.
+    FontInfo getFontInfo(Stats& stats) const;
+
+    // Writes the descriptor and the pages like a regular run.
+    void save(Stats& stats) const;
+
+private:
+    void addPage();
+    void place(std::uint32_t glyphKey, GlyphInfo& glyph, const rbp::RectSize& rect);
+    DirtyRect render(std::uint32_t glyphKey, const GlyphInfo& glyph, Stats& stats);
+    std::vector<std::string> getPageFileNames() const;
+
+    const Config& config;
+    const FontChain& fonts;
+    Config::Size pageSize;
+    App::Glyphs glyphs;
+    CharSet chars; // every character added so far
+    std::vector<Page> pages;
+};
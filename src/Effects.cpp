@@ -0,0 +1,144 @@
+#include "Effects.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// One pass of a separable filter over count lines of size texels, stride is the distance between
+// neighbor texels of a line, lineStride the distance between lines.
+template <typename Filter>
+void filterLines(const std::vector<std::uint8_t>& src, std::vector<std::uint8_t>& dst, const std::uint32_t size, const std::uint32_t count,
+                 const std::size_t stride, const std::size_t lineStride, Filter filter)
+{
+    std::vector<std::uint8_t> line(size);
+    for (std::uint32_t l = 0; l < count; ++l)
+    {
+        for (std::uint32_t i = 0; i < size; ++i)
+            line[i] = src[l * lineStride + i * stride];
+        for (std::uint32_t i = 0; i < size; ++i)
+            dst[l * lineStride + i * stride] = filter(line, i);
+    }
+}
+
+}
+
+std::vector<std::uint8_t> Effects::blur(const std::vector<std::uint8_t>& coverage, const std::uint32_t w, const std::uint32_t h, const std::uint32_t radius)
+{
+    if (!radius)
+        return coverage;
+
+    const auto sigma = radius / 2.0;
+    std::vector<float> weights(2 * radius + 1);
+    float total = 0.f;
+    for (std::size_t t = 0; t < weights.size(); ++t)
+    {
+        const auto x = static_cast<double>(t) - radius;
+        weights[t] = static_cast<float>(std::exp(-x * x / (2.0 * sigma * sigma)));
+        total += weights[t];
+    }
+    for (auto& weight : weights)
+        weight /= total;
+
+    const auto gaussian = [&](const std::vector<std::uint8_t>& line, const std::uint32_t i)
+    {
+        float sum = 0.f;
+        const auto size = static_cast<std::int64_t>(line.size());
+        for (std::size_t t = 0; t < weights.size(); ++t)
+        {
+            const auto j = static_cast<std::int64_t>(i) + static_cast<std::int64_t>(t) - radius;
+            if (j >= 0 && j < size)
+                sum += weights[t] * line[static_cast<std::size_t>(j)];
+        }
+        return static_cast<std::uint8_t>(std::min(std::lround(sum), 255L));
+    };
+
+    std::vector<std::uint8_t> rows(coverage.size());
+    filterLines(coverage, rows, w, h, 1, w, gaussian);
+    std::vector<std::uint8_t> result(coverage.size());
+    filterLines(rows, result, h, w, w, 1, gaussian);
+    return result;
+}
+
+std::vector<std::uint8_t> Effects::shift(const std::vector<std::uint8_t>& coverage, const std::uint32_t w, const std::uint32_t h, const int dx, const int dy)
+{
+    std::vector<std::uint8_t> result(coverage.size());
+    for (std::int64_t y = 0; y < h; ++y)
+    {
+        const auto srcY = y - dy;
+        if (srcY < 0 || srcY >= h)
+            continue;
+        for (std::int64_t x = 0; x < w; ++x)
+        {
+            const auto srcX = x - dx;
+            if (srcX >= 0 && srcX < w)
+                result[static_cast<std::size_t>(y * w + x)] = coverage[static_cast<std::size_t>(srcY * w + srcX)];
+        }
+    }
+    return result;
+}
+
+std::vector<std::uint8_t> Effects::dilate(const std::vector<std::uint8_t>& coverage, const std::uint32_t w, const std::uint32_t h, const std::uint32_t radius)
+{
+    const auto maximum = [&](const std::vector<std::uint8_t>& line, const std::uint32_t i)
+    {
+        const auto first = i > radius ? i - radius : 0;
+        const auto last = std::min<std::size_t>(static_cast<std::size_t>(i) + radius + 1, line.size());
+        return *std::max_element(line.begin() + first, line.begin() + static_cast<std::ptrdiff_t>(last));
+    };
+
+    std::vector<std::uint8_t> rows(coverage.size());
+    filterLines(coverage, rows, w, h, 1, w, maximum);
+    std::vector<std::uint8_t> result(coverage.size());
+    filterLines(rows, result, h, w, w, 1, maximum);
+    return result;
+}
+
+void Effects::render(std::uint32_t* surface, const std::uint32_t surfaceW, const std::uint32_t cellX, const std::uint32_t cellY, const std::uint32_t cellW,
+                     const std::uint32_t cellH, const ft::Font& font, const std::uint32_t glyphIndex, const int subpixelShift, const Config& config)
+{
+    const auto& effects = config.effects;
+    const auto texel = [&](const std::uint32_t x, const std::uint32_t y) -> std::uint32_t&
+    {
+        return surface[static_cast<std::size_t>(cellY + y) * surfaceW + cellX + x];
+    };
+
+    std::vector<std::uint8_t> glyph(static_cast<std::size_t>(cellW) * cellH);
+    for (std::uint32_t y = 0; y < cellH; ++y)
+        for (std::uint32_t x = 0; x < cellW; ++x)
+            glyph[y * cellW + x] = static_cast<std::uint8_t>(texel(x, y) >> 24u);
+
+    std::vector<std::uint8_t> outline(glyph.size());
+    if (effects.outline)
+    {
+        const auto stroke = font.renderStroke(glyphIndex, static_cast<int>(effects.outline) * 64, subpixelShift);
+        if (stroke.pixels.empty())
+            outline = dilate(glyph, cellW, cellH, effects.outline);
+        for (std::uint32_t row = 0; row < stroke.height; ++row)
+            for (std::uint32_t col = 0; col < stroke.width; ++col)
+            {
+                const auto x = static_cast<std::int64_t>(config.padding.left) + stroke.left + col;
+                const auto y = static_cast<std::int64_t>(config.padding.up) + stroke.top + row;
+                if (x >= 0 && x < cellW && y >= 0 && y < cellH)
+                    outline[static_cast<std::size_t>(y * cellW + x)] = stroke.pixels[static_cast<std::size_t>(row) * stroke.width + col];
+            }
+    }
+
+    // Shadow and glow surround the outlined glyph
+    auto body = glyph;
+    for (std::size_t i = 0; i < body.size(); ++i)
+        body[i] = std::max(body[i], outline[i]);
+
+    std::vector<std::uint8_t> shadow(glyph.size());
+    if (effects.shadow)
+        shadow = blur(shift(body, cellW, cellH, effects.shadowOffsetX, effects.shadowOffsetY), cellW, cellH, effects.shadowBlur);
+    std::vector<std::uint8_t> glow(glyph.size());
+    if (effects.glow)
+        glow = blur(body, cellW, cellH, effects.glow);
+
+    for (std::uint32_t y = 0; y < cellH; ++y)
+        for (std::uint32_t x = 0; x < cellW; ++x)
+        {
+            const auto i = y * cellW + x;
+            texel(x, y) = outline[i] | (shadow[i] << 8u) | (glow[i] << 16u) | (static_cast<std::uint32_t>(glyph[i]) << 24u);
+        }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Config.h"
+#include "freeType/FtLibrary.h"
+#include "freeType/FtFont.h"
+
+// Baked outline, shadow and glow (--outline, --shadow, --glow), see Config::Effects.
+class Effects
+{
+public:
+    // Fills the effect channels of the glyph cell at (cellX, cellY) of an RGBA8 surface, the glyph coverage is
+    // already in its alpha channel, drawn at (Config::padding.left, Config::padding.up) of the cell.
+    // Effects never leave the cell.
+    static void render(std::uint32_t* surface, std::uint32_t surfaceW, std::uint32_t cellX, std::uint32_t cellY, std::uint32_t cellW, std::uint32_t cellH,
+                       const ft::Font& font, std::uint32_t glyphIndex, int subpixelShift, const Config& config);
+
+    // Separable Gaussian (sigma = radius / 2) of a w * h coverage image, zero outside of it.
+    static std::vector<std::uint8_t> blur(const std::vector<std::uint8_t>& coverage, std::uint32_t w, std::uint32_t h, std::uint32_t radius);
+
+    // Coverage moved by (dx, dy), texels moved in from outside are zero.
+    static std::vector<std::uint8_t> shift(const std::vector<std::uint8_t>& coverage, std::uint32_t w, std::uint32_t h, int dx, int dy);
+
+    // Maximum over a (2 * radius + 1) square, stands in for the stroke of glyphs without an outline.
+    static std::vector<std::uint8_t> dilate(const std::vector<std::uint8_t>& coverage, std::uint32_t w, std::uint32_t h, std::uint32_t radius);
+};
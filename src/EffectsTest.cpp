@@ -0,0 +1,63 @@
+#include "external/catch.hpp"
+#include <cstdlib>
+#include "Effects.h"
+
+TEST_CASE("Effects")
+{
+    SECTION("blur keeps the total coverage inside the image")
+    {
+        std::vector<std::uint8_t> image(9 * 9, 0);
+        image[4 * 9 + 4] = 255;
+        const auto blurred = Effects::blur(image, 9, 9, 2);
+        int total = 0;
+        for (const auto texel : blurred)
+            total += texel;
+        REQUIRE(std::abs(total - 255) < 16);
+        REQUIRE(blurred[4 * 9 + 4] > blurred[4 * 9 + 5]);
+        REQUIRE(blurred[4 * 9 + 3] == blurred[4 * 9 + 5]);
+        REQUIRE(blurred[3 * 9 + 4] == blurred[5 * 9 + 4]);
+        REQUIRE(blurred[0] == 0);
+        REQUIRE(Effects::blur(image, 9, 9, 0) == image);
+    }
+
+    SECTION("shift moves texels in, zero from outside")
+    {
+        const std::vector<std::uint8_t> image = {1, 2, 3, 4, 5, 6};
+        REQUIRE(Effects::shift(image, 3, 2, 1, 0) == std::vector<std::uint8_t>{0, 1, 2, 0, 4, 5});
+        REQUIRE(Effects::shift(image, 3, 2, -1, 1) == std::vector<std::uint8_t>{0, 0, 0, 2, 3, 0});
+        REQUIRE(Effects::shift(image, 3, 2, 5, 0) == std::vector<std::uint8_t>(6, 0));
+    }
+
+    SECTION("dilate grows by radius")
+    {
+        std::vector<std::uint8_t> image(5 * 5, 0);
+        image[2 * 5 + 2] = 200;
+        const auto dilated = Effects::dilate(image, 5, 5, 1);
+        for (std::uint32_t y = 0; y < 5; ++y)
+            for (std::uint32_t x = 0; x < 5; ++x)
+                REQUIRE(dilated[y * 5 + x] == (x >= 1 && x <= 3 && y >= 1 && y <= 3 ? 200 : 0));
+    }
+}
+
+TEST_CASE("Config::Effects::getPadding")
+{
+    Config::Effects effects;
+    REQUIRE(!effects.enabled());
+
+    effects.outline = 2;
+    auto padding = effects.getPadding();
+    REQUIRE((padding.up == 3 && padding.right == 3 && padding.down == 3 && padding.left == 3));
+
+    effects.shadow = true;
+    effects.shadowOffsetX = 4;
+    effects.shadowOffsetY = -1;
+    effects.shadowBlur = 1;
+    padding = effects.getPadding();
+    REQUIRE(padding.right == 8);
+    REQUIRE(padding.left == 3);
+    REQUIRE(padding.up == 5);
+    REQUIRE(padding.down == 3);
+
+    effects.glow = 6;
+    REQUIRE(effects.getPadding().left == 9);
+}
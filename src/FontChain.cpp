@@ -0,0 +1,87 @@
+#include "FontChain.h"
+#include <algorithm>
+#include <stdexcept>
+
+FontChain FontChain::load(ft::Library& library, FontFileRegistry& files, const Config& config, const int faceIndex)
+{
+    std::vector<std::shared_ptr<const MappedFile>> loaded;
+    const auto isLoaded = [&](const std::shared_ptr<const MappedFile>& file)
+    {
+        return std::find(loaded.begin(), loaded.end(), file) != loaded.end();
+    };
+
+    FontChain chain;
+    const auto fontFile = files.get(config.fontFile);
+    loaded.push_back(fontFile);
+    chain.add(std::make_unique<ft::Font>(library, fontFile, config.fontSize, faceIndex, config.monochrome, config.lightHinting, config.noHinting));
+    chain.fonts.front()->setColorGlyphs(config.colorGlyphs);
+
+    std::vector<std::string> fallbackFiles = {config.secondaryFontFile};
+    fallbackFiles.insert(fallbackFiles.end(), config.fallbackFontFiles.begin(), config.fallbackFontFiles.end());
+    for (const auto& fileName : fallbackFiles)
+    {
+        auto file = files.get(fileName);
+        if (!file || isLoaded(file))
+            continue; // a font earlier in the chain already provides every glyph it has
+        loaded.push_back(file);
+        auto font = std::make_unique<ft::Font>(library, file, config.fontSize, 0, config.monochrome, config.lightHinting, config.noHinting);
+        font->setColorGlyphs(config.colorGlyphs);
+        chain.add(std::move(font));
+    }
+    return chain;
+}
+
+void FontChain::add(std::unique_ptr<ft::Font> font)
+{
+    if (!fonts.empty() && !font->valid)
+        return;
+    if (fonts.size() > 255)
+        throw std::runtime_error("too many fallback fonts");
+    fonts.push_back(std::move(font));
+}
+
+std::vector<FontChain::CoveredChar> FontChain::getCoverage(const CharSet& chars) const
+{
+    std::vector<CoveredChar> result;
+    auto remaining = chars;
+    for (std::uint32_t i = 0; i < fonts.size() && !remaining.empty(); ++i)
+    {
+        const auto& font = *fonts[i];
+        if (!font.valid)
+            continue;
+
+        CharSet found;
+        const auto cover = [&](const std::uint32_t utf32, const FT_UInt glyphIndex)
+        {
+            result.push_back({utf32, i, glyphIndex});
+            found.insert(utf32);
+        };
+        if (remaining.size() > static_cast<std::size_t>(font.face->num_glyphs))
+        {
+            FT_UInt glyphIndex = 0;
+            auto utf32 = FT_Get_First_Char(font.face, &glyphIndex);
+            while (glyphIndex)
+            {
+                if (remaining.contains(static_cast<std::uint32_t>(utf32)))
+                    cover(static_cast<std::uint32_t>(utf32), glyphIndex);
+                utf32 = FT_Get_Next_Char(font.face, utf32, &glyphIndex);
+            }
+        }
+        else
+        {
+            for (const auto utf32 : remaining)
+                if (const auto glyphIndex = FT_Get_Char_Index(font.face, utf32))
+                    cover(utf32, glyphIndex);
+        }
+        remaining = remaining.difference(found);
+    }
+    return result;
+}
+
+CharSet FontChain::filterChars(const CharSet& chars) const
+{
+    CharSet result;
+    for (const auto& c : getCoverage(chars))
+        result.insert(c.utf32);
+    return result;
+}
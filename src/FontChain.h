@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "CharSet.h"
+#include "Config.h"
+#include "FontFileRegistry.h"
+#include "freeType/FtLibrary.h"
+#include "freeType/FtFont.h"
+
+// Primary font followed by its fallback fonts (--secondary-font-file, --fallback-font-file), a char is
+// taken from the first font of the chain having it. GlyphInfo::font is an index in the chain.
+class FontChain
+{
+public:
+    struct CoveredChar
+    {
+        std::uint32_t utf32 = 0;
+        std::uint32_t font = 0;
+        std::uint32_t glyphIndex = 0;
+    };
+
+    // Config::fontFile (the given face of a collection), secondaryFontFile and fallbackFontFiles through
+    // the registry; a file already in the chain is not added again.
+    static FontChain load(ft::Library& library, FontFileRegistry& files, const Config& config, int faceIndex = 0);
+
+    // The first font is the primary one, empty (invalid) fallback fonts are skipped.
+    void add(std::unique_ptr<ft::Font> font);
+
+    std::size_t size() const
+    {
+        return fonts.size();
+    }
+
+    const ft::Font& operator[](std::size_t index) const
+    {
+        return *fonts[index];
+    }
+
+    ft::Font& primary()
+    {
+        return *fonts.front();
+    }
+
+    const ft::Font& primary() const
+    {
+        return *fonts.front();
+    }
+
+    // Font and glyph index of the chars covered by the chain, by font then code. Each font resolves only
+    // the chars the previous ones miss, from one walk over its cmap (or direct lookups when fewer chars
+    // than glyphs remain).
+    std::vector<CoveredChar> getCoverage(const CharSet& chars) const;
+
+    // Chars covered by the chain.
+    CharSet filterChars(const CharSet& chars) const;
+
+private:
+    std::vector<std::unique_ptr<ft::Font>> fonts;
+};
@@ -0,0 +1,31 @@
+#include "FontFileRegistry.h"
+#include <filesystem>
+#include <stdexcept>
+
+std::shared_ptr<const MappedFile> FontFileRegistry::get(const std::string& path)
+{
+    if (path.empty())
+        return nullptr;
+
+    std::error_code ec;
+    auto key = std::filesystem::canonical(path, ec).string();
+    if (ec)
+        key = path; // mapping below reports the error
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    auto& file = files[key];
+    if (!file)
+    {
+        auto mapped = std::make_shared<const MappedFile>(path);
+        if (!mapped->size())
+            throw std::runtime_error("empty font file " + path);
+        file = std::move(mapped);
+    }
+    return file;
+}
+
+void FontFileRegistry::clear()
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    files.clear();
+}
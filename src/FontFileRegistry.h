@@ -0,0 +1,23 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "utils/MappedFile.h"
+
+// Maps each font file once and shares the bytes between every ft::Font created from it
+// (primary and secondary fonts, faces of a collection, sizes and successive generation jobs).
+// Thread safe.
+class FontFileRegistry
+{
+public:
+    // Returns nullptr for an empty path, throws std::runtime_error if the file can't be mapped or is empty.
+    std::shared_ptr<const MappedFile> get(const std::string& path);
+
+    // Forgets the mappings, they are unmapped once the last font using them is destroyed.
+    void clear();
+
+private:
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<const MappedFile>> files; // by canonical path
+};
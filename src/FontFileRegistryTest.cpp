@@ -0,0 +1,40 @@
+#include "external/catch.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "FontFileRegistry.h"
+
+TEST_CASE("FontFileRegistry")
+{
+    const auto dir = std::filesystem::temp_directory_path();
+    const auto path = (dir / "fontbm_registry_test.bin").string();
+    const auto emptyPath = (dir / "fontbm_registry_test_empty.bin").string();
+    {
+        std::ofstream f(path, std::ios::binary);
+        f << "font data";
+        std::ofstream e(emptyPath, std::ios::binary);
+    }
+
+    FontFileRegistry registry;
+    REQUIRE(registry.get("") == nullptr);
+
+    const auto file = registry.get(path);
+    REQUIRE(file);
+    REQUIRE(file->size() == 9);
+    REQUIRE(std::memcmp(file->data(), "font data", 9) == 0);
+
+    // same file through another path is mapped only once
+    REQUIRE(registry.get(path) == file);
+    REQUIRE(registry.get((dir / "." / "fontbm_registry_test.bin").string()) == file);
+
+    // mapping outlives the registry entry
+    registry.clear();
+    REQUIRE(std::memcmp(file->data(), "font data", 9) == 0);
+    REQUIRE(registry.get(path) != file);
+
+    REQUIRE_THROWS_AS(registry.get(emptyPath), std::runtime_error);
+    REQUIRE_THROWS_AS(registry.get((dir / "fontbm_file_that_does_not_exist.ttf").string()), std::runtime_error);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(emptyPath);
+}
@@ -0,0 +1,125 @@
+#include "FontGenerator.h"
+#include <algorithm>
+#include <sstream>
+#include "App.h"
+#include "FontChain.h"
+#include "TextureFile.h"
+#include "utils/extractFileName.h"
+
+GeneratedFont FontGenerator::generate(const Config& config, const FontData font, const FontData secondaryFont)
+{
+    Stats stats;
+    return generate(config, font, secondaryFont, stats);
+}
+
+GeneratedFont FontGenerator::generate(const Config& config, const FontData fontData, const FontData secondaryFontData, Stats& stats)
+{
+    if (!fontData.data || !fontData.size)
+        throw std::runtime_error("font data required");
+    if (!config.fallbackFontFiles.empty())
+        throw std::runtime_error("fallback fonts are not supported with font data, load the fonts through a FontFileRegistry");
+
+    ft::Library library;
+    auto loadPhase = stats.phase("load fonts");
+    FontChain fonts;
+    for (const auto& data : {fontData, secondaryFontData})
+    {
+        auto font = std::make_unique<ft::Font>(library, data.data, data.size, config.fontSize, 0, config.monochrome, config.lightHinting, config.noHinting);
+        font->setColorGlyphs(config.colorGlyphs);
+        fonts.add(std::move(font));
+    }
+    loadPhase.stop();
+
+    return generate(config, fonts, stats);
+}
+
+GeneratedFont FontGenerator::generate(const Config& config, FontFileRegistry& fontFiles)
+{
+    Stats stats;
+    return generate(config, fontFiles, stats);
+}
+
+GeneratedFont FontGenerator::generate(const Config& config, FontFileRegistry& fontFiles, Stats& stats)
+{
+    auto loadPhase = stats.phase("load fonts");
+    if (config.fontFile.empty())
+        throw std::runtime_error("font file required");
+
+    ft::Library library;
+    const auto fonts = FontChain::load(library, fontFiles, config);
+    loadPhase.stop();
+
+    return generate(config, fonts, stats);
+}
+
+GeneratedFont FontGenerator::generate(const Config& config, const FontChain& fonts, Stats& stats)
+{
+    auto glyphs = App::collectGlyphInfo(fonts, config.allChars ? App::collectAllChars(fonts.primary()) : config.chars, config.tabularNumbers, config.slashedZero, stats);
+
+    // Pages are kept in memory instead of saved
+    GeneratedFont result;
+    const auto renderPages = [&](const App::Glyphs& placedGlyphs, const std::vector<Config::Size>& sizes)
+    {
+        std::vector<std::string> fileNames;
+        const auto colorPages = App::getColorPages(placedGlyphs);
+        for (std::uint32_t page = 0; page < sizes.size(); ++page)
+        {
+            const auto phase = stats.phase("render textures");
+            GeneratedFont::Page p;
+            p.w = sizes[page].w;
+            p.h = sizes[page].h;
+            p.pixels = App::renderPage(placedGlyphs, config, fonts, sizes[page], page, stats);
+            p.hasAlpha = config.backgroundTransparent;
+            p.color = std::binary_search(colorPages.begin(), colorPages.end(), page);
+            result.pages.push_back(std::move(p));
+            fileNames.push_back(extractFileName(App::getPageFileName(config, page, sizes.size())));
+        }
+        return fileNames;
+    };
+    result.fontInfo = App::generateFontInfo(config, glyphs, fonts, renderPages, stats);
+    return result;
+}
+
+std::vector<std::uint8_t> FontGenerator::encodePng(const GeneratedFont::Page& page)
+{
+    return TextureFile::encodePng(page.pixels.data(), page.w, page.h, page.hasAlpha);
+}
+
+std::vector<std::uint8_t> FontGenerator::encodeTexture(const GeneratedFont::Page& page, const Config& config)
+{
+    return TextureFile::encode(page.pixels.data(), page.w, page.h, page.hasAlpha, page.color ? App::getColorPageConfig(config) : config);
+}
+
+std::vector<std::uint8_t> FontGenerator::encodeTextureArray(const std::vector<GeneratedFont::Page>& pages, const Config& config)
+{
+    if (pages.empty())
+        return {};
+    std::vector<const std::uint32_t*> layers;
+    for (const auto& page : pages)
+        layers.push_back(page.pixels.data());
+    return TextureFile::encodeArray(layers, pages.front().w, pages.front().h, pages.front().hasAlpha, config);
+}
+
+std::string FontGenerator::encodeFontInfo(const FontInfo& fontInfo, const Config::DataFormat dataFormat)
+{
+    std::stringstream ss;
+    switch (dataFormat)
+    {
+    case Config::DataFormat::Xml:
+        fontInfo.writeToXml(ss);
+        break;
+    case Config::DataFormat::Text:
+        fontInfo.writeToText(ss);
+        break;
+    case Config::DataFormat::Bin:
+        fontInfo.writeToBin(ss);
+        break;
+    case Config::DataFormat::Json:
+        fontInfo.writeToJson(ss);
+        break;
+    case Config::DataFormat::Cbor:
+        fontInfo.writeToCbor(ss);
+        break;
+    }
+    return ss.str();
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Config.h"
+#include "FontFileRegistry.h"
+#include "FontInfo.h"
+#include "Stats.h"
+
+class FontChain;
+
+// Embeddable generation API (libfontbm): builds the font descriptor and texture pages in memory,
+// without writing files (the output files in Config are ignored).
+struct GeneratedFont
+{
+    struct Page
+    {
+        std::uint32_t w = 0;
+        std::uint32_t h = 0;
+        std::vector<std::uint32_t> pixels; // w * h RGBA8 pixels (R in the lowest byte), alpha is meaningful only when hasAlpha
+        bool hasAlpha = true;
+        bool color = false; // color glyphs (--color-glyphs), encodeTexture keeps RGBA texels
+    };
+
+    FontInfo fontInfo; // FontInfo::pages holds the names the pages would get when saved (derived from Config::output)
+    std::vector<Page> pages;
+};
+
+// Font file content held by the caller.
+struct FontData
+{
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+};
+
+class FontGenerator
+{
+public:
+    // Font data is not copied, it must stay valid during the call. An empty secondary font disables it.
+    // Config::fontFile and secondaryFontFile are not read; fallback fonts are not supported for data held
+    // by the caller, a non-empty Config::fallbackFontFiles is rejected.
+    static GeneratedFont generate(const Config& config, FontData font, FontData secondaryFont = FontData());
+    static GeneratedFont generate(const Config& config, FontData font, FontData secondaryFont, Stats& stats);
+
+    // Loads Config::fontFile, secondaryFontFile and fallbackFontFiles through the registry, so batch jobs share the mapped font files.
+    static GeneratedFont generate(const Config& config, FontFileRegistry& fontFiles);
+    static GeneratedFont generate(const Config& config, FontFileRegistry& fontFiles, Stats& stats);
+
+    // PNG file content of a generated page.
+    static std::vector<std::uint8_t> encodePng(const GeneratedFont::Page& page);
+
+    // Page file content in Config::textureFormat and textureCompression.
+    static std::vector<std::uint8_t> encodeTexture(const GeneratedFont::Page& page, const Config& config);
+    // All pages as the layers of one texture array (--texture-array).
+    static std::vector<std::uint8_t> encodeTextureArray(const std::vector<GeneratedFont::Page>& pages, const Config& config);
+
+    // Descriptor content in Config::dataFormat.
+    static std::string encodeFontInfo(const FontInfo& fontInfo, Config::DataFormat dataFormat);
+
+private:
+    static GeneratedFont generate(const Config& config, const FontChain& fonts, Stats& stats);
+};
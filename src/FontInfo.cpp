@@ -1,11 +1,17 @@
+#include <algorithm>
 #include <stdexcept>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <iomanip>
+#include <charconv>
+#include <type_traits>
 #include "FontInfo.h"
 #include "external/tinyxml2/tinyxml2.h"
-#include "external/json.hpp"
 #include "external/cbor/cbor_encoder_ostream.h"
+#include "external/json.hpp"
+#include "utils/MappedFile.h"
+#include "utils/JsonWriter.h"
 
 std::string FontInfo::getCharSetName(std::uint8_t charSet)
 {
@@ -79,6 +85,14 @@ std::string FontInfo::getCharSetName(std::uint8_t charSet)
 }
 
 void FontInfo::writeToXmlFile(const std::string &fileName) const
+{
+    std::ofstream f(fileName, std::ios::binary);
+    if (!f)
+        throw std::runtime_error("xml write to file error");
+    writeToXml(f);
+}
+
+void FontInfo::writeToXml(std::ostream &f) const
 {
     tinyxml2::XMLDocument doc;
     tinyxml2::XMLDeclaration* declaration = doc.NewDeclaration("xml version=\"1.0\"");
@@ -127,14 +141,31 @@ void FontInfo::writeToXmlFile(const std::string &fileName) const
     commonElement->SetAttribute("blueChnl", common.blueChnl);
     if (extraInfo) 
     {
-        commonElement->SetAttribute("base", common.descent);
+        commonElement->SetAttribute("descent", common.descent);
         commonElement->SetAttribute("totalHeight", common.totalHeight);
     }
+    if (hasPhases())
+        commonElement->SetAttribute("subpixelPhases", common.subpixelPhases);
     root->InsertEndChild(commonElement);
 
     tinyxml2::XMLElement* pagesElement = doc.NewElement("pages");
     root->InsertEndChild(pagesElement);
 
+    if (!groups.empty())
+    {
+        tinyxml2::XMLElement* groupsElement = doc.NewElement("groups");
+        groupsElement->SetAttribute("count", static_cast<int>(groups.size()));
+        root->InsertEndChild(groupsElement);
+        for (const auto& g: groups)
+        {
+            tinyxml2::XMLElement* groupElement = doc.NewElement("group");
+            groupElement->SetAttribute("name", g.name.c_str());
+            groupElement->SetAttribute("firstPage", g.firstPage);
+            groupElement->SetAttribute("pageCount", g.pageCount);
+            groupsElement->InsertEndChild(groupElement);
+        }
+    }
+
     tinyxml2::XMLElement* charsElement = doc.NewElement("chars");
     charsElement->SetAttribute("count", static_cast<int>(chars.size()));
     root->InsertEndChild(charsElement);
@@ -148,6 +179,8 @@ void FontInfo::writeToXmlFile(const std::string &fileName) const
         tinyxml2::XMLElement* pageElement = doc.NewElement("page");
         pageElement->SetAttribute("id", static_cast<unsigned int>(i));
         pageElement->SetAttribute("file", pages[i].c_str());
+        if (isColorPage(i))
+            pageElement->SetAttribute("color", 1);
         pagesElement->InsertEndChild(pageElement);
     }
 
@@ -164,6 +197,8 @@ void FontInfo::writeToXmlFile(const std::string &fileName) const
         charElement->SetAttribute("xadvance", c.xadvance);
         charElement->SetAttribute("page", c.page);
         charElement->SetAttribute("chnl", c.chnl);
+        if (hasPhases())
+            charElement->SetAttribute("phase", c.phase);
         charsElement->InsertEndChild(charElement);
     }
 
@@ -176,14 +211,45 @@ void FontInfo::writeToXmlFile(const std::string &fileName) const
         kerningsElement->InsertEndChild(kerningElement);
     }
 
-    tinyxml2::XMLError err = doc.SaveFile(fileName.c_str(), false);
-    if (err)
-        throw std::runtime_error("xml write to file error");
+    if (!runs.empty())
+    {
+        tinyxml2::XMLElement* runsElement = doc.NewElement("runs");
+        runsElement->SetAttribute("count", static_cast<int>(runs.size()));
+        root->InsertEndChild(runsElement);
+        for (const auto& r: runs)
+        {
+            tinyxml2::XMLElement* runElement = doc.NewElement("run");
+            runElement->SetAttribute("id", r.id);
+            runElement->SetAttribute("xadvance", r.xadvance);
+            for (const auto& g: r.glyphs)
+            {
+                tinyxml2::XMLElement* glyphElement = doc.NewElement("glyph");
+                glyphElement->SetAttribute("x", g.x);
+                glyphElement->SetAttribute("y", g.y);
+                glyphElement->SetAttribute("width", g.width);
+                glyphElement->SetAttribute("height", g.height);
+                glyphElement->SetAttribute("xoffset", g.xoffset);
+                glyphElement->SetAttribute("yoffset", g.yoffset);
+                glyphElement->SetAttribute("page", g.page);
+                runElement->InsertEndChild(glyphElement);
+            }
+            runsElement->InsertEndChild(runElement);
+        }
+    }
+
+    tinyxml2::XMLPrinter printer(nullptr, false);
+    doc.Print(&printer);
+    f.write(printer.CStr(), printer.CStrSize() - 1);
 }
 
 void FontInfo::writeToTextFile(const std::string &fileName) const
 {
     std::ofstream f(fileName);
+    writeToText(f);
+}
+
+void FontInfo::writeToText(std::ostream &f) const
+{
 
     f << "info"
         << " face=\"" << info.face << "\""
@@ -225,10 +291,19 @@ void FontInfo::writeToTextFile(const std::string &fileName) const
         f << " totalHeight=" << common.totalHeight;
         f << " descent=" << common.descent;
     }
+    if (hasPhases())
+        f << " subpixelPhases=" << static_cast<int>(common.subpixelPhases);
     f << std::endl;
 
     for (size_t i = 0; i < pages.size(); ++i)
-        f << "page id=" << i << " file=\"" << pages[i] << "\"" << std::endl;
+    {
+        f << "page id=" << i << " file=\"" << pages[i] << "\"";
+        if (isColorPage(i))
+            f << " color=1";
+        f << std::endl;
+    }
+    for (const auto& g: groups)
+        f << "group name=\"" << g.name << "\" firstPage=" << g.firstPage << " pageCount=" << g.pageCount << std::endl;
 
     f << "chars count=" << chars.size() << std::endl;
     f << std::left;
@@ -244,8 +319,10 @@ void FontInfo::writeToTextFile(const std::string &fileName) const
             << " yoffset=" << std::setw(5) << c.yoffset
             << " xadvance=" << std::setw(5) << c.xadvance
             << " page=" << std::setw(2) << static_cast<int>(c.page)
-            << " chnl=" << std::setw(2) << static_cast<int>(c.chnl)
-            << std::endl;
+            << " chnl=" << std::setw(2) << static_cast<int>(c.chnl);
+        if (hasPhases())
+            f << " phase=" << std::setw(2) << static_cast<int>(c.phase);
+        f << std::endl;
     }
     f << std::right;
     if (!kernings.empty())
@@ -260,18 +337,62 @@ void FontInfo::writeToTextFile(const std::string &fileName) const
               << std::endl;
         }
     }
+    if (!runs.empty())
+    {
+        f << "runs count=" << runs.size() << std::endl;
+        for (const auto& r: runs)
+        {
+            f << "run id=" << r.id << " xadvance=" << r.xadvance << " glyphs=" << r.glyphs.size() << std::endl;
+            for (const auto& g: r.glyphs)
+            {
+                f << "runglyph"
+                  << " x=" << g.x
+                  << " y=" << g.y
+                  << " width=" << g.width
+                  << " height=" << g.height
+                  << " xoffset=" << g.xoffset
+                  << " yoffset=" << g.yoffset
+                  << " page=" << static_cast<int>(g.page)
+                  << std::endl;
+            }
+        }
+    }
 }
 
-void FontInfo::writeToBinFile(const std::string &fileName) const
+bool FontInfo::isColorPage(const std::size_t page) const
+{
+    return std::binary_search(colorPages.begin(), colorPages.end(), static_cast<std::uint32_t>(page));
+}
+
+void FontInfo::checkBinCompatible() const
 {
     if (extraInfo)
         throw std::runtime_error("--extra-info flag is not compatible with binary format");
+    if (hasPhases())
+        throw std::runtime_error("--subpixel-phases is not compatible with binary format");
+    if (!colorPages.empty())
+        throw std::runtime_error("color pages (--color-glyphs) are not compatible with binary format");
+    if (!groups.empty())
+        throw std::runtime_error("page groups (--page-groups) are not compatible with binary format");
+    if (!runs.empty())
+        throw std::runtime_error("shaped strings (--strings-file) are not compatible with binary format");
 
     for (size_t i = 1; i < pages.size(); ++i)
         if (pages[0].length() != pages[i].length())
             throw std::runtime_error("texture names have different length (incompatible with bin format)");
+}
+
+void FontInfo::writeToBinFile(const std::string &fileName) const
+{
+    checkBinCompatible();
 
     std::ofstream f(fileName, std::ios::binary);
+    writeToBin(f);
+}
+
+void FontInfo::writeToBin(std::ostream &f) const
+{
+    checkBinCompatible();
 
 #pragma pack(push, 1)
     struct InfoBlock
@@ -433,88 +554,188 @@ void FontInfo::writeToBinFile(const std::string &fileName) const
 
 void FontInfo::writeToJsonFile(const std::string &fileName) const
 {
-    //TODO: test
+    std::ofstream f(fileName);
+    writeToJson(f);
+}
 
-    nlohmann::json j;
+void FontInfo::writeToJson(std::ostream &f) const
+{
+    // Keys are written in alphabetical order (as nlohmann::json sorts object keys), so the output
+    // stays identical to the previous nlohmann::json based writer.
 
-    nlohmann::json infoNode;
-    infoNode["size"] = info.size;
-    infoNode["smooth"] = info.smooth ? 1 : 0;
-    infoNode["unicode"] = info.unicode ? 1 : 0;
-    infoNode["italic"] = info.italic ? 1 : 0;
-    infoNode["bold"] = info.bold ? 1 : 0;
-    infoNode["charset"] = info.unicode ? "" : getCharSetName(info.charset);
-    infoNode["stretchH"] = info.stretchH;
-    infoNode["aa"] = info.aa;
-    infoNode["padding"] = {info.padding.up, info.padding.right, info.padding.down, info.padding.left};
-    infoNode["spacing"] = {info.spacing.horizontal, info.spacing.vertical};
-    infoNode["outline"] = info.outline;
-    infoNode["face"] = info.face;
-    if (extraInfo) {
-        infoNode["style"] = info.style;
-    }
-
-    nlohmann::json commonNode;
-    commonNode["lineHeight"] = common.lineHeight;
-    commonNode["base"] = common.base;
-    commonNode["scaleW"] = common.scaleW;
-    commonNode["scaleH"] = common.scaleH;
-    commonNode["pages"] = pages.size();
-    commonNode["packed"] = static_cast<int>(common.packed);
-    commonNode["alphaChnl"] = common.alphaChnl;
-    commonNode["redChnl"] = common.redChnl;
-    commonNode["greenChnl"] = common.greenChnl;
-    commonNode["blueChnl"] = common.blueChnl;
-    if (extraInfo)
+    JsonWriter j(f);
+
+    j.beginObject();
+
+    j.key("chars");
+    j.beginArray();
+    for (const auto& c: chars)
     {
-        commonNode["totalHeight"] = common.totalHeight;
-        commonNode["descent"] = common.descent;
+        j.beginObject();
+        j.field("chnl", c.chnl)
+            .field("height", c.height)
+            .field("id", c.id)
+            .field("page", c.page);
+        if (hasPhases())
+            j.field("phase", c.phase);
+        j.field("width", c.width)
+            .field("x", c.x)
+            .field("xadvance", c.xadvance)
+            .field("xoffset", c.xoffset)
+            .field("y", c.y)
+            .field("yoffset", c.yoffset);
+        j.endObject();
     }
+    j.endArray();
 
-    nlohmann::json charsNode = nlohmann::json::array();
-    for(auto c: chars)
+    j.key("common");
+    j.beginObject();
+    j.field("alphaChnl", common.alphaChnl)
+        .field("base", common.base)
+        .field("blueChnl", common.blueChnl);
+    if (!colorPages.empty())
+    {
+        j.key("colorPages");
+        j.beginArray();
+        for (const auto page : colorPages)
+            j.value(page);
+        j.endArray();
+    }
+    if (extraInfo)
+        j.field("descent", common.descent);
+    j.field("greenChnl", common.greenChnl)
+        .field("lineHeight", common.lineHeight)
+        .field("packed", static_cast<int>(common.packed))
+        .field("pages", pages.size())
+        .field("redChnl", common.redChnl)
+        .field("scaleH", common.scaleH)
+        .field("scaleW", common.scaleW);
+    if (hasPhases())
+        j.field("subpixelPhases", common.subpixelPhases);
+    if (extraInfo)
+        j.field("totalHeight", common.totalHeight);
+    j.endObject();
+
+    if (!groups.empty())
     {
-        nlohmann::json charNode;
-        charNode["id"] = c.id;
-        charNode["x"] = c.x;
-        charNode["y"] = c.y;
-        charNode["width"] = c.width;
-        charNode["height"] = c.height;
-        charNode["xoffset"] = c.xoffset;
-        charNode["yoffset"] = c.yoffset;
-        charNode["xadvance"] = c.xadvance;
-        charNode["page"] = c.page;
-        charNode["chnl"] = c.chnl;
-        charsNode.push_back(charNode);
+        j.key("groups");
+        j.beginArray();
+        for (const auto& g: groups)
+        {
+            j.beginObject();
+            j.field("firstPage", g.firstPage)
+                .field("name", g.name)
+                .field("pageCount", g.pageCount);
+            j.endObject();
+        }
+        j.endArray();
     }
 
-    nlohmann::json kerningsNode = nlohmann::json::array();
-    for(auto k: kernings)
+    j.key("info");
+    j.beginObject();
+    j.field("aa", info.aa)
+        .field("bold", info.bold ? 1 : 0)
+        .field("charset", info.unicode ? "" : getCharSetName(info.charset))
+        .field("face", info.face)
+        .field("italic", info.italic ? 1 : 0)
+        .field("outline", info.outline);
+    j.key("padding");
+    j.beginArray();
+    j.value(info.padding.up);
+    j.value(info.padding.right);
+    j.value(info.padding.down);
+    j.value(info.padding.left);
+    j.endArray();
+    j.field("size", info.size)
+        .field("smooth", info.smooth ? 1 : 0);
+    j.key("spacing");
+    j.beginArray();
+    j.value(info.spacing.horizontal);
+    j.value(info.spacing.vertical);
+    j.endArray();
+    j.field("stretchH", info.stretchH);
+    if (extraInfo)
+        j.field("style", info.style);
+    j.field("unicode", info.unicode ? 1 : 0);
+    j.endObject();
+
+    j.key("kernings");
+    j.beginArray();
+    for (const auto& k: kernings)
     {
-        nlohmann::json kerningNode;
-        kerningNode["first"] = k.first;
-        kerningNode["second"] = k.second;
-        kerningNode["amount"] = k.amount;
-        kerningsNode.push_back(kerningNode);
+        j.beginObject();
+        j.field("amount", k.amount)
+            .field("first", k.first)
+            .field("second", k.second);
+        j.endObject();
     }
+    j.endArray();
 
-    j["info"] = infoNode;
-    j["common"] = commonNode;
-    j["pages"] = pages;
-    j["chars"] = charsNode;
-    j["kernings"] = kerningsNode;
+    j.key("pages");
+    j.beginArray();
+    for (const auto& p: pages)
+        j.value(p);
+    j.endArray();
 
-    std::ofstream f(fileName);
-    f << j.dump(4);
+    if (!runs.empty())
+    {
+        j.key("runs");
+        j.beginArray();
+        for (const auto& r: runs)
+        {
+            j.beginObject();
+            j.key("glyphs");
+            j.beginArray();
+            for (const auto& g: r.glyphs)
+            {
+                j.beginObject();
+                j.field("height", g.height)
+                    .field("page", g.page)
+                    .field("width", g.width)
+                    .field("x", g.x)
+                    .field("xoffset", g.xoffset)
+                    .field("y", g.y)
+                    .field("yoffset", g.yoffset);
+                j.endObject();
+            }
+            j.endArray();
+            j.field("id", r.id)
+                .field("xadvance", r.xadvance);
+            j.endObject();
+        }
+        j.endArray();
+    }
+
+    j.endObject();
 }
 
-void FontInfo::writeToCborFile(const std::string &fileName) const
+void FontInfo::checkCborCompatible() const
 {
     if (extraInfo)
         throw std::runtime_error("--extra-info flag is not compatible with cbor format");
+    if (hasPhases())
+        throw std::runtime_error("--subpixel-phases is not compatible with cbor format");
+    if (!colorPages.empty())
+        throw std::runtime_error("color pages (--color-glyphs) are not compatible with cbor format");
+    if (!groups.empty())
+        throw std::runtime_error("page groups (--page-groups) are not compatible with cbor format");
+    if (!runs.empty())
+        throw std::runtime_error("shaped strings (--strings-file) are not compatible with cbor format");
+}
+
+void FontInfo::writeToCborFile(const std::string &fileName) const
+{
+    checkCborCompatible();
 
     std::ofstream f(fileName, std::fstream::binary);
     f.exceptions(std::fstream::failbit | std::fstream::badbit);
+    writeToCbor(f);
+}
+
+void FontInfo::writeToCbor(std::ostream &f) const
+{
+    checkCborCompatible();
+
     cbor_encoder_ostream encoder(f);
 
     encoder.write_indefinite_array();
@@ -558,7 +779,7 @@ void FontInfo::writeToCborFile(const std::string &fileName) const
 
     // characters
     encoder.write_array(chars.size() * 10u);
-    for (auto c: chars)
+    for (const auto& c: chars)
     {
         encoder.write_uint(c.id);
         encoder.write_uint(c.x);
@@ -574,7 +795,7 @@ void FontInfo::writeToCborFile(const std::string &fileName) const
 
     // kernings
     encoder.write_array(kernings.size() * 3u);
-    for (auto k: kernings)
+    for (const auto& k: kernings)
     {
         encoder.write_uint(k.first);
         encoder.write_uint(k.second);
@@ -583,3 +804,768 @@ void FontInfo::writeToCborFile(const std::string &fileName) const
 
     encoder.write_break();
 }
+
+std::uint8_t FontInfo::getCharSetId(const std::string &name)
+{
+    for (int i = 0; i < 256; ++i)
+        if (getCharSetName(static_cast<std::uint8_t>(i)) == name)
+            return static_cast<std::uint8_t>(i);
+    throw std::runtime_error("unknown charset " + name);
+}
+
+namespace {
+
+// Attributes of a text (or xml) descriptor tag, missing ones read as 0. Values point into the parsed data.
+class Attributes
+{
+public:
+    void set(std::string_view key, std::string_view value)
+    {
+        values.emplace_back(key, value);
+    }
+
+    bool has(std::string_view key) const
+    {
+        return find(key) != nullptr;
+    }
+
+    std::string str(std::string_view key) const
+    {
+        const auto value = find(key);
+        return value ? std::string(*value) : std::string();
+    }
+
+    long num(std::string_view key) const
+    {
+        const auto value = find(key);
+        return value ? toNumber(key, *value) : 0;
+    }
+
+    // "a,b,c" lists (padding, spacing)
+    std::vector<long> list(std::string_view key) const
+    {
+        std::vector<long> result;
+        const auto value = find(key);
+        if (!value)
+            return result;
+        std::size_t start = 0;
+        while (start <= value->size())
+        {
+            auto end = value->find(',', start);
+            if (end == std::string_view::npos)
+                end = value->size();
+            result.push_back(toNumber(key, value->substr(start, end - start)));
+            start = end + 1;
+        }
+        return result;
+    }
+
+private:
+    // Few attributes per tag, a linear search is faster than a map
+    const std::string_view *find(std::string_view key) const
+    {
+        for (const auto &kv : values)
+            if (kv.first == key)
+                return &kv.second;
+        return nullptr;
+    }
+
+    static long toNumber(std::string_view key, std::string_view value)
+    {
+        long result = 0;
+        const auto end = value.data() + value.size();
+        const auto r = std::from_chars(value.data(), end, result);
+        if (r.ec != std::errc() || r.ptr != end)
+            throw std::runtime_error("invalid value of " + std::string(key) + ": " + std::string(value));
+        return result;
+    }
+
+    std::vector<std::pair<std::string_view, std::string_view>> values;
+};
+
+void readInfo(FontInfo &f, const Attributes &a, const std::function<std::uint8_t(const std::string&)> &getCharSetId)
+{
+    f.info.face = a.str("face");
+    f.info.size = static_cast<std::int16_t>(a.num("size"));
+    f.info.bold = a.num("bold") != 0;
+    f.info.italic = a.num("italic") != 0;
+    f.info.unicode = a.num("unicode") != 0;
+    if (!f.info.unicode && !a.str("charset").empty())
+        f.info.charset = getCharSetId(a.str("charset"));
+    f.info.stretchH = static_cast<std::uint16_t>(a.num("stretchH"));
+    f.info.smooth = a.num("smooth") != 0;
+    f.info.aa = static_cast<std::uint8_t>(a.num("aa"));
+    const auto padding = a.list("padding");
+    if (padding.size() == 4)
+    {
+        f.info.padding.up = static_cast<std::uint8_t>(padding[0]);
+        f.info.padding.right = static_cast<std::uint8_t>(padding[1]);
+        f.info.padding.down = static_cast<std::uint8_t>(padding[2]);
+        f.info.padding.left = static_cast<std::uint8_t>(padding[3]);
+    }
+    const auto spacing = a.list("spacing");
+    if (spacing.size() == 2)
+    {
+        f.info.spacing.horizontal = static_cast<std::uint8_t>(spacing[0]);
+        f.info.spacing.vertical = static_cast<std::uint8_t>(spacing[1]);
+    }
+    f.info.outline = static_cast<std::uint8_t>(a.num("outline"));
+    if (a.has("style"))
+    {
+        f.info.style = a.str("style");
+        f.extraInfo = true;
+    }
+}
+
+void readCommon(FontInfo &f, const Attributes &a)
+{
+    f.common.lineHeight = static_cast<std::uint16_t>(a.num("lineHeight"));
+    f.common.base = static_cast<std::uint16_t>(a.num("base"));
+    f.common.scaleW = static_cast<std::uint16_t>(a.num("scaleW"));
+    f.common.scaleH = static_cast<std::uint16_t>(a.num("scaleH"));
+    f.common.packed = a.num("packed") != 0;
+    f.common.alphaChnl = static_cast<std::uint8_t>(a.num("alphaChnl"));
+    f.common.redChnl = static_cast<std::uint8_t>(a.num("redChnl"));
+    f.common.greenChnl = static_cast<std::uint8_t>(a.num("greenChnl"));
+    f.common.blueChnl = static_cast<std::uint8_t>(a.num("blueChnl"));
+    if (a.has("totalHeight"))
+    {
+        f.common.totalHeight = static_cast<std::uint16_t>(a.num("totalHeight"));
+        f.common.descent = static_cast<std::int16_t>(a.num("descent"));
+        f.extraInfo = true;
+    }
+    if (a.has("subpixelPhases"))
+        f.common.subpixelPhases = static_cast<std::uint8_t>(a.num("subpixelPhases"));
+    f.pages.resize(static_cast<std::size_t>(a.num("pages")));
+}
+
+void readPage(FontInfo &f, const Attributes &a)
+{
+    const auto id = static_cast<std::size_t>(a.num("id"));
+    if (id >= f.pages.size())
+        f.pages.resize(id + 1);
+    f.pages[id] = a.str("file");
+    if (a.has("color") && a.num("color") && !f.isColorPage(id))
+    {
+        f.colorPages.push_back(static_cast<std::uint32_t>(id));
+        std::sort(f.colorPages.begin(), f.colorPages.end());
+    }
+}
+
+FontInfo::PageGroup readPageGroup(const Attributes &a)
+{
+    FontInfo::PageGroup g;
+    g.name = a.str("name");
+    g.firstPage = static_cast<std::uint32_t>(a.num("firstPage"));
+    g.pageCount = static_cast<std::uint32_t>(a.num("pageCount"));
+    return g;
+}
+
+FontInfo::Char readChar(const Attributes &a)
+{
+    FontInfo::Char c;
+    c.id = static_cast<std::uint32_t>(a.num("id"));
+    c.x = static_cast<std::uint16_t>(a.num("x"));
+    c.y = static_cast<std::uint16_t>(a.num("y"));
+    c.width = static_cast<std::uint16_t>(a.num("width"));
+    c.height = static_cast<std::uint16_t>(a.num("height"));
+    c.xoffset = static_cast<std::int16_t>(a.num("xoffset"));
+    c.yoffset = static_cast<std::int16_t>(a.num("yoffset"));
+    c.xadvance = static_cast<std::int16_t>(a.num("xadvance"));
+    c.page = static_cast<std::int8_t>(a.num("page"));
+    c.chnl = static_cast<std::int8_t>(a.num("chnl"));
+    c.phase = static_cast<std::uint8_t>(a.num("phase"));
+    return c;
+}
+
+FontInfo::Kerning readKerning(const Attributes &a)
+{
+    FontInfo::Kerning k;
+    k.first = static_cast<std::uint32_t>(a.num("first"));
+    k.second = static_cast<std::uint32_t>(a.num("second"));
+    k.amount = static_cast<std::int16_t>(a.num("amount"));
+    return k;
+}
+
+FontInfo::Run readRun(const Attributes &a)
+{
+    FontInfo::Run r;
+    r.id = static_cast<std::uint32_t>(a.num("id"));
+    r.xadvance = static_cast<std::int16_t>(a.num("xadvance"));
+    return r;
+}
+
+FontInfo::Run::Glyph readRunGlyph(const Attributes &a)
+{
+    FontInfo::Run::Glyph g;
+    g.x = static_cast<std::uint16_t>(a.num("x"));
+    g.y = static_cast<std::uint16_t>(a.num("y"));
+    g.width = static_cast<std::uint16_t>(a.num("width"));
+    g.height = static_cast<std::uint16_t>(a.num("height"));
+    g.xoffset = static_cast<std::int16_t>(a.num("xoffset"));
+    g.yoffset = static_cast<std::int16_t>(a.num("yoffset"));
+    g.page = static_cast<std::int8_t>(a.num("page"));
+    return g;
+}
+
+// Little endian reader of the binary format blocks.
+class BinReader
+{
+public:
+    explicit BinReader(std::string_view data) : data(data) {}
+
+    bool atEnd() const
+    {
+        return pos == data.size();
+    }
+
+    template<class T>
+    T read()
+    {
+        need(sizeof(T));
+        std::make_unsigned_t<T> v = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i)
+            v |= static_cast<std::make_unsigned_t<T>>(static_cast<std::uint8_t>(data[pos + i])) << (8u * i);
+        pos += sizeof(T);
+        return static_cast<T>(v);
+    }
+
+    std::string_view bytes(std::size_t size)
+    {
+        need(size);
+        const auto result = data.substr(pos, size);
+        pos += size;
+        return result;
+    }
+
+private:
+    void need(std::size_t size) const
+    {
+        if (data.size() - pos < size)
+            throw std::runtime_error("truncated binary descriptor");
+    }
+
+    std::string_view data;
+    std::size_t pos = 0;
+};
+
+// Reader of the cbor items written by cbor_encoder (definite strings and arrays, integers, booleans).
+class CborReader
+{
+public:
+    explicit CborReader(std::string_view data) : data(data) {}
+
+    std::int64_t readInt()
+    {
+        const auto major = peek() >> 5u;
+        const auto value = readHead();
+        if (major == 0)
+            return static_cast<std::int64_t>(value);
+        if (major == 1)
+            return -1 - static_cast<std::int64_t>(value);
+        throw std::runtime_error("cbor descriptor: integer expected");
+    }
+
+    bool readBool()
+    {
+        const auto b = readByte();
+        if (b != 0xf4u && b != 0xf5u)
+            throw std::runtime_error("cbor descriptor: boolean expected");
+        return b == 0xf5u;
+    }
+
+    std::string_view readString()
+    {
+        if (peek() >> 5u != 3)
+            throw std::runtime_error("cbor descriptor: string expected");
+        const auto size = readHead();
+        if (size > data.size() - pos)
+            throw std::runtime_error("truncated cbor descriptor");
+        const auto result = data.substr(pos, static_cast<std::size_t>(size));
+        pos += static_cast<std::size_t>(size);
+        return result;
+    }
+
+    std::uint64_t readArray()
+    {
+        if (peek() >> 5u != 4 || (peek() & 0x1fu) == 31)
+            throw std::runtime_error("cbor descriptor: array expected");
+        return readHead();
+    }
+
+    void expect(std::uint8_t byte, const char *what)
+    {
+        if (readByte() != byte)
+            throw std::runtime_error(std::string("cbor descriptor: ") + what + " expected");
+    }
+
+private:
+    std::uint8_t peek() const
+    {
+        if (pos == data.size())
+            throw std::runtime_error("truncated cbor descriptor");
+        return static_cast<std::uint8_t>(data[pos]);
+    }
+
+    std::uint8_t readByte()
+    {
+        const auto b = peek();
+        ++pos;
+        return b;
+    }
+
+    std::uint64_t readHead()
+    {
+        const auto info = readByte() & 0x1fu;
+        if (info < 24)
+            return info;
+        if (info > 27)
+            throw std::runtime_error("cbor descriptor: unsupported item");
+        const auto bytes = 1u << (info - 24u);
+        std::uint64_t value = 0;
+        for (unsigned i = 0; i < bytes; ++i)
+            value = (value << 8u) | readByte();
+        return value;
+    }
+
+    std::string_view data;
+    std::size_t pos = 0;
+};
+
+}
+
+FontInfo FontInfo::readFromText(std::string_view data)
+{
+    FontInfo f;
+    std::size_t lineStart = 0;
+    while (lineStart < data.size())
+    {
+        auto lineEnd = data.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos)
+            lineEnd = data.size();
+        auto line = data.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        // tag key=value key="quoted value" ...
+        std::size_t i = line.find(' ');
+        const auto tag = line.substr(0, i);
+        Attributes a;
+        while (i < line.size())
+        {
+            while (i < line.size() && (line[i] == ' ' || line[i] == '\r'))
+                ++i;
+            const auto eq = line.find('=', i);
+            if (eq == std::string_view::npos)
+                break;
+            const auto key = line.substr(i, eq - i);
+            i = eq + 1;
+            std::size_t valueEnd;
+            if (i < line.size() && line[i] == '"')
+            {
+                ++i;
+                valueEnd = line.find('"', i);
+                if (valueEnd == std::string_view::npos)
+                    throw std::runtime_error("unterminated string in text descriptor");
+                a.set(key, line.substr(i, valueEnd - i));
+                i = valueEnd + 1;
+            }
+            else
+            {
+                valueEnd = line.find_first_of(" \r", i);
+                if (valueEnd == std::string_view::npos)
+                    valueEnd = line.size();
+                a.set(key, line.substr(i, valueEnd - i));
+                i = valueEnd;
+            }
+        }
+
+        if (tag == "info")
+            readInfo(f, a, getCharSetId);
+        else if (tag == "common")
+            readCommon(f, a);
+        else if (tag == "page")
+            readPage(f, a);
+        else if (tag == "group")
+            f.groups.push_back(readPageGroup(a));
+        else if (tag == "char")
+            f.chars.push_back(readChar(a));
+        else if (tag == "kerning")
+            f.kernings.push_back(readKerning(a));
+        else if (tag == "run")
+            f.runs.push_back(readRun(a));
+        else if (tag == "runglyph")
+        {
+            if (f.runs.empty())
+                throw std::runtime_error("runglyph before run in text descriptor");
+            f.runs.back().glyphs.push_back(readRunGlyph(a));
+        }
+    }
+    return f;
+}
+
+FontInfo FontInfo::readFromXml(std::string_view data)
+{
+    tinyxml2::XMLDocument doc;
+    if (doc.Parse(data.data(), data.size()) != tinyxml2::XML_SUCCESS)
+        throw std::runtime_error(std::string("xml descriptor parse error: ") + doc.ErrorStr());
+
+    const auto root = doc.FirstChildElement("font");
+    if (!root)
+        throw std::runtime_error("xml descriptor without font element");
+
+    const auto attributes = [](const tinyxml2::XMLElement *e)
+    {
+        Attributes a;
+        if (e)
+            for (auto attr = e->FirstAttribute(); attr; attr = attr->Next())
+                a.set(attr->Name(), attr->Value());
+        return a;
+    };
+
+    FontInfo f;
+    readInfo(f, attributes(root->FirstChildElement("info")), getCharSetId);
+    readCommon(f, attributes(root->FirstChildElement("common")));
+    if (const auto pagesElement = root->FirstChildElement("pages"))
+        for (auto e = pagesElement->FirstChildElement("page"); e; e = e->NextSiblingElement("page"))
+            readPage(f, attributes(e));
+    if (const auto groupsElement = root->FirstChildElement("groups"))
+        for (auto e = groupsElement->FirstChildElement("group"); e; e = e->NextSiblingElement("group"))
+            f.groups.push_back(readPageGroup(attributes(e)));
+    if (const auto charsElement = root->FirstChildElement("chars"))
+        for (auto e = charsElement->FirstChildElement("char"); e; e = e->NextSiblingElement("char"))
+            f.chars.push_back(readChar(attributes(e)));
+    if (const auto kerningsElement = root->FirstChildElement("kernings"))
+        for (auto e = kerningsElement->FirstChildElement("kerning"); e; e = e->NextSiblingElement("kerning"))
+            f.kernings.push_back(readKerning(attributes(e)));
+    if (const auto runsElement = root->FirstChildElement("runs"))
+        for (auto e = runsElement->FirstChildElement("run"); e; e = e->NextSiblingElement("run"))
+        {
+            f.runs.push_back(readRun(attributes(e)));
+            for (auto g = e->FirstChildElement("glyph"); g; g = g->NextSiblingElement("glyph"))
+                f.runs.back().glyphs.push_back(readRunGlyph(attributes(g)));
+        }
+    return f;
+}
+
+FontInfo FontInfo::readFromBin(std::string_view data)
+{
+    BinReader r(data);
+    if (r.bytes(3) != "BMF" || r.read<std::uint8_t>() != 3)
+        throw std::runtime_error("not a version 3 binary descriptor");
+
+    FontInfo f;
+    while (!r.atEnd())
+    {
+        const auto type = r.read<std::uint8_t>();
+        const auto size = r.read<std::int32_t>();
+        if (size < 0)
+            throw std::runtime_error("invalid binary descriptor block size");
+        BinReader block(r.bytes(static_cast<std::size_t>(size)));
+        switch (type)
+        {
+        case 1:
+        {
+            f.info.size = block.read<std::int16_t>();
+            const auto bits = block.read<std::uint8_t>();
+            f.info.smooth = bits & 1u;
+            f.info.unicode = bits & 2u;
+            f.info.italic = bits & 4u;
+            f.info.bold = bits & 8u;
+            f.info.charset = block.read<std::uint8_t>();
+            f.info.stretchH = block.read<std::uint16_t>();
+            f.info.aa = block.read<std::uint8_t>();
+            f.info.padding.up = block.read<std::uint8_t>();
+            f.info.padding.right = block.read<std::uint8_t>();
+            f.info.padding.down = block.read<std::uint8_t>();
+            f.info.padding.left = block.read<std::uint8_t>();
+            f.info.spacing.horizontal = block.read<std::uint8_t>();
+            f.info.spacing.vertical = block.read<std::uint8_t>();
+            f.info.outline = block.read<std::uint8_t>();
+            const auto face = block.bytes(static_cast<std::size_t>(size) - 14);
+            f.info.face = std::string(face.substr(0, face.find('\0')));
+            break;
+        }
+        case 2:
+        {
+            f.common.lineHeight = block.read<std::uint16_t>();
+            f.common.base = block.read<std::uint16_t>();
+            f.common.scaleW = block.read<std::uint16_t>();
+            f.common.scaleH = block.read<std::uint16_t>();
+            f.pages.resize(block.read<std::uint16_t>());
+            f.common.packed = block.read<std::uint8_t>() & 0x80u;
+            f.common.alphaChnl = block.read<std::uint8_t>();
+            f.common.redChnl = block.read<std::uint8_t>();
+            f.common.greenChnl = block.read<std::uint8_t>();
+            f.common.blueChnl = block.read<std::uint8_t>();
+            break;
+        }
+        case 3:
+        {
+            // all names have the same length
+            const auto names = block.bytes(static_cast<std::size_t>(size));
+            if (!f.pages.empty())
+            {
+                const auto length = names.size() / f.pages.size();
+                for (std::size_t i = 0; i < f.pages.size(); ++i)
+                {
+                    const auto name = names.substr(i * length, length);
+                    f.pages[i] = std::string(name.substr(0, name.find('\0')));
+                }
+            }
+            break;
+        }
+        case 4:
+            f.chars.resize(static_cast<std::size_t>(size) / 20);
+            for (auto &c : f.chars)
+            {
+                c.id = block.read<std::uint32_t>();
+                c.x = block.read<std::uint16_t>();
+                c.y = block.read<std::uint16_t>();
+                c.width = block.read<std::uint16_t>();
+                c.height = block.read<std::uint16_t>();
+                c.xoffset = block.read<std::int16_t>();
+                c.yoffset = block.read<std::int16_t>();
+                c.xadvance = block.read<std::int16_t>();
+                c.page = block.read<std::int8_t>();
+                c.chnl = block.read<std::int8_t>();
+            }
+            break;
+        case 5:
+            f.kernings.resize(static_cast<std::size_t>(size) / 10);
+            for (auto &k : f.kernings)
+            {
+                k.first = block.read<std::uint32_t>();
+                k.second = block.read<std::uint32_t>();
+                k.amount = block.read<std::int16_t>();
+            }
+            break;
+        default:
+            break; // unknown blocks are skipped
+        }
+    }
+    return f;
+}
+
+FontInfo FontInfo::readFromJson(std::string_view data)
+{
+    nlohmann::json j;
+    try
+    {
+        j = nlohmann::json::parse(data.begin(), data.end());
+    }
+    catch (const nlohmann::json::exception &e)
+    {
+        throw std::runtime_error(std::string("json descriptor parse error: ") + e.what());
+    }
+
+    const auto get = [](const nlohmann::json &o, const char *key) -> long
+    {
+        const auto it = o.find(key);
+        return it == o.end() ? 0 : it->get<long>();
+    };
+
+    FontInfo f;
+    const auto &info = j.at("info");
+    f.info.face = info.value("face", "");
+    f.info.size = static_cast<std::int16_t>(get(info, "size"));
+    f.info.bold = get(info, "bold") != 0;
+    f.info.italic = get(info, "italic") != 0;
+    f.info.unicode = get(info, "unicode") != 0;
+    if (!f.info.unicode && !info.value("charset", "").empty())
+        f.info.charset = getCharSetId(info.value("charset", ""));
+    f.info.stretchH = static_cast<std::uint16_t>(get(info, "stretchH"));
+    f.info.smooth = get(info, "smooth") != 0;
+    f.info.aa = static_cast<std::uint8_t>(get(info, "aa"));
+    const auto &padding = info.at("padding");
+    f.info.padding.up = padding.at(0).get<std::uint8_t>();
+    f.info.padding.right = padding.at(1).get<std::uint8_t>();
+    f.info.padding.down = padding.at(2).get<std::uint8_t>();
+    f.info.padding.left = padding.at(3).get<std::uint8_t>();
+    const auto &spacing = info.at("spacing");
+    f.info.spacing.horizontal = spacing.at(0).get<std::uint8_t>();
+    f.info.spacing.vertical = spacing.at(1).get<std::uint8_t>();
+    f.info.outline = static_cast<std::uint8_t>(get(info, "outline"));
+    if (info.contains("style"))
+    {
+        f.info.style = info.value("style", "");
+        f.extraInfo = true;
+    }
+
+    const auto &common = j.at("common");
+    f.common.lineHeight = static_cast<std::uint16_t>(get(common, "lineHeight"));
+    f.common.base = static_cast<std::uint16_t>(get(common, "base"));
+    f.common.scaleW = static_cast<std::uint16_t>(get(common, "scaleW"));
+    f.common.scaleH = static_cast<std::uint16_t>(get(common, "scaleH"));
+    f.common.packed = get(common, "packed") != 0;
+    f.common.alphaChnl = static_cast<std::uint8_t>(get(common, "alphaChnl"));
+    f.common.redChnl = static_cast<std::uint8_t>(get(common, "redChnl"));
+    f.common.greenChnl = static_cast<std::uint8_t>(get(common, "greenChnl"));
+    f.common.blueChnl = static_cast<std::uint8_t>(get(common, "blueChnl"));
+    if (common.contains("totalHeight"))
+    {
+        f.common.totalHeight = static_cast<std::uint16_t>(get(common, "totalHeight"));
+        f.common.descent = static_cast<std::int16_t>(get(common, "descent"));
+        f.extraInfo = true;
+    }
+    if (common.contains("subpixelPhases"))
+        f.common.subpixelPhases = static_cast<std::uint8_t>(get(common, "subpixelPhases"));
+    if (common.contains("colorPages"))
+        for (const auto &page : common.at("colorPages"))
+            f.colorPages.push_back(page.get<std::uint32_t>());
+
+    for (const auto &p : j.at("pages"))
+        f.pages.push_back(p.get<std::string>());
+
+    if (j.contains("groups"))
+        for (const auto &jg : j.at("groups"))
+        {
+            PageGroup g;
+            g.name = jg.at("name").get<std::string>();
+            g.firstPage = static_cast<std::uint32_t>(get(jg, "firstPage"));
+            g.pageCount = static_cast<std::uint32_t>(get(jg, "pageCount"));
+            f.groups.push_back(std::move(g));
+        }
+
+    for (const auto &jc : j.at("chars"))
+    {
+        Char c;
+        c.id = static_cast<std::uint32_t>(get(jc, "id"));
+        c.x = static_cast<std::uint16_t>(get(jc, "x"));
+        c.y = static_cast<std::uint16_t>(get(jc, "y"));
+        c.width = static_cast<std::uint16_t>(get(jc, "width"));
+        c.height = static_cast<std::uint16_t>(get(jc, "height"));
+        c.xoffset = static_cast<std::int16_t>(get(jc, "xoffset"));
+        c.yoffset = static_cast<std::int16_t>(get(jc, "yoffset"));
+        c.xadvance = static_cast<std::int16_t>(get(jc, "xadvance"));
+        c.page = static_cast<std::int8_t>(get(jc, "page"));
+        c.chnl = static_cast<std::int8_t>(get(jc, "chnl"));
+        if (jc.contains("phase"))
+            c.phase = static_cast<std::uint8_t>(get(jc, "phase"));
+        f.chars.push_back(c);
+    }
+
+    for (const auto &jk : j.at("kernings"))
+    {
+        Kerning k;
+        k.first = static_cast<std::uint32_t>(get(jk, "first"));
+        k.second = static_cast<std::uint32_t>(get(jk, "second"));
+        k.amount = static_cast<std::int16_t>(get(jk, "amount"));
+        f.kernings.push_back(k);
+    }
+
+    if (j.contains("runs"))
+        for (const auto &jr : j.at("runs"))
+        {
+            Run r;
+            r.id = static_cast<std::uint32_t>(get(jr, "id"));
+            r.xadvance = static_cast<std::int16_t>(get(jr, "xadvance"));
+            for (const auto &jg : jr.at("glyphs"))
+            {
+                Run::Glyph g;
+                g.x = static_cast<std::uint16_t>(get(jg, "x"));
+                g.y = static_cast<std::uint16_t>(get(jg, "y"));
+                g.width = static_cast<std::uint16_t>(get(jg, "width"));
+                g.height = static_cast<std::uint16_t>(get(jg, "height"));
+                g.xoffset = static_cast<std::int16_t>(get(jg, "xoffset"));
+                g.yoffset = static_cast<std::int16_t>(get(jg, "yoffset"));
+                g.page = static_cast<std::int8_t>(get(jg, "page"));
+                r.glyphs.push_back(g);
+            }
+            f.runs.push_back(std::move(r));
+        }
+    return f;
+}
+
+FontInfo FontInfo::readFromCbor(std::string_view data)
+{
+    // Flat array in the order of writeToCbor
+    CborReader r(data);
+    r.expect(0x9fu, "indefinite array");
+    if (r.readString() != "BMF" || r.readInt() != 3)
+        throw std::runtime_error("not a version 3 cbor descriptor");
+    r.readInt(); // info block id
+
+    FontInfo f;
+    f.info.size = static_cast<std::int16_t>(r.readInt());
+    f.info.smooth = r.readBool();
+    f.info.unicode = r.readBool();
+    f.info.italic = r.readBool();
+    f.info.bold = r.readBool();
+    f.info.charset = static_cast<std::uint8_t>(r.readInt());
+    f.info.stretchH = static_cast<std::uint16_t>(r.readInt());
+    f.info.aa = static_cast<std::uint8_t>(r.readInt());
+    f.info.padding.up = static_cast<std::uint8_t>(r.readInt());
+    f.info.padding.right = static_cast<std::uint8_t>(r.readInt());
+    f.info.padding.down = static_cast<std::uint8_t>(r.readInt());
+    f.info.padding.left = static_cast<std::uint8_t>(r.readInt());
+    f.info.spacing.horizontal = static_cast<std::uint8_t>(r.readInt());
+    f.info.spacing.vertical = static_cast<std::uint8_t>(r.readInt());
+    f.info.outline = static_cast<std::uint8_t>(r.readInt());
+
+    f.common.lineHeight = static_cast<std::uint16_t>(r.readInt());
+    f.common.base = static_cast<std::uint16_t>(r.readInt());
+    f.common.scaleW = static_cast<std::uint16_t>(r.readInt());
+    f.common.scaleH = static_cast<std::uint16_t>(r.readInt());
+    r.readInt(); // page count, also given by the pages array
+    f.common.packed = r.readBool();
+    f.common.alphaChnl = static_cast<std::uint8_t>(r.readInt());
+    f.common.redChnl = static_cast<std::uint8_t>(r.readInt());
+    f.common.greenChnl = static_cast<std::uint8_t>(r.readInt());
+    f.common.blueChnl = static_cast<std::uint8_t>(r.readInt());
+
+    f.pages.resize(static_cast<std::size_t>(r.readArray()));
+    for (auto &p : f.pages)
+        p = std::string(r.readString());
+
+    const auto charItems = r.readArray();
+    if (charItems % 10)
+        throw std::runtime_error("cbor descriptor: invalid chars array");
+    f.chars.resize(static_cast<std::size_t>(charItems / 10));
+    for (auto &c : f.chars)
+    {
+        c.id = static_cast<std::uint32_t>(r.readInt());
+        c.x = static_cast<std::uint16_t>(r.readInt());
+        c.y = static_cast<std::uint16_t>(r.readInt());
+        c.width = static_cast<std::uint16_t>(r.readInt());
+        c.height = static_cast<std::uint16_t>(r.readInt());
+        c.xoffset = static_cast<std::int16_t>(r.readInt());
+        c.yoffset = static_cast<std::int16_t>(r.readInt());
+        c.xadvance = static_cast<std::int16_t>(r.readInt());
+        c.page = static_cast<std::int8_t>(r.readInt());
+        c.chnl = static_cast<std::int8_t>(r.readInt());
+    }
+
+    const auto kerningItems = r.readArray();
+    if (kerningItems % 3)
+        throw std::runtime_error("cbor descriptor: invalid kernings array");
+    f.kernings.resize(static_cast<std::size_t>(kerningItems / 3));
+    for (auto &k : f.kernings)
+    {
+        k.first = static_cast<std::uint32_t>(r.readInt());
+        k.second = static_cast<std::uint32_t>(r.readInt());
+        k.amount = static_cast<std::int16_t>(r.readInt());
+    }
+
+    r.expect(0xffu, "break");
+    return f;
+}
+
+FontInfo FontInfo::readFromFile(const std::string &fileName)
+{
+    // Parsed in place from the mapped file (strings are the only copies)
+    const MappedFile file(fileName);
+    const std::string_view data(reinterpret_cast<const char *>(file.data()), file.size());
+    if (data.empty())
+        throw std::runtime_error("empty descriptor " + fileName);
+
+    if (data.substr(0, 3) == "BMF")
+        return readFromBin(data);
+    if (static_cast<std::uint8_t>(data[0]) == 0x9fu) // indefinite length cbor array
+        return readFromCbor(data);
+    const auto first = data.find_first_not_of(" \t\r\n\xEF\xBB\xBF");
+    if (first != std::string_view::npos && data[first] == '<')
+        return readFromXml(data);
+    if (first != std::string_view::npos && data[first] == '{')
+        return readFromJson(data);
+    return readFromText(data);
+}
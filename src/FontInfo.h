@@ -1,7 +1,9 @@
 #pragma once
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <ostream>
 #include <sstream>
 
 // http://www.angelcode.com/products/bmfont/doc/file_format.html
@@ -52,6 +54,7 @@ struct FontInfo
         std::uint8_t greenChnl = 0;
         std::uint8_t blueChnl = 0;
         std::uint16_t totalHeight = 0;  // non bmfont
+        std::uint8_t subpixelPhases = 1;  // non bmfont, chars have a phase when greater than 1
     };
 
     struct Char
@@ -66,6 +69,7 @@ struct FontInfo
         std::int16_t xadvance = 0;
         std::int8_t page = 0;
         std::int8_t chnl = 0;
+        std::uint8_t phase = 0;  // non bmfont, the pen is moved right by phase / subpixelPhases pixels
     };
 
     struct Kerning
@@ -75,20 +79,72 @@ struct FontInfo
         std::int16_t amount = 0;
     };
 
+    // non bmfont, a string shaped at generation time (--strings-file): its glyphs are drawn at
+    // (pen x + xoffset, pen y + yoffset) like chars, in any order, then the pen moves by xadvance.
+    struct Run
+    {
+        struct Glyph
+        {
+            std::uint16_t x = 0;
+            std::uint16_t y = 0;
+            std::uint16_t width = 0;
+            std::uint16_t height = 0;
+            std::int16_t xoffset = 0;
+            std::int16_t yoffset = 0;
+            std::int8_t page = 0;
+        };
+
+        std::uint32_t id = 0;  // line of the strings file, from 0
+        std::int16_t xadvance = 0;
+        std::vector<Glyph> glyphs;
+    };
+
+    // non bmfont, the pages of a glyph group (--page-groups), groups do not share pages
+    struct PageGroup
+    {
+        std::string name;
+        std::uint32_t firstPage = 0;
+        std::uint32_t pageCount = 0;
+    };
+
     Info info;
     Common common;
     std::vector<std::string> pages;
+    std::vector<std::uint32_t> colorPages;  // non bmfont, ascending ids of the pages holding RGBA color glyphs
+    std::vector<PageGroup> groups;  // non bmfont, ordered by firstPage
     std::vector<Char> chars;
     std::vector<Kerning> kernings;
+    std::vector<Run> runs;
 
     bool extraInfo = false;
 
+    bool isColorPage(std::size_t page) const;
+
     void writeToXmlFile(const std::string &fileName) const;
     void writeToTextFile(const std::string &fileName) const;
     void writeToBinFile(const std::string &fileName) const;
     void writeToJsonFile(const std::string &fileName) const;
     void writeToCborFile(const std::string &fileName) const;
 
+    void writeToXml(std::ostream &os) const;
+    void writeToText(std::ostream &os) const;
+    void writeToBin(std::ostream &os) const;
+    void writeToJson(std::ostream &os) const;
+    void writeToCbor(std::ostream &os) const;
+
+    // Reads a descriptor written by any of the writers above, the format is detected from the content.
+    static FontInfo readFromFile(const std::string &fileName);
+
+    static FontInfo readFromXml(std::string_view data);
+    static FontInfo readFromText(std::string_view data);
+    static FontInfo readFromBin(std::string_view data);
+    static FontInfo readFromJson(std::string_view data);
+    static FontInfo readFromCbor(std::string_view data);
+
 private:
     static std::string getCharSetName(std::uint8_t charSet);
+    static std::uint8_t getCharSetId(const std::string &name);
+    void checkBinCompatible() const;
+    void checkCborCompatible() const;
+    bool hasPhases() const { return common.subpixelPhases > 1; }
 };
@@ -0,0 +1,365 @@
+#include "external/catch.hpp"
+#include <sstream>
+#include "FontInfo.h"
+
+namespace {
+
+FontInfo makeFontInfo()
+{
+    FontInfo f;
+    f.info.face = "Test Sans";
+    f.info.size = -32;
+    f.info.smooth = true;
+    f.info.unicode = true;
+    f.info.bold = true;
+    f.info.stretchH = 100;
+    f.info.aa = 1;
+    f.info.padding.up = 1;
+    f.info.padding.right = 2;
+    f.info.padding.down = 3;
+    f.info.padding.left = 4;
+    f.info.spacing.horizontal = 5;
+    f.info.spacing.vertical = 6;
+    f.common.lineHeight = 44;
+    f.common.base = 32;
+    f.common.scaleW = 256;
+    f.common.scaleH = 128;
+    f.common.redChnl = 4;
+    f.common.greenChnl = 4;
+    f.common.blueChnl = 4;
+    f.pages = {"test_0.png", "test_1.png"};
+
+    FontInfo::Char c;
+    c.id = 65;
+    c.x = 10;
+    c.y = 20;
+    c.width = 21;
+    c.height = 23;
+    c.xoffset = -1;
+    c.yoffset = 9;
+    c.xadvance = 21;
+    c.page = 1;
+    c.chnl = 15;
+    f.chars.push_back(c);
+    c.id = 1044;
+    c.x = 300;
+    c.page = 0;
+    f.chars.push_back(c);
+
+    FontInfo::Kerning k;
+    k.first = 65;
+    k.second = 1044;
+    k.amount = -2;
+    f.kernings.push_back(k);
+    return f;
+}
+
+void requireEqual(const FontInfo& a, const FontInfo& b, bool withFace = true)
+{
+    if (withFace)
+        REQUIRE(a.info.face == b.info.face);
+    REQUIRE(a.info.size == b.info.size);
+    REQUIRE(a.info.smooth == b.info.smooth);
+    REQUIRE(a.info.unicode == b.info.unicode);
+    REQUIRE(a.info.bold == b.info.bold);
+    REQUIRE(a.info.italic == b.info.italic);
+    REQUIRE(a.info.stretchH == b.info.stretchH);
+    REQUIRE(a.info.aa == b.info.aa);
+    REQUIRE(a.info.padding.up == b.info.padding.up);
+    REQUIRE(a.info.padding.right == b.info.padding.right);
+    REQUIRE(a.info.padding.down == b.info.padding.down);
+    REQUIRE(a.info.padding.left == b.info.padding.left);
+    REQUIRE(a.info.spacing.horizontal == b.info.spacing.horizontal);
+    REQUIRE(a.info.spacing.vertical == b.info.spacing.vertical);
+    REQUIRE(a.common.lineHeight == b.common.lineHeight);
+    REQUIRE(a.common.base == b.common.base);
+    REQUIRE(a.common.scaleW == b.common.scaleW);
+    REQUIRE(a.common.scaleH == b.common.scaleH);
+    REQUIRE(a.common.redChnl == b.common.redChnl);
+    REQUIRE(a.pages == b.pages);
+    REQUIRE(a.groups.size() == b.groups.size());
+    for (size_t i = 0; i < a.groups.size(); ++i)
+    {
+        REQUIRE(a.groups[i].name == b.groups[i].name);
+        REQUIRE(a.groups[i].firstPage == b.groups[i].firstPage);
+        REQUIRE(a.groups[i].pageCount == b.groups[i].pageCount);
+    }
+    REQUIRE(a.chars.size() == b.chars.size());
+    for (size_t i = 0; i < a.chars.size(); ++i)
+    {
+        REQUIRE(a.chars[i].id == b.chars[i].id);
+        REQUIRE(a.chars[i].x == b.chars[i].x);
+        REQUIRE(a.chars[i].y == b.chars[i].y);
+        REQUIRE(a.chars[i].width == b.chars[i].width);
+        REQUIRE(a.chars[i].height == b.chars[i].height);
+        REQUIRE(a.chars[i].xoffset == b.chars[i].xoffset);
+        REQUIRE(a.chars[i].yoffset == b.chars[i].yoffset);
+        REQUIRE(a.chars[i].xadvance == b.chars[i].xadvance);
+        REQUIRE(a.chars[i].page == b.chars[i].page);
+        REQUIRE(a.chars[i].chnl == b.chars[i].chnl);
+        REQUIRE(a.chars[i].phase == b.chars[i].phase);
+    }
+    REQUIRE(a.kernings.size() == b.kernings.size());
+    for (size_t i = 0; i < a.kernings.size(); ++i)
+    {
+        REQUIRE(a.kernings[i].first == b.kernings[i].first);
+        REQUIRE(a.kernings[i].second == b.kernings[i].second);
+        REQUIRE(a.kernings[i].amount == b.kernings[i].amount);
+    }
+    REQUIRE(a.runs.size() == b.runs.size());
+    for (size_t i = 0; i < a.runs.size(); ++i)
+    {
+        REQUIRE(a.runs[i].id == b.runs[i].id);
+        REQUIRE(a.runs[i].xadvance == b.runs[i].xadvance);
+        REQUIRE(a.runs[i].glyphs.size() == b.runs[i].glyphs.size());
+        for (size_t k = 0; k < a.runs[i].glyphs.size(); ++k)
+        {
+            const auto& ga = a.runs[i].glyphs[k];
+            const auto& gb = b.runs[i].glyphs[k];
+            REQUIRE(ga.x == gb.x);
+            REQUIRE(ga.y == gb.y);
+            REQUIRE(ga.width == gb.width);
+            REQUIRE(ga.height == gb.height);
+            REQUIRE(ga.xoffset == gb.xoffset);
+            REQUIRE(ga.yoffset == gb.yoffset);
+            REQUIRE(ga.page == gb.page);
+        }
+    }
+}
+
+}
+
+TEST_CASE("FontInfo read back")
+{
+    const auto f = makeFontInfo();
+    std::stringstream ss;
+
+    SECTION("text")
+    {
+        f.writeToText(ss);
+        requireEqual(f, FontInfo::readFromText(ss.str()));
+    }
+    SECTION("xml")
+    {
+        f.writeToXml(ss);
+        requireEqual(f, FontInfo::readFromXml(ss.str()));
+    }
+    SECTION("bin")
+    {
+        f.writeToBin(ss);
+        requireEqual(f, FontInfo::readFromBin(ss.str()));
+    }
+    SECTION("json")
+    {
+        f.writeToJson(ss);
+        requireEqual(f, FontInfo::readFromJson(ss.str()));
+    }
+    SECTION("cbor")
+    {
+        f.writeToCbor(ss);
+        requireEqual(f, FontInfo::readFromCbor(ss.str()), false); // the cbor format has no face name
+    }
+}
+
+TEST_CASE("FontInfo read back extra info")
+{
+    auto f = makeFontInfo();
+    f.extraInfo = true;
+    f.info.style = "Bold";
+    f.common.descent = -9;
+    f.common.totalHeight = 41;
+    std::stringstream ss;
+
+    const auto requireExtraInfo = [&](const FontInfo& r)
+    {
+        requireEqual(f, r);
+        REQUIRE(r.extraInfo);
+        REQUIRE(r.info.style == f.info.style);
+        REQUIRE(r.common.descent == f.common.descent);
+        REQUIRE(r.common.totalHeight == f.common.totalHeight);
+    };
+
+    SECTION("text")
+    {
+        f.writeToText(ss);
+        requireExtraInfo(FontInfo::readFromText(ss.str()));
+    }
+    SECTION("xml")
+    {
+        f.writeToXml(ss);
+        requireExtraInfo(FontInfo::readFromXml(ss.str()));
+    }
+    SECTION("json")
+    {
+        f.writeToJson(ss);
+        requireExtraInfo(FontInfo::readFromJson(ss.str()));
+    }
+}
+
+TEST_CASE("FontInfo read back subpixel phases")
+{
+    auto f = makeFontInfo();
+    f.common.subpixelPhases = 3;
+    for (std::uint8_t p = 1; p < 3; ++p)
+    {
+        auto c = f.chars.front();
+        c.phase = p;
+        c.x = static_cast<std::uint16_t>(c.x + p * 24);
+        f.chars.push_back(c);
+    }
+    std::stringstream ss;
+
+    SECTION("text")
+    {
+        f.writeToText(ss);
+        const auto r = FontInfo::readFromText(ss.str());
+        requireEqual(f, r);
+        REQUIRE(r.common.subpixelPhases == 3);
+    }
+    SECTION("xml")
+    {
+        f.writeToXml(ss);
+        const auto r = FontInfo::readFromXml(ss.str());
+        requireEqual(f, r);
+        REQUIRE(r.common.subpixelPhases == 3);
+    }
+    SECTION("json")
+    {
+        f.writeToJson(ss);
+        const auto r = FontInfo::readFromJson(ss.str());
+        requireEqual(f, r);
+        REQUIRE(r.common.subpixelPhases == 3);
+    }
+    SECTION("bin and cbor")
+    {
+        REQUIRE_THROWS_AS(f.writeToBin(ss), std::runtime_error);
+        REQUIRE_THROWS_AS(f.writeToCbor(ss), std::runtime_error);
+    }
+}
+
+TEST_CASE("FontInfo read back color pages")
+{
+    auto f = makeFontInfo();
+    f.colorPages = {1};
+    std::stringstream ss;
+
+    SECTION("text")
+    {
+        f.writeToText(ss);
+        const auto r = FontInfo::readFromText(ss.str());
+        requireEqual(f, r);
+        REQUIRE(r.colorPages == f.colorPages);
+        REQUIRE(!r.isColorPage(0));
+        REQUIRE(r.isColorPage(1));
+    }
+    SECTION("xml")
+    {
+        f.writeToXml(ss);
+        const auto r = FontInfo::readFromXml(ss.str());
+        requireEqual(f, r);
+        REQUIRE(r.colorPages == f.colorPages);
+    }
+    SECTION("json")
+    {
+        f.writeToJson(ss);
+        const auto r = FontInfo::readFromJson(ss.str());
+        requireEqual(f, r);
+        REQUIRE(r.colorPages == f.colorPages);
+    }
+    SECTION("bin and cbor")
+    {
+        REQUIRE_THROWS_AS(f.writeToBin(ss), std::runtime_error);
+        REQUIRE_THROWS_AS(f.writeToCbor(ss), std::runtime_error);
+    }
+}
+
+TEST_CASE("FontInfo read back runs")
+{
+    auto f = makeFontInfo();
+    FontInfo::Run run;
+    run.id = 2;
+    run.xadvance = 57;
+    FontInfo::Run::Glyph g;
+    g.x = 40;
+    g.y = 8;
+    g.width = 30;
+    g.height = 24;
+    g.xoffset = -1;
+    g.yoffset = 9;
+    g.page = 1;
+    run.glyphs.push_back(g);
+    g.x = 70;
+    g.xoffset = 27;
+    g.yoffset = 7;
+    g.page = 0;
+    run.glyphs.push_back(g);
+    f.runs.push_back(run);
+    run.id = 4;
+    run.glyphs.clear();
+    f.runs.push_back(run);
+    std::stringstream ss;
+
+    SECTION("text")
+    {
+        f.writeToText(ss);
+        requireEqual(f, FontInfo::readFromText(ss.str()));
+    }
+    SECTION("xml")
+    {
+        f.writeToXml(ss);
+        requireEqual(f, FontInfo::readFromXml(ss.str()));
+    }
+    SECTION("json")
+    {
+        f.writeToJson(ss);
+        requireEqual(f, FontInfo::readFromJson(ss.str()));
+    }
+    SECTION("bin and cbor")
+    {
+        REQUIRE_THROWS_AS(f.writeToBin(ss), std::runtime_error);
+        REQUIRE_THROWS_AS(f.writeToCbor(ss), std::runtime_error);
+    }
+}
+
+TEST_CASE("FontInfo read back page groups")
+{
+    auto f = makeFontInfo();
+    f.groups.push_back({"Latin", 0, 1});
+    f.groups.push_back({"Hangul Syllables", 1, 1});
+    std::stringstream ss;
+
+    SECTION("text")
+    {
+        f.writeToText(ss);
+        requireEqual(f, FontInfo::readFromText(ss.str()));
+    }
+    SECTION("xml")
+    {
+        f.writeToXml(ss);
+        requireEqual(f, FontInfo::readFromXml(ss.str()));
+    }
+    SECTION("json")
+    {
+        f.writeToJson(ss);
+        requireEqual(f, FontInfo::readFromJson(ss.str()));
+    }
+    SECTION("bin and cbor")
+    {
+        REQUIRE_THROWS_AS(f.writeToBin(ss), std::runtime_error);
+        REQUIRE_THROWS_AS(f.writeToCbor(ss), std::runtime_error);
+    }
+}
+
+TEST_CASE("FontInfo read errors")
+{
+    REQUIRE_THROWS_AS(FontInfo::readFromBin("BMF\3\1\100"), std::runtime_error);
+    REQUIRE_THROWS_AS(FontInfo::readFromBin("XYZ\3"), std::runtime_error);
+    REQUIRE_THROWS_AS(FontInfo::readFromXml("<font"), std::runtime_error);
+    REQUIRE_THROWS_AS(FontInfo::readFromJson("{"), std::runtime_error);
+    REQUIRE_THROWS_AS(FontInfo::readFromCbor("\x9f\x63" "BMF"), std::runtime_error);
+    REQUIRE_THROWS_AS(FontInfo::readFromCbor("\x9f\x63" "BMF\x02"), std::runtime_error);
+    REQUIRE_THROWS_AS(FontInfo::readFromCbor("\x80"), std::runtime_error);
+    REQUIRE_THROWS_AS(FontInfo::readFromText("char id=x"), std::runtime_error);
+    REQUIRE_THROWS_AS(FontInfo::readFromText("runglyph x=1"), std::runtime_error);
+    REQUIRE_THROWS_AS(FontInfo::readFromFile("file/that/does/not/exist.fnt"), std::runtime_error);
+}
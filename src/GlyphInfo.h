@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <vector>
 
 struct GlyphInfo
 {
@@ -21,7 +22,18 @@ struct GlyphInfo
 
     int xAdvance = 0;
 
-    bool secondaryFont = false;
+    std::uint32_t font = 0; // index of the font in the chain (see FontChain), 0 is the primary font
+    bool color = false; // RGBA color glyph (--color-glyphs), placed on color pages
+    bool stringOnly = false; // only used by pre-shaped strings (ligatures, contextual forms), has no char entry
+
+    // Subpixel positioned variants (--subpixel-phases): phase p is rendered with the pen moved right by
+    // p / phases.size() pixels, in a row of equal cells starting at x. Empty without phases.
+    struct Phase
+    {
+        std::uint32_t width = 0;
+        int xOffset = 0;
+    };
+    std::vector<Phase> phases;
 
     bool isEmpty() const
     {
@@ -0,0 +1,136 @@
+#include "Mipmaps.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+
+const int kaiserTaps = 8;
+
+// Weights of the source texels 2 * i - 3 .. 2 * i + 4 of destination texel i: sinc with half the source
+// frequency as cutoff, Kaiser window (beta 4) over the 8 taps.
+std::array<float, kaiserTaps> getKaiserWeights()
+{
+    const double pi = 3.14159265358979323846;
+    const double beta = 4.0;
+    const double radius = kaiserTaps / 2.0;
+    const auto besselI0 = [](const double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 20; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    };
+
+    std::array<double, kaiserTaps> weights;
+    double total = 0.0;
+    for (int t = 0; t < kaiserTaps; ++t)
+    {
+        const auto x = t - (kaiserTaps - 1) / 2.0; // distance to the destination texel center, never 0
+        const auto sinc = std::sin(pi * x / 2.0) / (pi * x / 2.0);
+        const auto r = x / radius;
+        weights[t] = sinc * besselI0(beta * std::sqrt(1.0 - r * r)) / besselI0(beta);
+        total += weights[t];
+    }
+
+    std::array<float, kaiserTaps> result;
+    for (int t = 0; t < kaiserTaps; ++t)
+        result[t] = static_cast<float>(weights[t] / total);
+    return result;
+}
+
+// One separable Kaiser pass halving the major axis of count lines of size texels (4 channels each).
+// stride is the distance between neighbor texels of a line, lineStride the distance between lines.
+void kaiserPass(const float* src, float* dst, const std::uint32_t size, const std::uint32_t count,
+                const std::size_t stride, const std::size_t lineStride, const std::size_t dstStride, const std::size_t dstLineStride)
+{
+    static const auto weights = getKaiserWeights();
+    const auto halfSize = std::max(size / 2, 1u);
+    for (std::uint32_t line = 0; line < count; ++line)
+        for (std::uint32_t i = 0; i < halfSize; ++i)
+        {
+            float sum[4] = {};
+            for (int t = 0; t < kaiserTaps; ++t)
+            {
+                const auto j = std::clamp(static_cast<std::int64_t>(i) * 2 - (kaiserTaps / 2 - 1) + t, std::int64_t(0), static_cast<std::int64_t>(size) - 1);
+                const auto texel = src + line * lineStride + static_cast<std::size_t>(j) * stride;
+                for (int c = 0; c < 4; ++c)
+                    sum[c] += weights[t] * texel[c];
+            }
+            const auto out = dst + line * dstLineStride + i * dstStride;
+            for (int c = 0; c < 4; ++c)
+                out[c] = sum[c];
+        }
+}
+
+std::vector<std::uint32_t> downsampleBox(const std::vector<std::uint32_t>& image, const std::uint32_t w, const std::uint32_t h)
+{
+    const auto w2 = std::max(w / 2, 1u);
+    const auto h2 = std::max(h / 2, 1u);
+    std::vector<std::uint32_t> result(static_cast<std::size_t>(w2) * h2);
+    for (std::uint32_t y = 0; y < h2; ++y)
+    {
+        const auto row0 = image.data() + static_cast<std::size_t>(std::min(y * 2, h - 1)) * w;
+        const auto row1 = image.data() + static_cast<std::size_t>(std::min(y * 2 + 1, h - 1)) * w;
+        for (std::uint32_t x = 0; x < w2; ++x)
+        {
+            const auto x0 = std::min(x * 2, w - 1);
+            const auto x1 = std::min(x * 2 + 1, w - 1);
+            std::uint32_t texel = 0;
+            for (unsigned shift = 0; shift < 32; shift += 8)
+            {
+                const auto sum = ((row0[x0] >> shift) & 0xFFu) + ((row0[x1] >> shift) & 0xFFu) + ((row1[x0] >> shift) & 0xFFu) + ((row1[x1] >> shift) & 0xFFu);
+                texel |= ((sum + 2) / 4) << shift;
+            }
+            result[static_cast<std::size_t>(y) * w2 + x] = texel;
+        }
+    }
+    return result;
+}
+
+std::vector<std::uint32_t> downsampleKaiser(const std::vector<std::uint32_t>& image, const std::uint32_t w, const std::uint32_t h)
+{
+    const auto w2 = std::max(w / 2, 1u);
+    const auto h2 = std::max(h / 2, 1u);
+
+    std::vector<float> src(image.size() * 4);
+    for (std::size_t i = 0; i < image.size(); ++i)
+        for (unsigned c = 0; c < 4; ++c)
+            src[i * 4 + c] = static_cast<float>((image[i] >> (8u * c)) & 0xFFu);
+
+    // Rows, then columns; a side of 1 texel is kept as it is
+    std::vector<float> rows(static_cast<std::size_t>(w2) * h * 4);
+    if (w > 1)
+        kaiserPass(src.data(), rows.data(), w, h, 4, static_cast<std::size_t>(w) * 4, 4, static_cast<std::size_t>(w2) * 4);
+    else
+        rows = src;
+    std::vector<float> dst(static_cast<std::size_t>(w2) * h2 * 4);
+    if (h > 1)
+        kaiserPass(rows.data(), dst.data(), h, w2, static_cast<std::size_t>(w2) * 4, 4, static_cast<std::size_t>(w2) * 4, 4);
+    else
+        dst = rows;
+
+    std::vector<std::uint32_t> result(static_cast<std::size_t>(w2) * h2);
+    for (std::size_t i = 0; i < result.size(); ++i)
+    {
+        std::uint32_t texel = 0;
+        for (unsigned c = 0; c < 4; ++c)
+            texel |= static_cast<std::uint32_t>(std::clamp(std::lround(dst[i * 4 + c]), 0L, 255L)) << (8u * c);
+        result[i] = texel;
+    }
+    return result;
+}
+
+}
+
+std::vector<std::uint32_t> Mipmaps::downsample(const std::vector<std::uint32_t>& image, const std::uint32_t w, const std::uint32_t h,
+                                               const Config::MipmapFilter filter)
+{
+    if (filter == Config::MipmapFilter::Kaiser)
+        return downsampleKaiser(image, w, h);
+    return downsampleBox(image, w, h);
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Config.h"
+
+// Downsampled levels of rendered pages (--mipmaps).
+class Mipmaps
+{
+public:
+    // Next level of a w * h RGBA8 image (R in the lowest byte): max(w / 2, 1) * max(h / 2, 1) texels.
+    // Box averages 2x2 texels, Kaiser is a separable windowed sinc (8 taps) keeping minified text sharper.
+    // Edges are clamped, so the filters never read outside the image.
+    static std::vector<std::uint32_t> downsample(const std::vector<std::uint32_t>& image, std::uint32_t w, std::uint32_t h,
+                                                 Config::MipmapFilter filter);
+};
@@ -0,0 +1,93 @@
+#include "external/catch.hpp"
+#include "Mipmaps.h"
+
+TEST_CASE("Mipmaps")
+{
+    SECTION("uniform image stays uniform")
+    {
+        const std::vector<std::uint32_t> image(6 * 5, 0x80FF2010u);
+        for (const auto filter : {Config::MipmapFilter::Box, Config::MipmapFilter::Kaiser})
+        {
+            const auto level = Mipmaps::downsample(image, 6, 5, filter);
+            REQUIRE(level.size() == 3 * 2);
+            for (const auto texel : level)
+                REQUIRE(texel == 0x80FF2010u);
+        }
+    }
+
+    SECTION("box averages 2x2 texels")
+    {
+        const std::vector<std::uint32_t> image = {
+            0x00000000u, 0xFF000000u, 0x10000000u, 0x10000000u,
+            0xFF000000u, 0xFF000000u, 0x30000000u, 0x10000000u,
+        };
+        const auto level = Mipmaps::downsample(image, 4, 2, Config::MipmapFilter::Box);
+        REQUIRE(level == std::vector<std::uint32_t>{0xBF000000u, 0x18000000u});
+    }
+
+    SECTION("single texel sides are kept")
+    {
+        const std::vector<std::uint32_t> column = {0x000000FFu, 0x000000FFu, 0x00000000u, 0x00000000u};
+        for (const auto filter : {Config::MipmapFilter::Box, Config::MipmapFilter::Kaiser})
+        {
+            const auto level = Mipmaps::downsample(column, 1, 4, filter);
+            REQUIRE(level.size() == 2);
+            REQUIRE((level[0] & 0xFFu) > 200);
+            REQUIRE((level[1] & 0xFFu) < 55);
+        }
+        REQUIRE(Mipmaps::downsample({0x12345678u}, 1, 1, Config::MipmapFilter::Kaiser) == std::vector<std::uint32_t>{0x12345678u});
+    }
+}
+
+TEST_CASE("Mipmap layout keeps glyphs in their cells")
+{
+    // Cells as the packer lays them out: on the grid of the smallest level, glyph after the margin
+    const std::uint32_t glyphW = 5;
+    const std::uint32_t glyphH = 3;
+    for (const auto filter : {Config::MipmapFilter::Box, Config::MipmapFilter::Kaiser})
+        for (std::uint32_t levels = 1; levels <= 3; ++levels)
+        {
+            Config config;
+            config.mipmapLayout = true;
+            config.mipmapLevels = levels;
+            config.mipmapFilter = filter;
+            config.spacing.hor = 3;
+            config.spacing.ver = 1;
+            const auto cellSize = config.getMipmapCellSize();
+            const auto margin = config.getMipmapMargin();
+            const auto offset = config.getPackingOffset();
+            REQUIRE(offset.hor % cellSize == 0);
+            REQUIRE(offset.ver % cellSize == 0);
+            REQUIRE(offset.hor >= config.spacing.hor);
+
+            const auto cellW = (glyphW + config.spacing.hor + config.getMipmapGutter() + cellSize - 1) / cellSize * cellSize;
+            const auto cellH = (glyphH + config.spacing.ver + config.getMipmapGutter() + cellSize - 1) / cellSize * cellSize;
+            const auto w = offset.hor + cellW * 3;
+            const auto h = offset.ver + cellH * 3;
+
+            // Only the middle cell holds a glyph, no texel of any level outside the cell may get its coverage
+            std::vector<std::uint32_t> image(static_cast<std::size_t>(w) * h, 0);
+            const auto cellX = offset.hor + cellW;
+            const auto cellY = offset.ver + cellH;
+            for (std::uint32_t y = 0; y < glyphH; ++y)
+                for (std::uint32_t x = 0; x < glyphW; ++x)
+                    image[static_cast<std::size_t>(cellY + margin + y) * w + cellX + margin + x] = 0xFFFFFFFFu;
+
+            auto levelW = w;
+            auto levelH = h;
+            for (std::uint32_t level = 1; level <= levels; ++level)
+            {
+                image = Mipmaps::downsample(image, levelW, levelH, filter);
+                levelW /= 2;
+                levelH /= 2;
+                const auto scale = 1u << level;
+                for (std::uint32_t y = 0; y < levelH; ++y)
+                    for (std::uint32_t x = 0; x < levelW; ++x)
+                    {
+                        const auto inside = x >= cellX / scale && x < (cellX + cellW) / scale && y >= cellY / scale && y < (cellY + cellH) / scale;
+                        if (!inside)
+                            REQUIRE(image[static_cast<std::size_t>(y) * levelW + x] == 0);
+                    }
+            }
+        }
+}
@@ -1,4 +1,5 @@
 #include "ProgramOptions.h"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <functional>
@@ -6,10 +7,13 @@
 #include <sstream>
 #include <string>
 #include <charconv>
+#include <cstdlib>
 #include <iostream>
+#include "Corpus.h"
 #include "HelpException.h"
 #include "external/cxxopts.hpp"
 #include "external/utf8cpp/utf8.h"
+#include "utils/extractFileName.h"
 #include "utils/splitStrByDelim.h"
 
 //TODO: warn about unknown options
@@ -31,12 +35,25 @@ Config ProgramOptions::parseCommandLine(int argc, char* argv[])
         std::string dataFormat;
         std::string kerningPairs;
         std::string textureNameSuffix;
+        std::string textureFormat;
+        std::string textureCompression;
+        std::string textureChannels;
+        std::string textureSupercompression;
+        std::string mipmapFilter;
+        std::string fontInstances;
+        std::string stringsFile;
+        std::vector<std::string> kerningCorpusFiles;
+        std::uint64_t kerningCorpusMinCount = 1;
+        std::vector<std::string> frequencyCorpusFiles;
+        std::vector<std::string> frequencyTableFiles;
+        std::string pageGroups;
 
         cxxopts::Options options("fontbm", "Command line bitmap font generator, compatible with bmfont");
         options.add_options()
             ("help", "produce help message")
             ("font-file", "path to ttf file, required", cxxopts::value<std::string>(config.fontFile))
             ("secondary-font-file", "path to ttf file, optional", cxxopts::value<std::string>(config.secondaryFontFile))
+            ("fallback-font-file", "path to ttf file used for characters missing in the previous fonts, optional, can be set multiple times (in fallback order)", cxxopts::value<std::vector<std::string>>(config.fallbackFontFiles))
             (charsOptionName, "required characters, for example: 32-64,92,120-126\ndefault value is 32-126 if 'chars-file' option is not defined", cxxopts::value<std::string>(chars))
             (charsFileOptionName, "optional path to UTF-8 text file with required characters (will be combined with 'chars' option)", cxxopts::value<std::vector<std::string>>(charsFile))
             ("color", "foreground RGB color, for example: 32,255,255, default value is 255,255,255", cxxopts::value<std::string>(color)->default_value("255,255,255"))
@@ -51,6 +68,8 @@ Config ProgramOptions::parseCommandLine(int argc, char* argv[])
             ("output", "output files name without extension, required", cxxopts::value<std::string>(config.output))
             ("data-format", R"(output data file format: "txt", "xml", "json", "bin", "cbor", default: "txt")", cxxopts::value<std::string>(dataFormat)->default_value("txt"))
             ("kerning-pairs", R"("generate kerning pairs: "disabled", "basic", "regular" (tuned by hinter), "extended" (bigger output size, but more precise), default: "disabled")", cxxopts::value<std::string>(kerningPairs)->default_value("disabled"))
+            ("kerning-corpus-file", "optional path to UTF-8 text file, can be set multiple times: kerning pairs are generated only for adjacent chars found in these files", cxxopts::value<std::vector<std::string>>(kerningCorpusFiles))
+            ("kerning-corpus-min-count", "minimum number of occurrences in the kerning corpus of a char pair to be kerned, default value is 1", cxxopts::value<std::uint64_t>(kerningCorpusMinCount)->default_value("1"))
             ("all-chars", "retrieve all characters from font", cxxopts::value<bool>(config.allChars))
             ("monochrome", "disable anti-aliasing", cxxopts::value<bool>(config.monochrome))
             ("light-hinting", "use a lighter hinting algorithm", cxxopts::value<bool>(config.lightHinting))
@@ -64,7 +83,35 @@ Config ProgramOptions::parseCommandLine(int argc, char* argv[])
             ("align-horiz", "align glyph horizontal position", cxxopts::value<std::uint32_t>(config.alignment.hor))
             ("align-vert", "align glyph vertical position", cxxopts::value<std::uint32_t>(config.alignment.ver))
             ("verbose", "verbose output", cxxopts::value<bool>(config.verbose))
+            ("stats", "print time spent in each generation phase, glyph counts, texture usage and written bytes", cxxopts::value<bool>(config.stats))
+            ("stats-json", "write the same statistics as --stats to a JSON file", cxxopts::value<std::string>(config.statsJsonFile))
+            ("incremental", "keep glyph positions of the existing output descriptor (any data format), place only new characters", cxxopts::value<bool>(config.incremental))
+            ("serve", "run as a dynamic atlas service: read glyph requests from stdin, write new chars and page updates to stdout (see README)", cxxopts::value<bool>(config.serve))
+            ("convert", "read an existing descriptor (any data format) and write it to the output in --data-format, without rendering", cxxopts::value<std::string>(config.convertFile))
             ("max-texture-count", "maximum generated textures", cxxopts::value<std::uint32_t>(config.maxTextureCount))
+            ("texture-format", R"(texture file format: "png", "dds", "ktx2", "raw", default: "png")", cxxopts::value<std::string>(textureFormat)->default_value("png"))
+            ("texture-channels", R"(texels of uncompressed dds/ktx2/raw textures: "rgba", "alpha" (coverage only), default: "rgba")", cxxopts::value<std::string>(textureChannels)->default_value("rgba"))
+            ("texture-supercompression", R"(supercompression of ktx2 textures: "none", "zstd", default: "none")", cxxopts::value<std::string>(textureSupercompression)->default_value("none"))
+            ("mipmaps", "number of downsampled levels stored in dds/ktx2 textures, default value is 0", cxxopts::value<std::uint32_t>(config.mipmapLevels)->default_value("0"))
+            ("mipmap-filter", R"(filter of the downsampled levels: "box", "kaiser", default: "box")", cxxopts::value<std::string>(mipmapFilter)->default_value("box"))
+            ("mipmap-layout", "align glyph cells to 2^mipmaps texels with a gutter covering the filter reach, so glyphs do not bleed into each other in any level", cxxopts::value<bool>(config.mipmapLayout))
+            ("font-instances", R"(variable font instances separated by ';', each a named instance and/or axis values, for example: "Regular;SemiBold;wght=650,wdth=90")", cxxopts::value<std::string>(fontInstances))
+            ("all-faces", "generate a font for every face of a TTC/OTC collection in parallel, output names get a _<face index> suffix", cxxopts::value<bool>(config.allFaces))
+            ("subpixel-phases", "number of horizontal subpixel positioned variants rendered per glyph (1-16), default value is 1", cxxopts::value<std::uint32_t>(config.subpixelPhases)->default_value("1"))
+            ("texture-array", "save equally sized pages as the layers of a single dds/ktx2 texture array, page ids of the descriptor are layer indices", cxxopts::value<bool>(config.textureArray))
+            ("texture-compression", R"(GPU block compression of dds/ktx2/raw textures: "none", "bc4", "bc7", "etc2", "eac" (bc4 and eac keep the coverage only, etc2 and eac need ktx2), default: "none")", cxxopts::value<std::string>(textureCompression)->default_value("none"))
+            ("outline", "bake an outline of this width in pixels into the red channel (glyph coverage stays in alpha), default value is 0 (disabled)", cxxopts::value<std::uint32_t>(config.effects.outline)->default_value("0"))
+            ("shadow", "bake a blurred drop shadow into the green channel", cxxopts::value<bool>(config.effects.shadow))
+            ("shadow-offset-x", "horizontal shadow offset in pixels, default value is 2", cxxopts::value<int>(config.effects.shadowOffsetX)->default_value("2"))
+            ("shadow-offset-y", "vertical shadow offset in pixels (down), default value is 2", cxxopts::value<int>(config.effects.shadowOffsetY)->default_value("2"))
+            ("shadow-blur", "shadow blur radius in pixels, default value is 2", cxxopts::value<std::uint32_t>(config.effects.shadowBlur)->default_value("2"))
+            ("glow", "bake a glow of this blur radius in pixels into the blue channel, default value is 0 (disabled)", cxxopts::value<std::uint32_t>(config.effects.glow)->default_value("0"))
+            ("frequency-corpus-file", "optional path to UTF-8 text file, can be set multiple times: chars are counted and pages are filled with the most frequent glyphs first", cxxopts::value<std::vector<std::string>>(frequencyCorpusFiles))
+            ("frequency-table-file", "optional path to a char frequency table, can be set multiple times: a \"char count\" line per char (char as in --chars or U+hex), pages are filled with the most frequent glyphs first", cxxopts::value<std::vector<std::string>>(frequencyTableFiles))
+            ("strings-file", "optional path to UTF-8 text file with one string per line, each line is shaped and written to the descriptor as a run of positioned glyphs (its chars are added to the required characters)", cxxopts::value<std::string>(stringsFile))
+            ("page-groups", R"(pack glyph groups on page sets of their own, listed in the descriptor: "none", "script", "block" (Unicode script or block of the chars), "chars-file" (a group per --chars-file, named after the file), default: "none")", cxxopts::value<std::string>(pageGroups)->default_value("none"))
+            ("color-glyphs", "render color glyphs (COLR, CBDT, sbix) in RGBA on pages of their own, listed as color pages in the descriptor", cxxopts::value<bool>(config.colorGlyphs))
+            ("render-strip-height", "render and save png/raw pages in strips of this many rows, so memory does not grow with the page area (huge pages), default value is 0 (whole pages)", cxxopts::value<std::uint32_t>(config.renderStripHeight)->default_value("0"))
             ("texture-name-suffix", R"(texture name suffix: "index_aligned", "index", "none", default: "index_aligned")", cxxopts::value<std::string>(textureNameSuffix)->default_value("index_aligned"))
             ;
 
@@ -76,9 +123,9 @@ Config ProgramOptions::parseCommandLine(int argc, char* argv[])
             throw HelpException();
         }
 
-        if (!result.count("font-file"))
+        if (!result.count("font-file") && config.convertFile.empty())
             throw std::runtime_error("--font-file required");
-        if (!result.count("output"))
+        if (!result.count("output") && !config.serve)
             throw std::runtime_error("--output required");
 
         config.useMaxTextureCount = result.count("max-texture-count");
@@ -86,9 +133,33 @@ Config ProgramOptions::parseCommandLine(int argc, char* argv[])
         if (!result.count(charsOptionName) && !result.count(charsFileOptionName))
             chars = "32-126";
         config.chars = parseCharsString(chars);
+        std::vector<std::pair<std::string, CharSet>> charGroups;
         if (result.count(charsFileOptionName))
             for (const auto& f : charsFile)
-                getCharsFromFile(f, config.chars);
+            {
+                CharSet fileChars;
+                getCharsFromFile(f, fileChars);
+                // A char of several files belongs to the group of the first one
+                auto groupChars = fileChars;
+                for (const auto& group : charGroups)
+                    groupChars = groupChars.difference(group.second);
+                auto name = extractFileName(f);
+                const auto dot = name.find_last_of('.');
+                if (dot != std::string::npos && dot > 0)
+                    name.erase(dot);
+                charGroups.emplace_back(name, groupChars);
+                config.chars.insert(fileChars);
+            }
+        if (!stringsFile.empty())
+        {
+            config.strings = getStringsFromFile(stringsFile);
+            std::vector<std::uint32_t> codes;
+            for (const auto& s : config.strings)
+                codes.insert(codes.end(), s.begin(), s.end());
+            std::sort(codes.begin(), codes.end());
+            for (const auto code : codes)
+                config.chars.insert(code);
+        }
 
         config.color = parseColor(color);
         config.backgroundTransparent = result.count(backgroundColorOptionName) == 0;
@@ -122,6 +193,19 @@ Config ProgramOptions::parseCommandLine(int argc, char* argv[])
         else
             throw std::runtime_error("unknown --kerning-pairs value");
 
+        if (!kerningCorpusFiles.empty())
+        {
+            if (config.kerningPairs == Config::KerningPairs::Disabled)
+                throw std::runtime_error("--kerning-corpus-file requires --kerning-pairs");
+            if (!kerningCorpusMinCount)
+                throw std::runtime_error("--kerning-corpus-min-count must be at least 1");
+            Corpus corpus;
+            for (const auto& f : kerningCorpusFiles)
+                corpus.addFile(f);
+            config.useKerningCorpus = true;
+            config.kerningCorpusPairs = corpus.getPairs(kerningCorpusMinCount);
+        }
+
         if (textureNameSuffix == "index_aligned")
             config.textureNameSuffix = Config::TextureNameSuffix::IndexAligned;
         else if (textureNameSuffix == "index")
@@ -131,8 +215,215 @@ Config ProgramOptions::parseCommandLine(int argc, char* argv[])
         else
             throw std::runtime_error("unknown --texture-name-suffix value");
 
+        std::transform(textureFormat.begin(), textureFormat.end(), textureFormat.begin(), tolower);
+        if (textureFormat == "png")
+            config.textureFormat = Config::TextureFormat::Png;
+        else if (textureFormat == "dds")
+            config.textureFormat = Config::TextureFormat::Dds;
+        else if (textureFormat == "ktx2")
+            config.textureFormat = Config::TextureFormat::Ktx2;
+        else if (textureFormat == "raw")
+            config.textureFormat = Config::TextureFormat::Raw;
+        else
+            throw std::runtime_error("unknown --texture-format value");
+
+        std::transform(textureCompression.begin(), textureCompression.end(), textureCompression.begin(), tolower);
+        if (textureCompression == "none")
+            config.textureCompression = Config::TextureCompression::None;
+        else if (textureCompression == "bc4")
+            config.textureCompression = Config::TextureCompression::Bc4;
+        else if (textureCompression == "bc7")
+            config.textureCompression = Config::TextureCompression::Bc7;
+        else if (textureCompression == "etc2")
+            config.textureCompression = Config::TextureCompression::Etc2;
+        else if (textureCompression == "eac")
+            config.textureCompression = Config::TextureCompression::Eac;
+        else
+            throw std::runtime_error("unknown --texture-compression value");
+
+        std::transform(textureChannels.begin(), textureChannels.end(), textureChannels.begin(), tolower);
+        if (textureChannels == "rgba")
+            config.textureChannels = Config::TextureChannels::Rgba;
+        else if (textureChannels == "alpha")
+            config.textureChannels = Config::TextureChannels::Alpha;
+        else
+            throw std::runtime_error("unknown --texture-channels value");
+
+        std::transform(textureSupercompression.begin(), textureSupercompression.end(), textureSupercompression.begin(), tolower);
+        if (textureSupercompression == "none")
+            config.textureSupercompression = Config::TextureSupercompression::None;
+        else if (textureSupercompression == "zstd")
+            config.textureSupercompression = Config::TextureSupercompression::Zstd;
+        else
+            throw std::runtime_error("unknown --texture-supercompression value");
+
+        if (config.textureChannels == Config::TextureChannels::Alpha)
+        {
+            if (config.textureFormat == Config::TextureFormat::Png)
+                throw std::runtime_error("--texture-channels alpha requires --texture-format dds, ktx2 or raw");
+            if (config.textureCompression != Config::TextureCompression::None)
+                throw std::runtime_error("--texture-channels alpha is for uncompressed textures (bc4 and eac keep the coverage only)");
+            if (!config.backgroundTransparent)
+                throw std::runtime_error("--texture-channels alpha can not be used with --background-color");
+        }
+        if (config.textureSupercompression == Config::TextureSupercompression::Zstd)
+        {
+            if (config.textureFormat != Config::TextureFormat::Ktx2)
+                throw std::runtime_error("--texture-supercompression requires --texture-format ktx2");
+#ifndef FONTBM_WITH_ZSTD
+            throw std::runtime_error("fontbm was built without zstd, --texture-supercompression zstd is not available");
+#endif
+        }
+        std::transform(mipmapFilter.begin(), mipmapFilter.end(), mipmapFilter.begin(), tolower);
+        if (mipmapFilter == "box")
+            config.mipmapFilter = Config::MipmapFilter::Box;
+        else if (mipmapFilter == "kaiser")
+            config.mipmapFilter = Config::MipmapFilter::Kaiser;
+        else
+            throw std::runtime_error("unknown --mipmap-filter value");
+
+        // With --mipmap-layout, png and raw pages get the layout for mipmaps generated at load time
+        if (config.mipmapLevels && !config.mipmapLayout
+            && config.textureFormat != Config::TextureFormat::Dds && config.textureFormat != Config::TextureFormat::Ktx2)
+            throw std::runtime_error("--mipmaps requires --texture-format dds or ktx2");
+        if (config.mipmapLayout && !config.mipmapLevels)
+            throw std::runtime_error("--mipmap-layout requires --mipmaps");
+        if (config.mipmapLayout && config.mipmapLevels > 8)
+            throw std::runtime_error("--mipmap-layout supports up to 8 mipmap levels");
+
+        if (config.subpixelPhases < 1 || config.subpixelPhases > 16)
+            throw std::runtime_error("--subpixel-phases must be between 1 and 16");
+        if (config.subpixelPhases > 1 && (config.serve || config.incremental))
+            throw std::runtime_error("--subpixel-phases can not be used with --serve or --incremental");
+
+        if (config.allFaces && (config.serve || config.incremental))
+            throw std::runtime_error("--all-faces can not be used with --serve or --incremental");
+
+        if (!fontInstances.empty())
+        {
+            config.fontInstances = parseFontInstances(fontInstances);
+            if (config.serve || config.incremental || config.allFaces)
+                throw std::runtime_error("--font-instances can not be used with --serve, --incremental or --all-faces");
+        }
+
+        if (config.textureArray)
+        {
+            if (config.textureFormat != Config::TextureFormat::Dds && config.textureFormat != Config::TextureFormat::Ktx2)
+                throw std::runtime_error("--texture-array requires --texture-format dds or ktx2");
+            if (config.incremental)
+                throw std::runtime_error("--texture-array can not be used with --incremental");
+        }
+
+        if (config.textureCompression != Config::TextureCompression::None)
+        {
+            if (config.textureFormat == Config::TextureFormat::Png)
+                throw std::runtime_error("--texture-compression requires --texture-format dds, ktx2 or raw");
+            if (config.textureFormat == Config::TextureFormat::Dds
+                && (config.textureCompression == Config::TextureCompression::Etc2 || config.textureCompression == Config::TextureCompression::Eac))
+                throw std::runtime_error("etc2 and eac compression need --texture-format ktx2");
+            if (!config.backgroundTransparent
+                && (config.textureCompression == Config::TextureCompression::Bc4 || config.textureCompression == Config::TextureCompression::Eac))
+                throw std::runtime_error("bc4 and eac keep the glyph coverage only, they can not be used with --background-color");
+        }
+
+        if (config.effects.enabled())
+        {
+            if (config.serve || config.incremental)
+                throw std::runtime_error("--outline, --shadow and --glow can not be used with --serve or --incremental");
+            if (!config.backgroundTransparent)
+                throw std::runtime_error("--outline, --shadow and --glow can not be used with --background-color");
+            if (config.textureChannels == Config::TextureChannels::Alpha
+                || config.textureCompression == Config::TextureCompression::Bc4 || config.textureCompression == Config::TextureCompression::Eac)
+                throw std::runtime_error("--outline, --shadow and --glow need rgba textures (not --texture-channels alpha, bc4 or eac)");
+            if (config.effects.outline > 64 || config.effects.glow > 64 || config.effects.shadowBlur > 64
+                || std::abs(config.effects.shadowOffsetX) > 64 || std::abs(config.effects.shadowOffsetY) > 64)
+                throw std::runtime_error("effect sizes must be up to 64 pixels");
+
+            // Effects are drawn inside the glyph cells; descriptors store the padding in a byte
+            const auto padding = config.effects.getPadding();
+            config.padding.up += padding.up;
+            config.padding.right += padding.right;
+            config.padding.down += padding.down;
+            config.padding.left += padding.left;
+            if (config.padding.up > 255 || config.padding.right > 255 || config.padding.down > 255 || config.padding.left > 255)
+                throw std::runtime_error("padding with the effect sizes must be up to 255 pixels");
+        }
+
+        if (!frequencyCorpusFiles.empty())
+        {
+            Corpus corpus;
+            for (const auto& f : frequencyCorpusFiles)
+                corpus.addFile(f);
+            for (const auto& [code, count] : corpus.getCounts())
+                config.charFrequencies[code] += count;
+        }
+        for (const auto& f : frequencyTableFiles)
+        {
+            std::ifstream fs(f, std::ifstream::binary);
+            if (!fs)
+                throw std::runtime_error("can't open frequency table file " + f);
+            const std::string table((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+            for (const auto& [code, count] : parseFrequencyTable(table))
+                config.charFrequencies[code] += count;
+        }
+        if (!config.charFrequencies.empty() && (config.serve || config.incremental || config.textureArray))
+            throw std::runtime_error("--frequency-corpus-file and --frequency-table-file can not be used with --serve, --incremental or --texture-array");
+
+        if (!config.strings.empty() && (config.serve || config.incremental))
+            throw std::runtime_error("--strings-file can not be used with --serve or --incremental");
+
+        std::transform(pageGroups.begin(), pageGroups.end(), pageGroups.begin(), tolower);
+        if (pageGroups == "none")
+            config.pageGroups = Config::PageGroups::None;
+        else if (pageGroups == "script")
+            config.pageGroups = Config::PageGroups::Script;
+        else if (pageGroups == "block")
+            config.pageGroups = Config::PageGroups::Block;
+        else if (pageGroups == "chars-file")
+            config.pageGroups = Config::PageGroups::CharsFile;
+        else
+            throw std::runtime_error("unknown --page-groups value");
+        if (config.pageGroups == Config::PageGroups::CharsFile)
+        {
+            if (charGroups.empty())
+                throw std::runtime_error("--page-groups chars-file requires --chars-file");
+            for (std::size_t i = 1; i < charGroups.size(); ++i)
+                for (std::size_t k = 0; k < i; ++k)
+                    if (charGroups[i].first == charGroups[k].first)
+                        throw std::runtime_error("--page-groups chars-file needs chars files with different names (" + charGroups[i].first + ")");
+            config.charGroups = std::move(charGroups);
+        }
+        if (config.pageGroups != Config::PageGroups::None && (config.serve || config.incremental || config.textureArray))
+            throw std::runtime_error("--page-groups can not be used with --serve, --incremental or --texture-array");
+
+        if (config.renderStripHeight)
+        {
+            if (config.textureFormat != Config::TextureFormat::Png && config.textureFormat != Config::TextureFormat::Raw)
+                throw std::runtime_error("--render-strip-height requires --texture-format png or raw");
+            if (config.textureArray)
+                throw std::runtime_error("--render-strip-height can not be used with --texture-array");
+            if (config.textureCompression != Config::TextureCompression::None && config.renderStripHeight % 4)
+                throw std::runtime_error("--render-strip-height must be a multiple of 4 with --texture-compression");
+#ifndef FONTBM_WITH_ZLIB
+            if (config.textureFormat == Config::TextureFormat::Png)
+                throw std::runtime_error("fontbm was built without zlib, --render-strip-height is not available for png pages");
+#endif
+        }
+
+        if (config.colorGlyphs)
+        {
+            if (config.serve || config.incremental)
+                throw std::runtime_error("--color-glyphs can not be used with --serve or --incremental");
+            if (!config.backgroundTransparent)
+                throw std::runtime_error("--color-glyphs can not be used with --background-color");
+            if (config.textureArray)
+                throw std::runtime_error("--color-glyphs can not be used with --texture-array (color pages have another texel format)");
+        }
+
         if (result.count(textureSizeListOptionName))
             config.textureSizeList = parseTextureSize(textureSizeList);
+        else if (config.serve)
+            config.textureSizeList = {{1024, 1024}};
         else
             config.textureSizeList = {
                 {32, 32},
@@ -154,6 +445,14 @@ Config ProgramOptions::parseCommandLine(int argc, char* argv[])
                 {8192, 8192},
         };
 
+        // Whole compression blocks
+        const auto multiple = config.getTextureSizeMultiple();
+        for (auto& size : config.textureSizeList)
+        {
+            size.w = (size.w + multiple - 1) / multiple * multiple;
+            size.h = (size.h + multiple - 1) / multiple * multiple;
+        }
+
         if (!config.alignment.hor)
             throw std::runtime_error("invalid --align-horiz");
         if (!config.alignment.ver)
@@ -168,14 +467,14 @@ Config ProgramOptions::parseCommandLine(int argc, char* argv[])
     }
 }
 
-std::set<std::uint32_t> ProgramOptions::parseCharsString(std::string str)
+CharSet ProgramOptions::parseCharsString(std::string str)
 {
     str.erase(remove_if(str.begin(), str.end(), ::isspace), str.end());
 
     if (str.empty())
-        return std::set<std::uint32_t>();
+        return CharSet();
 
-    std::set<uint32_t> result;
+    CharSet result;
 
     std::istringstream ss(str);
     std::string segment;
@@ -184,11 +483,14 @@ std::set<std::uint32_t> ProgramOptions::parseCharsString(std::string str)
         
         auto parse_value = [](const std::string& s) {
             uint32_t val = 0;
-            std::from_chars_result res;
-            if (s.starts_with("0x") || s.starts_with("0X"))
-                res = std::from_chars(s.data() + 2, s.data() + s.size(), val, 16);
-            else
-                res = std::from_chars(s.data(), s.data() + s.size(), val, 10);
+            const bool hex = s.starts_with("0x") || s.starts_with("0X");
+            const char* begin = s.data() + (hex ? 2 : 0);
+            const char* end = s.data() + s.size();
+            const auto res = std::from_chars(begin, end, val, hex ? 16 : 10);
+            if (res.ec == std::errc::result_out_of_range)
+                throw std::out_of_range("invalid utf-32 value (out of range 0x000000..0x10ffff)");
+            if (res.ec != std::errc() || res.ptr != end)
+                throw std::invalid_argument("invalid character code: \"" + s + "\"");
             return val;
         };
 
@@ -198,9 +500,7 @@ std::set<std::uint32_t> ProgramOptions::parseCharsString(std::string str)
             uint32_t end = parse_value(segment.substr(dash_pos + 1));
             if (start > maxUtf32 || end > maxUtf32)
                 throw std::out_of_range("invalid utf-32 value (out of range 0x000000..0x10ffff)");
-            for (uint32_t i = start; i <= end; ++i) {
-                result.insert(i);
-            }
+            result.insert(start, end);
         } else {
             uint32_t v = parse_value(segment);
             if (v > maxUtf32)
@@ -211,7 +511,7 @@ std::set<std::uint32_t> ProgramOptions::parseCharsString(std::string str)
     return result;
 }
 
-void ProgramOptions::getCharsFromFile(const std::string& fileName, std::set<std::uint32_t>& result)
+void ProgramOptions::getCharsFromFile(const std::string& fileName, CharSet& result)
 {
     std::ifstream fs(fileName, std::ifstream::binary);
     if (!fs)
@@ -219,8 +519,76 @@ void ProgramOptions::getCharsFromFile(const std::string& fileName, std::set<std:
     std::string str((std::istreambuf_iterator<char>(fs)),
                     std::istreambuf_iterator<char>());
 
+    // Sort first, so CharSet is filled in ascending order (appending to the last range).
+    std::vector<std::uint32_t> codes;
+    for (auto it = str.begin(); it != str.end();)
+        codes.push_back(utf8::next(it, str.end()));
+    std::sort(codes.begin(), codes.end());
+    for (const auto code : codes)
+        result.insert(code);
+}
+
+// "code count" lines, code in decimal, 0x hex or U+hex; empty lines and lines starting with # are skipped.
+std::map<std::uint32_t, std::uint64_t> ProgramOptions::parseFrequencyTable(const std::string& s)
+{
+    std::map<std::uint32_t, std::uint64_t> result;
+    std::istringstream ss(s);
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(ss, line))
+    {
+        ++lineNumber;
+        std::istringstream ls(line);
+        std::string code;
+        std::string count;
+        std::string rest;
+        if (!(ls >> code) || code.starts_with("#"))
+            continue;
+        const auto error = [&]()
+        {
+            return std::runtime_error("invalid frequency table line " + std::to_string(lineNumber) + ": " + line);
+        };
+        if (!(ls >> count) || (ls >> rest))
+            throw error();
+
+        const bool uPlus = code.starts_with("U+") || code.starts_with("u+");
+        const bool hex = uPlus || code.starts_with("0x") || code.starts_with("0X");
+        std::uint32_t utf32 = 0;
+        const auto codeEnd = code.data() + code.size();
+        const auto r = std::from_chars(code.data() + (hex ? 2 : 0), codeEnd, utf32, hex ? 16 : 10);
+        std::uint64_t n = 0;
+        const auto countEnd = count.data() + count.size();
+        const auto rc = std::from_chars(count.data(), countEnd, n);
+        if (r.ec != std::errc() || r.ptr != codeEnd || utf32 > 0x10FFFF || rc.ec != std::errc() || rc.ptr != countEnd)
+            throw error();
+        result[utf32] += n;
+    }
+    return result;
+}
+
+// Lines without the line break (\n or \r\n) and a leading byte order mark.
+std::vector<std::u32string> ProgramOptions::getStringsFromFile(const std::string& fileName)
+{
+    std::ifstream fs(fileName, std::ifstream::binary);
+    if (!fs)
+        throw std::runtime_error("can't open strings file");
+    std::string str((std::istreambuf_iterator<char>(fs)),
+                    std::istreambuf_iterator<char>());
+    if (!utf8::is_valid(str.begin(), str.end()))
+        throw std::runtime_error("strings file is not valid UTF-8");
+
+    std::vector<std::u32string> result(1);
     for (auto it = str.begin(); it != str.end();)
-        result.insert(utf8::next(it, str.end()));
+    {
+        const auto code = utf8::next(it, str.end());
+        if (code == U'\n')
+            result.emplace_back();
+        else if (code != U'\r' && !(code == 0xFEFF && result.size() == 1 && result.back().empty()))
+            result.back().push_back(code);
+    }
+    if (result.back().empty())
+        result.pop_back();
+    return result;
 }
 
 Config::Color ProgramOptions::parseColor(const std::string& str)
@@ -242,6 +610,47 @@ Config::Color ProgramOptions::parseColor(const std::string& str)
     return Config::Color{colorToUint8(rgbStr[0]), colorToUint8(rgbStr[1]), colorToUint8(rgbStr[2])};
 }
 
+std::vector<Config::FontInstance> ProgramOptions::parseFontInstances(const std::string& s)
+{
+    std::vector<Config::FontInstance> result;
+
+    try
+    {
+        for (const auto& i: string_split(s, ";", false))
+        {
+            Config::FontInstance instance;
+            for (const auto& item: string_split(i, ",", false))
+            {
+                const auto eq = item.find('=');
+                if (eq == std::string::npos)
+                {
+                    if (item.empty() || !instance.name.empty())
+                        throw std::exception();
+                    instance.name = item;
+                    continue;
+                }
+
+                const auto tag = item.substr(0, eq);
+                const auto value = item.substr(eq + 1);
+                if (tag.empty() || tag.size() > 4 || value.empty())
+                    throw std::exception();
+                std::size_t end = 0;
+                const auto v = std::stof(value, &end);
+                if (end != value.size())
+                    throw std::exception();
+                instance.axes.emplace_back(tag, v);
+            }
+            result.push_back(std::move(instance));
+        }
+    }
+    catch (const std::exception&)
+    {
+        throw std::runtime_error("invalid font instances argument");
+    }
+
+    return result;
+}
+
 std::vector<Config::Size> ProgramOptions::parseTextureSize(const std::string& s)
 {
     std::vector<Config::Size> result;
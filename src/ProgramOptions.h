@@ -6,9 +6,12 @@ class ProgramOptions
 public:
     static Config parseCommandLine(int argc, char* argv[]) ;
 
-    static std::set<std::uint32_t> parseCharsString(std::string str);
+    static CharSet parseCharsString(std::string str);
     static Config::Color parseColor(const std::string& str);
     static std::vector<Config::Size> parseTextureSize(const std::string& s);
+    static std::vector<Config::FontInstance> parseFontInstances(const std::string& s);
+    static std::map<std::uint32_t, std::uint64_t> parseFrequencyTable(const std::string& s);
 private:
-    static void getCharsFromFile(const std::string& fileName, std::set<std::uint32_t>& result);
+    static void getCharsFromFile(const std::string& fileName, CharSet& result);
+    static std::vector<std::u32string> getStringsFromFile(const std::string& fileName);
 };
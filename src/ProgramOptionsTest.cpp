@@ -36,10 +36,62 @@ TEST_CASE( "parseCmdLine")
         REQUIRE(config.output == "vera");
     }
 
+    {
+        Args args({"--font-file", "vera.ttf", "--output", "vera", "--fallback-font-file", "a.ttf", "--fallback-font-file", "b.ttf"});
+        Config config = ProgramOptions::parseCommandLine(args.argc(), args.argv());
+        REQUIRE(config.fallbackFontFiles == std::vector<std::string>{"a.ttf", "b.ttf"});
+    }
+
     {
         Args args({"--font-file", "vera.ttf"});
         REQUIRE_THROWS_AS(ProgramOptions::parseCommandLine(args.argc(), args.argv()), std::runtime_error);
     }
+
+    {
+        Args args({"--font-file", "vera.ttf", "--output", "vera", "--glow", "64", "--padding-up", "191"});
+        Config config = ProgramOptions::parseCommandLine(args.argc(), args.argv());
+        REQUIRE(config.padding.up == 255);
+    }
+
+    {
+        Args args({"--font-file", "vera.ttf", "--output", "vera", "--glow", "64", "--padding-up", "192"});
+        REQUIRE_THROWS_AS(ProgramOptions::parseCommandLine(args.argc(), args.argv()), std::runtime_error);
+    }
+}
+
+TEST_CASE("parseFontInstances")
+{
+    const auto instances = ProgramOptions::parseFontInstances("Regular;Semi Bold;wght=650,wdth=87.5;Bold,wdth=75");
+    REQUIRE(instances.size() == 4);
+    REQUIRE(instances[0].name == "Regular");
+    REQUIRE(instances[0].axes.empty());
+    REQUIRE(instances[1].getLabel() == "SemiBold");
+    REQUIRE(instances[2].name.empty());
+    REQUIRE(instances[2].axes.size() == 2);
+    REQUIRE(instances[2].axes[1].first == "wdth");
+    REQUIRE(instances[2].axes[1].second == 87.5f);
+    REQUIRE(instances[2].getLabel() == "wght650_wdth87.5");
+    REQUIRE(instances[3].getLabel() == "Bold_wdth75");
+
+    REQUIRE_THROWS_AS(ProgramOptions::parseFontInstances(""), std::runtime_error);
+    REQUIRE_THROWS_AS(ProgramOptions::parseFontInstances("Regular;;Bold"), std::runtime_error);
+    REQUIRE_THROWS_AS(ProgramOptions::parseFontInstances("Regular,Bold"), std::runtime_error);
+    REQUIRE_THROWS_AS(ProgramOptions::parseFontInstances("weight=700"), std::runtime_error);
+    REQUIRE_THROWS_AS(ProgramOptions::parseFontInstances("wght=7x"), std::runtime_error);
+    REQUIRE_THROWS_AS(ProgramOptions::parseFontInstances("wght="), std::runtime_error);
+}
+
+TEST_CASE("parseFrequencyTable")
+{
+    const auto table = ProgramOptions::parseFrequencyTable("# char count\n101 1200\n\n0x74 900\nU+7684 4000\n  101   5\n");
+    REQUIRE((table == std::map<std::uint32_t, std::uint64_t>{{0x74, 900}, {101, 1205}, {0x7684, 4000}}));
+    REQUIRE(ProgramOptions::parseFrequencyTable("").empty());
+
+    REQUIRE_THROWS_AS(ProgramOptions::parseFrequencyTable("101"), std::runtime_error);
+    REQUIRE_THROWS_AS(ProgramOptions::parseFrequencyTable("101 5 7"), std::runtime_error);
+    REQUIRE_THROWS_AS(ProgramOptions::parseFrequencyTable("e 5"), std::runtime_error);
+    REQUIRE_THROWS_AS(ProgramOptions::parseFrequencyTable("101 -5"), std::runtime_error);
+    REQUIRE_THROWS_AS(ProgramOptions::parseFrequencyTable("0x110000 5"), std::runtime_error);
 }
 
 TEST_CASE("parseColor")
@@ -60,11 +112,11 @@ TEST_CASE("parseColor")
 TEST_CASE("parseCharsString")
 {
     REQUIRE((ProgramOptions::parseCharsString("").empty()));
-    REQUIRE((ProgramOptions::parseCharsString("0") == std::set<std::uint32_t>{0}));
-    REQUIRE((ProgramOptions::parseCharsString("42") == std::set<std::uint32_t>{42}));
-    REQUIRE((ProgramOptions::parseCharsString("0-1") == std::set<std::uint32_t>{0,1}));
-    REQUIRE((ProgramOptions::parseCharsString("1-3") == std::set<std::uint32_t>{1,2,3}));
-    REQUIRE((ProgramOptions::parseCharsString(" 1 - 3 ") == std::set<std::uint32_t>{1,2,3}));
+    REQUIRE((ProgramOptions::parseCharsString("0") == CharSet{0}));
+    REQUIRE((ProgramOptions::parseCharsString("42") == CharSet{42}));
+    REQUIRE((ProgramOptions::parseCharsString("0-1") == CharSet{0,1}));
+    REQUIRE((ProgramOptions::parseCharsString("1-3") == CharSet{1,2,3}));
+    REQUIRE((ProgramOptions::parseCharsString(" 1 - 3 ") == CharSet{1,2,3}));
 
     REQUIRE_THROWS_AS(ProgramOptions::parseCharsString("foo"), std::logic_error);
     REQUIRE_THROWS_AS(ProgramOptions::parseCharsString("-1"), std::logic_error);
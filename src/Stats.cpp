@@ -0,0 +1,208 @@
+#include "Stats.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include "utils/JsonWriter.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+void Stats::ScopedPhase::stop()
+{
+    if (stopped)
+        return;
+    stopped = true;
+    const auto wall = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - wallStart).count();
+    const auto cpu = static_cast<double>(std::clock() - cpuStart) * 1000000.0 / CLOCKS_PER_SEC;
+    stats.addPhaseTime(name, static_cast<std::uint64_t>(wall), static_cast<std::uint64_t>(cpu));
+}
+
+void Stats::addPhaseTime(const std::string& name, const std::uint64_t wallUs, const std::uint64_t cpuUs)
+{
+    for (auto& p : phases)
+    {
+        if (p.name == name)
+        {
+            p.wallUs += wallUs;
+            p.cpuUs += cpuUs;
+            ++p.calls;
+            return;
+        }
+    }
+    phases.push_back({name, wallUs, cpuUs, 1});
+}
+
+void Stats::addCounter(const std::string& name, const std::uint64_t value)
+{
+    for (auto& c : counters)
+    {
+        if (c.first == name)
+        {
+            c.second += value;
+            return;
+        }
+    }
+    counters.emplace_back(name, value);
+}
+
+void Stats::addPage(const PageUsage& page)
+{
+    pages.push_back(page);
+}
+
+void Stats::addFile(const std::string& fileName)
+{
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(fileName, ec);
+    files.push_back({fileName, ec ? 0 : static_cast<std::uint64_t>(size)});
+}
+
+void Stats::merge(const Stats& other)
+{
+    for (const auto& p : other.phases)
+    {
+        const auto mine = std::find_if(phases.begin(), phases.end(), [&](const PhaseTime& t) { return t.name == p.name; });
+        if (mine == phases.end())
+        {
+            phases.push_back(p);
+            continue;
+        }
+        mine->wallUs += p.wallUs;
+        mine->cpuUs += p.cpuUs;
+        mine->calls += p.calls;
+    }
+    for (const auto& c : other.counters)
+        addCounter(c.first, c.second);
+    pages.insert(pages.end(), other.pages.begin(), other.pages.end());
+    files.insert(files.end(), other.files.begin(), other.files.end());
+}
+
+std::uint64_t Stats::getCounter(const std::string& name) const
+{
+    for (const auto& c : counters)
+        if (c.first == name)
+            return c.second;
+    return 0;
+}
+
+std::uint64_t Stats::getPeakRss()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return static_cast<std::uint64_t>(pmc.PeakWorkingSetSize);
+    return 0;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage))
+        return 0;
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss);         // bytes
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024u; // kilobytes
+#endif
+#endif
+}
+
+void Stats::print(std::ostream& os) const
+{
+    const auto flags = os.flags();
+    os << std::fixed << std::setprecision(2);
+
+    os << "stats:\n";
+    os << "  " << std::left << std::setw(24) << "phase" << std::right << std::setw(12) << "wall ms" << std::setw(12) << "cpu ms" << "\n";
+    std::uint64_t totalWall = 0;
+    std::uint64_t totalCpu = 0;
+    for (const auto& p : phases)
+    {
+        os << "  " << std::left << std::setw(24) << p.name << std::right
+           << std::setw(12) << static_cast<double>(p.wallUs) / 1000.0
+           << std::setw(12) << static_cast<double>(p.cpuUs) / 1000.0 << "\n";
+        totalWall += p.wallUs;
+        totalCpu += p.cpuUs;
+    }
+    os << "  " << std::left << std::setw(24) << "total" << std::right
+       << std::setw(12) << static_cast<double>(totalWall) / 1000.0
+       << std::setw(12) << static_cast<double>(totalCpu) / 1000.0 << "\n";
+
+    for (const auto& c : counters)
+        os << "  " << c.first << ": " << c.second << "\n";
+
+    for (size_t i = 0; i < pages.size(); ++i)
+    {
+        const auto& p = pages[i];
+        const auto area = static_cast<double>(p.w) * p.h;
+        os << "  page " << i << ": " << p.w << "x" << p.h << ", " << p.glyphs << " glyphs, "
+           << (area > 0 ? 100.0 * static_cast<double>(p.usedArea) / area : 0.0) << "% used\n";
+    }
+
+    for (const auto& f : files)
+        os << "  file " << f.name << ": " << f.bytes << " bytes\n";
+
+    os << "  peak rss: " << getPeakRss() / 1024u << " KiB\n";
+
+    os.flags(flags);
+}
+
+void Stats::writeToJsonFile(const std::string& fileName) const
+{
+    std::ofstream f(fileName);
+    if (!f)
+        throw std::runtime_error("can't open stats file " + fileName);
+    JsonWriter j(f);
+
+    j.beginObject();
+
+    j.key("phases");
+    j.beginArray();
+    for (const auto& p : phases)
+    {
+        j.beginObject();
+        j.field("name", p.name)
+            .field("wallUs", p.wallUs)
+            .field("cpuUs", p.cpuUs)
+            .field("calls", p.calls);
+        j.endObject();
+    }
+    j.endArray();
+
+    j.key("counters");
+    j.beginObject();
+    for (const auto& c : counters)
+        j.field(c.first, c.second);
+    j.endObject();
+
+    j.key("pages");
+    j.beginArray();
+    for (const auto& p : pages)
+    {
+        j.beginObject();
+        j.field("w", p.w)
+            .field("h", p.h)
+            .field("glyphs", p.glyphs)
+            .field("usedArea", p.usedArea);
+        j.endObject();
+    }
+    j.endArray();
+
+    j.key("files");
+    j.beginArray();
+    for (const auto& file : files)
+    {
+        j.beginObject();
+        j.field("name", file.name)
+            .field("bytes", file.bytes);
+        j.endObject();
+    }
+    j.endArray();
+
+    j.field("peakRss", getPeakRss());
+
+    j.endObject();
+    f << "\n";
+}
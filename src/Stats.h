@@ -0,0 +1,97 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Timing and counters of the generation phases (--stats, --stats-json).
+class Stats
+{
+public:
+    struct PhaseTime
+    {
+        std::string name;
+        std::uint64_t wallUs = 0;
+        std::uint64_t cpuUs = 0;
+        std::uint32_t calls = 0;
+    };
+
+    struct PageUsage
+    {
+        std::uint32_t w = 0;
+        std::uint32_t h = 0;
+        std::uint32_t glyphs = 0;
+        std::uint64_t usedArea = 0; // glyph rectangles including padding, spacing and alignment
+    };
+
+    struct File
+    {
+        std::string name;
+        std::uint64_t bytes = 0;
+    };
+
+    // Measures the time between construction and stop() (or destruction), repeated phases with the same name are accumulated.
+    class ScopedPhase
+    {
+    public:
+        ScopedPhase(Stats& stats, std::string name)
+            : stats(stats), name(std::move(name)), wallStart(std::chrono::steady_clock::now()), cpuStart(std::clock()) {}
+        ~ScopedPhase()
+        {
+            stop();
+        }
+
+        void stop();
+
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator = (const ScopedPhase&) = delete;
+
+    private:
+        Stats& stats;
+        std::string name;
+        std::chrono::steady_clock::time_point wallStart;
+        std::clock_t cpuStart;
+        bool stopped = false;
+    };
+
+    ScopedPhase phase(const std::string& name)
+    {
+        return ScopedPhase(*this, name);
+    }
+
+    void addPhaseTime(const std::string& name, std::uint64_t wallUs, std::uint64_t cpuUs);
+    void addCounter(const std::string& name, std::uint64_t value);
+    void addPage(const PageUsage& page);
+    void addFile(const std::string& fileName);
+    // Adds the phases, counters, pages and files of another run (parallel jobs with their own stats).
+    void merge(const Stats& other);
+
+    std::uint64_t getCounter(const std::string& name) const;
+    const std::vector<PhaseTime>& getPhases() const
+    {
+        return phases;
+    }
+    const std::vector<PageUsage>& getPages() const
+    {
+        return pages;
+    }
+    const std::vector<File>& getFiles() const
+    {
+        return files;
+    }
+
+    // Peak resident set size of the process in bytes (0 if unknown).
+    static std::uint64_t getPeakRss();
+
+    void print(std::ostream& os) const;
+    void writeToJsonFile(const std::string& fileName) const;
+
+private:
+    std::vector<PhaseTime> phases;
+    std::vector<std::pair<std::string, std::uint64_t>> counters;
+    std::vector<PageUsage> pages;
+    std::vector<File> files;
+};
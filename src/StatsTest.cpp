@@ -0,0 +1,47 @@
+#include "external/catch.hpp"
+#include "Stats.h"
+
+TEST_CASE("Stats")
+{
+    Stats stats;
+    stats.addPhaseTime("render", 10, 5);
+    stats.addPhaseTime("encode", 1, 1);
+    stats.addPhaseTime("render", 20, 15);
+    REQUIRE(stats.getPhases().size() == 2);
+    REQUIRE(stats.getPhases()[0].name == "render");
+    REQUIRE(stats.getPhases()[0].wallUs == 30);
+    REQUIRE(stats.getPhases()[0].cpuUs == 20);
+    REQUIRE(stats.getPhases()[0].calls == 2);
+
+    {
+        auto phase = stats.phase("scoped");
+        phase.stop();
+        phase.stop();
+    }
+    REQUIRE(stats.getPhases().size() == 3);
+    REQUIRE(stats.getPhases()[2].calls == 1);
+
+    stats.addCounter("glyphs", 3);
+    stats.addCounter("glyphs", 4);
+    REQUIRE(stats.getCounter("glyphs") == 7);
+    REQUIRE(stats.getCounter("unknown") == 0);
+
+    stats.addFile("file/that/does/not/exist");
+    REQUIRE(stats.getFiles().size() == 1);
+    REQUIRE(stats.getFiles()[0].bytes == 0);
+
+    Stats other;
+    other.addPhaseTime("render", 5, 5);
+    other.addPhaseTime("render", 5, 5);
+    other.addPhaseTime("faces", 7, 3);
+    other.addCounter("glyphs", 3);
+    other.addPage(Stats::PageUsage{});
+    stats.merge(other);
+    REQUIRE(stats.getPhases()[0].wallUs == 40);
+    REQUIRE(stats.getPhases()[0].calls == 4);
+    REQUIRE(stats.getPhases().back().name == "faces");
+    REQUIRE(stats.getPhases().back().calls == 1);
+    REQUIRE(stats.getCounter("glyphs") == 10);
+    REQUIRE(stats.getPages().size() == 1);
+    REQUIRE(stats.getFiles().size() == 1);
+}
@@ -0,0 +1,615 @@
+#include "TextureFile.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include "BlockCompressor.h"
+#include "Mipmaps.h"
+#include "external/lodepng/lodepng.h"
+
+#ifdef FONTBM_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef FONTBM_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+void putU32(std::vector<std::uint8_t>& out, const std::uint32_t value)
+{
+    for (unsigned i = 0; i < 4; ++i)
+        out.push_back(static_cast<std::uint8_t>(value >> (8u * i)));
+}
+
+void putU64(std::vector<std::uint8_t>& out, const std::uint64_t value)
+{
+    putU32(out, static_cast<std::uint32_t>(value));
+    putU32(out, static_cast<std::uint32_t>(value >> 32u));
+}
+
+void putU32BigEndian(std::vector<std::uint8_t>& out, const std::uint32_t value)
+{
+    for (unsigned i = 4; i > 0; --i)
+        out.push_back(static_cast<std::uint8_t>(value >> (8u * (i - 1))));
+}
+
+void pad(std::vector<std::uint8_t>& out, const std::size_t alignment)
+{
+    while (out.size() % alignment)
+        out.push_back(0);
+}
+
+// Khronos data format descriptor sample
+struct DfdSample
+{
+    std::uint8_t channel;
+    std::uint32_t bitOffset;
+    std::uint32_t bitLength;
+    std::uint32_t lower;
+    std::uint32_t upper;
+};
+
+struct TexelFormat
+{
+    std::uint32_t vkFormat;
+    std::uint8_t colorModel;
+    bool block; // 4x4 texel blocks
+    std::vector<DfdSample> samples;
+};
+
+TexelFormat getTexelFormat(const Config& config, const bool hasAlpha)
+{
+    const std::uint32_t any = 0xFFFFFFFFu;
+    switch (config.textureCompression)
+    {
+    case Config::TextureCompression::None:
+        if (config.textureChannels == Config::TextureChannels::Alpha)
+            return {9 /* VK_FORMAT_R8_UNORM */, 1 /* RGBSDA */, false, {{0, 0, 8, 0, 255}}};
+        return {37 /* VK_FORMAT_R8G8B8A8_UNORM */, 1 /* RGBSDA */, false,
+                {{0, 0, 8, 0, 255}, {1, 8, 8, 0, 255}, {2, 16, 8, 0, 255}, {15, 24, 8, 0, 255}}};
+    case Config::TextureCompression::Bc4:
+        return {139 /* VK_FORMAT_BC4_UNORM_BLOCK */, 131 /* BC4 */, true, {{0, 0, 64, 0, any}}};
+    case Config::TextureCompression::Bc7:
+        return {145 /* VK_FORMAT_BC7_UNORM_BLOCK */, 134 /* BC7 */, true, {{0, 0, 128, 0, any}}};
+    case Config::TextureCompression::Etc2:
+        if (hasAlpha)
+            return {151 /* VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK */, 161 /* ETC2 */, true, {{15, 0, 64, 0, any}, {2, 64, 64, 0, any}}};
+        return {147 /* VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK */, 161 /* ETC2 */, true, {{2, 0, 64, 0, any}}};
+    case Config::TextureCompression::Eac:
+        return {153 /* VK_FORMAT_EAC_R11_UNORM_BLOCK */, 161 /* ETC2 */, true, {{0, 0, 64, 0, any}}};
+    }
+    throw std::logic_error("unknown texture compression");
+}
+
+// Bytes per texel, or per block of block compressed formats
+std::size_t getTexelBytes(const Config& config, const bool hasAlpha)
+{
+    if (config.textureCompression != Config::TextureCompression::None)
+        return BlockCompressor::getBlockBytes(config.textureCompression, hasAlpha);
+    return config.textureChannels == Config::TextureChannels::Alpha ? 1 : 4;
+}
+
+std::uint32_t getDxgiFormat(const Config& config)
+{
+    switch (config.textureCompression)
+    {
+    case Config::TextureCompression::None:
+        return config.textureChannels == Config::TextureChannels::Alpha ? 61 /* DXGI_FORMAT_R8_UNORM */ : 28 /* DXGI_FORMAT_R8G8B8A8_UNORM */;
+    case Config::TextureCompression::Bc4:
+        return 80; // DXGI_FORMAT_BC4_UNORM
+    case Config::TextureCompression::Bc7:
+        return 98; // DXGI_FORMAT_BC7_UNORM
+    case Config::TextureCompression::Etc2:
+    case Config::TextureCompression::Eac:
+        break;
+    }
+    throw std::runtime_error("etc2 and eac compression need --texture-format ktx2");
+}
+
+std::vector<std::uint8_t> compressZstd(const std::vector<std::uint8_t>& data)
+{
+#ifdef FONTBM_WITH_ZSTD
+    std::vector<std::uint8_t> result(ZSTD_compressBound(data.size()));
+    const auto size = ZSTD_compress(result.data(), result.size(), data.data(), data.size(), 19);
+    if (ZSTD_isError(size))
+        throw std::runtime_error(std::string("zstd compression error: ") + ZSTD_getErrorName(size));
+    result.resize(size);
+    return result;
+#else
+    static_cast<void>(data);
+    throw std::runtime_error("fontbm was built without zstd");
+#endif
+}
+
+}
+
+std::string TextureFile::getExtension(const Config::TextureFormat format)
+{
+    switch (format)
+    {
+    case Config::TextureFormat::Png:
+        return "png";
+    case Config::TextureFormat::Dds:
+        return "dds";
+    case Config::TextureFormat::Ktx2:
+        return "ktx2";
+    case Config::TextureFormat::Raw:
+        return "raw";
+    }
+    throw std::logic_error("unknown texture format");
+}
+
+std::vector<std::uint8_t> TextureFile::encodePng(const std::uint32_t* pixels, const std::uint32_t w, const std::uint32_t h, const bool hasAlpha)
+{
+    std::vector<std::uint8_t> png;
+    lodepng::State state;
+
+    state.encoder.add_id = 0; // Don't add LodePNG version chunk to save more bytes
+    state.encoder.auto_convert = 0;
+    state.info_png.color.colortype = hasAlpha ? LCT_RGBA : LCT_RGB;
+    state.encoder.zlibsettings.windowsize = 32768; // Use maximum possible window size for best compression
+
+    const auto error = lodepng::encode(png, reinterpret_cast<const unsigned char*>(pixels), w, h, state);
+    if (error)
+        throw std::runtime_error("png encoder error " + std::to_string(error) + ": " + lodepng_error_text(error));
+
+    return png;
+}
+
+std::vector<std::uint8_t> TextureFile::encode(const std::uint32_t* pixels, const std::uint32_t w, const std::uint32_t h, const bool hasAlpha,
+                                              const Config& config)
+{
+    switch (config.textureFormat)
+    {
+    case Config::TextureFormat::Png:
+        return encodePng(pixels, w, h, hasAlpha);
+    case Config::TextureFormat::Dds:
+        return encodeDds({encodeLevels(pixels, w, h, hasAlpha, config)}, hasAlpha, false, config);
+    case Config::TextureFormat::Ktx2:
+        return encodeKtx2({encodeLevels(pixels, w, h, hasAlpha, config)}, hasAlpha, false, config);
+    case Config::TextureFormat::Raw:
+        return encodeRaw(encodeLevels(pixels, w, h, hasAlpha, config).front(), hasAlpha, config);
+    }
+    throw std::logic_error("unknown texture format");
+}
+
+std::vector<std::uint8_t> TextureFile::encodeArray(const std::vector<const std::uint32_t*>& layers, const std::uint32_t w, const std::uint32_t h,
+                                                   const bool hasAlpha, const Config& config)
+{
+    std::vector<std::vector<Level>> levels;
+    for (const auto layer : layers)
+        levels.push_back(encodeLevels(layer, w, h, hasAlpha, config));
+
+    switch (config.textureFormat)
+    {
+    case Config::TextureFormat::Dds:
+        return encodeDds(levels, hasAlpha, true, config);
+    case Config::TextureFormat::Ktx2:
+        return encodeKtx2(levels, hasAlpha, true, config);
+    case Config::TextureFormat::Png:
+    case Config::TextureFormat::Raw:
+        break;
+    }
+    throw std::runtime_error("texture arrays need --texture-format dds or ktx2");
+}
+
+void TextureFile::save(const std::string& fileName, const std::uint32_t* pixels, const std::uint32_t w, const std::uint32_t h, const bool hasAlpha,
+                       const Config& config)
+{
+    write(fileName, encode(pixels, w, h, hasAlpha, config));
+}
+
+void TextureFile::saveArray(const std::string& fileName, const std::vector<const std::uint32_t*>& layers, const std::uint32_t w, const std::uint32_t h,
+                            const bool hasAlpha, const Config& config)
+{
+    write(fileName, encodeArray(layers, w, h, hasAlpha, config));
+}
+
+void TextureFile::write(const std::string& fileName, const std::vector<std::uint8_t>& content)
+{
+    std::ofstream f(fileName, std::ios::binary);
+    f.write(reinterpret_cast<const char*>(content.data()), static_cast<std::streamsize>(content.size()));
+    if (!f)
+        throw std::runtime_error("can't write texture file " + fileName);
+}
+
+std::vector<TextureFile::Level> TextureFile::encodeLevels(const std::uint32_t* pixels, std::uint32_t w, std::uint32_t h, const bool hasAlpha,
+                                                          const Config& config)
+{
+    std::vector<Level> levels;
+    std::vector<std::uint32_t> image(pixels, pixels + static_cast<std::size_t>(w) * h);
+    for (std::uint32_t i = 0; ; ++i)
+    {
+        Level level;
+        level.w = w;
+        level.h = h;
+        if (config.textureCompression != Config::TextureCompression::None)
+        {
+            // Levels smaller than a block are padded by repeating their last row and column
+            const auto dim = BlockCompressor::blockDim;
+            const auto paddedW = (w + dim - 1) / dim * dim;
+            const auto paddedH = (h + dim - 1) / dim * dim;
+            std::vector<std::uint32_t> padded;
+            if (paddedW != w || paddedH != h)
+            {
+                padded.resize(static_cast<std::size_t>(paddedW) * paddedH);
+                for (std::uint32_t y = 0; y < paddedH; ++y)
+                    for (std::uint32_t x = 0; x < paddedW; ++x)
+                        padded[static_cast<std::size_t>(y) * paddedW + x] = image[static_cast<std::size_t>(std::min(y, h - 1)) * w + std::min(x, w - 1)];
+            }
+            level.data = BlockCompressor::compress(padded.empty() ? image.data() : padded.data(), paddedW, paddedH, config.textureCompression, hasAlpha);
+        }
+        else if (config.textureChannels == Config::TextureChannels::Alpha)
+        {
+            level.data.reserve(image.size());
+            for (const auto texel : image)
+                level.data.push_back(static_cast<std::uint8_t>(texel >> 24u));
+        }
+        else
+        {
+            level.data.reserve(image.size() * 4);
+            for (const auto texel : image)
+                putU32(level.data, hasAlpha ? texel : texel | 0xFF000000u);
+        }
+        levels.push_back(std::move(level));
+
+        // Raw files hold a single level (with --mipmap-layout the levels may only drive the layout)
+        if (i == config.mipmapLevels || (w == 1 && h == 1) || config.textureFormat == Config::TextureFormat::Raw)
+            break;
+        image = Mipmaps::downsample(image, w, h, config.mipmapFilter);
+        w = std::max(w / 2, 1u);
+        h = std::max(h / 2, 1u);
+    }
+    return levels;
+}
+
+// Layers (array slices) are stored one after the other, each with all its levels.
+std::vector<std::uint8_t> TextureFile::encodeDds(const std::vector<std::vector<Level>>& layers, const bool hasAlpha, const bool array, const Config& config)
+{
+    if (config.textureSupercompression != Config::TextureSupercompression::None)
+        throw std::runtime_error("supercompression needs --texture-format ktx2");
+    const auto compressed = config.textureCompression != Config::TextureCompression::None;
+    const auto& levels = layers.front();
+    const auto& top = levels.front();
+    const auto mipmaps = levels.size() > 1;
+
+    std::vector<std::uint8_t> out = {'D', 'D', 'S', ' '};
+    putU32(out, 124); // header size
+    // caps, height, width, pixel format, linear size or pitch, mip map count
+    putU32(out, 0x1u | 0x2u | 0x4u | 0x1000u | (compressed ? 0x80000u : 0x8u) | (mipmaps ? 0x20000u : 0u));
+    putU32(out, top.h);
+    putU32(out, top.w);
+    putU32(out, compressed ? static_cast<std::uint32_t>(top.data.size()) : top.w * static_cast<std::uint32_t>(getTexelBytes(config, hasAlpha)));
+    putU32(out, 0); // depth
+    putU32(out, mipmaps ? static_cast<std::uint32_t>(levels.size()) : 0);
+    for (int i = 0; i < 11; ++i)
+        putU32(out, 0);
+    // Pixel format: described by the DX10 header
+    putU32(out, 32);
+    putU32(out, 0x4u); // DDPF_FOURCC
+    out.insert(out.end(), {'D', 'X', '1', '0'});
+    for (int i = 0; i < 5; ++i)
+        putU32(out, 0);
+    putU32(out, 0x1000u | (mipmaps ? 0x8u | 0x400000u : 0u)); // DDSCAPS_TEXTURE, DDSCAPS_COMPLEX | DDSCAPS_MIPMAP
+    for (int i = 0; i < 4; ++i)
+        putU32(out, 0);
+
+    putU32(out, getDxgiFormat(config));
+    putU32(out, 3); // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+    putU32(out, 0);
+    putU32(out, array ? static_cast<std::uint32_t>(layers.size()) : 1); // array size
+    putU32(out, hasAlpha ? 1 : 3); // DDS_ALPHA_MODE_STRAIGHT or DDS_ALPHA_MODE_OPAQUE
+
+    for (const auto& layer : layers)
+        for (const auto& level : layer)
+            out.insert(out.end(), level.data.begin(), level.data.end());
+    return out;
+}
+
+// Each level holds the texels of all layers, one layer after the other.
+std::vector<std::uint8_t> TextureFile::encodeKtx2(const std::vector<std::vector<Level>>& layers, const bool hasAlpha, const bool array, const Config& config)
+{
+    const auto format = getTexelFormat(config, hasAlpha);
+    const auto texelBytes = getTexelBytes(config, hasAlpha);
+    const auto supercompressed = config.textureSupercompression != Config::TextureSupercompression::None;
+
+    const auto levelCount = static_cast<std::uint32_t>(layers.front().size());
+    std::vector<std::vector<std::uint8_t>> levels(levelCount);
+    std::vector<std::size_t> uncompressedSizes(levelCount);
+    for (std::size_t i = 0; i < levelCount; ++i)
+    {
+        for (const auto& layer : layers)
+            levels[i].insert(levels[i].end(), layer[i].data.begin(), layer[i].data.end());
+        uncompressedSizes[i] = levels[i].size();
+        if (supercompressed)
+            levels[i] = compressZstd(levels[i]);
+    }
+
+    std::vector<std::uint8_t> dfd;
+    putU32(dfd, 0); // total size, set below
+    putU32(dfd, 0); // vendor khronos, basic descriptor type
+    putU32(dfd, 2u | ((24u + 16u * static_cast<std::uint32_t>(format.samples.size())) << 16u)); // version, block size
+    putU32(dfd, format.colorModel | (1u << 8u) | (1u << 16u)); // BT.709 primaries, linear transfer, straight alpha
+    putU32(dfd, format.block ? 0x0303u : 0u); // texel block dimensions - 1
+    putU32(dfd, supercompressed ? 0u : static_cast<std::uint32_t>(texelBytes)); // bytes plane 0 (unsized when supercompressed)
+    putU32(dfd, 0);
+    for (const auto& sample : format.samples)
+    {
+        putU32(dfd, sample.bitOffset | ((sample.bitLength - 1) << 16u) | (static_cast<std::uint32_t>(sample.channel) << 24u));
+        putU32(dfd, 0); // sample position
+        putU32(dfd, sample.lower);
+        putU32(dfd, sample.upper);
+    }
+    const auto dfdSize = static_cast<std::uint32_t>(dfd.size());
+    for (unsigned i = 0; i < 4; ++i)
+        dfd[i] = static_cast<std::uint8_t>(dfdSize >> (8u * i));
+
+    // Key and value of the single entry, each null terminated
+    const char writerEntry[] = "KTXwriter\0fontbm";
+    std::vector<std::uint8_t> kvd;
+    kvd.reserve(4 + sizeof(writerEntry) + 3);
+    putU32(kvd, static_cast<std::uint32_t>(sizeof(writerEntry)));
+    for (const auto c : writerEntry)
+        kvd.push_back(static_cast<std::uint8_t>(c));
+    pad(kvd, 4);
+
+    const std::uint32_t headerSize = 80;
+    const auto dfdOffset = headerSize + 24 * levelCount;
+    const auto kvdOffset = dfdOffset + dfdSize;
+    // Levels start at multiples of lcm(texel block size, 4) and are stored from the smallest one
+    const std::size_t levelAlignment = supercompressed ? 1 : (texelBytes % 4 ? texelBytes * (texelBytes % 2 ? 4 : 2) : texelBytes);
+    std::vector<std::size_t> levelOffsets(levels.size());
+    auto offset = static_cast<std::size_t>(kvdOffset + kvd.size());
+    for (auto i = levels.size(); i-- > 0;)
+    {
+        offset = (offset + levelAlignment - 1) / levelAlignment * levelAlignment;
+        levelOffsets[i] = offset;
+        offset += levels[i].size();
+    }
+
+    std::vector<std::uint8_t> out = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+    putU32(out, format.vkFormat);
+    putU32(out, 1); // type size
+    putU32(out, layers.front().front().w);
+    putU32(out, layers.front().front().h);
+    putU32(out, 0); // depth
+    putU32(out, array ? static_cast<std::uint32_t>(layers.size()) : 0); // layer count
+    putU32(out, 1); // face count
+    putU32(out, levelCount);
+    putU32(out, supercompressed ? 2 : 0); // zstd
+    putU32(out, dfdOffset);
+    putU32(out, dfdSize);
+    putU32(out, kvdOffset);
+    putU32(out, static_cast<std::uint32_t>(kvd.size()));
+    putU64(out, 0); // no supercompression global data
+    putU64(out, 0);
+
+    for (std::size_t i = 0; i < levels.size(); ++i)
+    {
+        putU64(out, levelOffsets[i]);
+        putU64(out, levels[i].size());
+        putU64(out, uncompressedSizes[i]);
+    }
+
+    out.insert(out.end(), dfd.begin(), dfd.end());
+    out.insert(out.end(), kvd.begin(), kvd.end());
+    for (auto i = levels.size(); i-- > 0;)
+    {
+        out.resize(levelOffsets[i], 0);
+        out.insert(out.end(), levels[i].begin(), levels[i].end());
+    }
+    return out;
+}
+
+std::vector<std::uint8_t> TextureFile::encodeRaw(const Level& level, const bool hasAlpha, const Config& config)
+{
+    std::vector<std::uint8_t> out = {'F', 'B', 'M', 'T'};
+    putU32(out, level.w);
+    putU32(out, level.h);
+    putU32(out, getTexelFormat(config, hasAlpha).vkFormat);
+    out.insert(out.end(), level.data.begin(), level.data.end());
+    return out;
+}
+
+#ifdef FONTBM_WITH_ZLIB
+struct TextureFile::StripWriter::Deflater
+{
+    z_stream stream{};
+};
+#else
+struct TextureFile::StripWriter::Deflater
+{
+};
+#endif
+
+TextureFile::StripWriter::StripWriter(const std::string& fileName, const std::uint32_t w, const std::uint32_t h, const bool hasAlpha,
+                                      const Config& config)
+    : file(fileName, std::ios::binary), fileName(fileName), w(w), h(h), hasAlpha(hasAlpha), config(config)
+{
+    if (!file)
+        throw std::runtime_error("can't write texture file " + fileName);
+
+    std::vector<std::uint8_t> header;
+    switch (config.textureFormat)
+    {
+    case Config::TextureFormat::Png:
+    {
+#ifdef FONTBM_WITH_ZLIB
+        deflater = std::make_unique<Deflater>();
+        if (deflateInit(&deflater->stream, Z_DEFAULT_COMPRESSION) != Z_OK)
+        {
+            deflater.reset();
+            throw std::runtime_error("zlib deflate init error");
+        }
+        header = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+        std::vector<std::uint8_t> ihdr;
+        putU32BigEndian(ihdr, w);
+        putU32BigEndian(ihdr, h);
+        ihdr.push_back(8); // bit depth
+        ihdr.push_back(hasAlpha ? 6 : 2); // RGBA or RGB
+        ihdr.push_back(0); // deflate
+        ihdr.push_back(0); // adaptive filtering
+        ihdr.push_back(0); // no interlace
+        writePngChunk("IHDR", ihdr.data(), ihdr.size());
+        previousRow.assign(static_cast<std::size_t>(w) * (hasAlpha ? 4 : 3), 0);
+        return;
+#else
+        throw std::runtime_error("fontbm was built without zlib, png pages can not be written strip by strip");
+#endif
+    }
+    case Config::TextureFormat::Raw:
+        header = {'F', 'B', 'M', 'T'};
+        putU32(header, w);
+        putU32(header, h);
+        putU32(header, getTexelFormat(config, hasAlpha).vkFormat);
+        file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+        return;
+    case Config::TextureFormat::Dds:
+    case Config::TextureFormat::Ktx2:
+        break;
+    }
+    throw std::runtime_error("pages can be written strip by strip in png and raw formats only");
+}
+
+TextureFile::StripWriter::~StripWriter()
+{
+#ifdef FONTBM_WITH_ZLIB
+    if (deflater)
+        deflateEnd(&deflater->stream);
+#endif
+}
+
+void TextureFile::StripWriter::write(const std::uint32_t* pixels, const std::uint32_t rows)
+{
+    if (writtenRows + rows > h)
+        throw std::logic_error("strip below the page");
+    if (config.textureFormat == Config::TextureFormat::Png)
+        writePngRows(pixels, rows);
+    else
+    {
+        // Only the bottom strip may end inside a block row, it is padded like whole pages
+        if (config.textureCompression != Config::TextureCompression::None && rows % BlockCompressor::blockDim && writtenRows + rows < h)
+            throw std::logic_error("strip of block compressed texels ends inside a block row");
+        const auto level = encodeLevels(pixels, w, rows, hasAlpha, config).front();
+        file.write(reinterpret_cast<const char*>(level.data.data()), static_cast<std::streamsize>(level.data.size()));
+    }
+    writtenRows += rows;
+}
+
+void TextureFile::StripWriter::finish()
+{
+    if (writtenRows != h)
+        throw std::logic_error("page file finished before its last row");
+    if (config.textureFormat == Config::TextureFormat::Png)
+    {
+        compress(nullptr, 0, true);
+        writePngChunk("IEND", nullptr, 0);
+    }
+    file.close();
+    if (!file)
+        throw std::runtime_error("can't write texture file " + fileName);
+}
+
+// Each row gets the filter with the smallest sum of absolute (signed) filtered bytes, the minimum sum heuristic of lodepng.
+void TextureFile::StripWriter::writePngRows(const std::uint32_t* pixels, const std::uint32_t rows)
+{
+    const std::size_t bpp = hasAlpha ? 4 : 3;
+    const auto rowBytes = static_cast<std::size_t>(w) * bpp;
+    std::vector<std::uint8_t> row(rowBytes);
+    std::vector<std::uint8_t> filtered(rowBytes + 1);
+    std::vector<std::uint8_t> best(rowBytes + 1);
+    std::vector<std::uint8_t> out;
+    out.reserve((rowBytes + 1) * rows);
+    for (std::uint32_t r = 0; r < rows; ++r)
+    {
+        const auto src = pixels + static_cast<std::size_t>(r) * w;
+        for (std::uint32_t x = 0; x < w; ++x)
+            for (std::size_t c = 0; c < bpp; ++c)
+                row[x * bpp + c] = static_cast<std::uint8_t>(src[x] >> (8u * c));
+
+        std::uint64_t bestSum = std::numeric_limits<std::uint64_t>::max();
+        for (std::uint8_t type = 0; type < 5; ++type)
+        {
+            filtered[0] = type;
+            std::uint64_t sum = 0;
+            for (std::size_t i = 0; i < rowBytes; ++i)
+            {
+                const int left = i >= bpp ? row[i - bpp] : 0;
+                const int up = previousRow[i];
+                const int upLeft = i >= bpp ? previousRow[i - bpp] : 0;
+                int predictor = 0;
+                if (type == 1)
+                    predictor = left;
+                else if (type == 2)
+                    predictor = up;
+                else if (type == 3)
+                    predictor = (left + up) / 2;
+                else if (type == 4)
+                {
+                    const auto p = left + up - upLeft;
+                    const auto pa = std::abs(p - left);
+                    const auto pb = std::abs(p - up);
+                    const auto pc = std::abs(p - upLeft);
+                    predictor = pa <= pb && pa <= pc ? left : (pb <= pc ? up : upLeft);
+                }
+                const auto value = static_cast<std::uint8_t>(row[i] - predictor);
+                filtered[i + 1] = value;
+                sum += value < 128 ? value : 256u - value;
+            }
+            if (sum < bestSum)
+            {
+                bestSum = sum;
+                best.swap(filtered);
+            }
+        }
+        out.insert(out.end(), best.begin(), best.end());
+        previousRow.swap(row);
+    }
+    compress(out.data(), out.size(), false);
+}
+
+void TextureFile::StripWriter::writePngChunk(const char* type, const std::uint8_t* data, const std::size_t size)
+{
+    std::vector<std::uint8_t> chunk;
+    putU32BigEndian(chunk, static_cast<std::uint32_t>(size));
+    chunk.insert(chunk.end(), type, type + 4);
+    if (size)
+        chunk.insert(chunk.end(), data, data + size);
+#ifdef FONTBM_WITH_ZLIB
+    const auto crc = crc32(0, chunk.data() + 4, static_cast<uInt>(chunk.size() - 4));
+    putU32BigEndian(chunk, static_cast<std::uint32_t>(crc));
+#endif
+    file.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+}
+
+// Deflates into IDAT chunks of up to 64 KiB.
+void TextureFile::StripWriter::compress(const std::uint8_t* data, const std::size_t size, const bool last)
+{
+#ifdef FONTBM_WITH_ZLIB
+    auto& stream = deflater->stream;
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = static_cast<uInt>(size);
+    std::vector<std::uint8_t> out(1u << 16u);
+    for (;;)
+    {
+        stream.next_out = out.data();
+        stream.avail_out = static_cast<uInt>(out.size());
+        const auto result = deflate(&stream, last ? Z_FINISH : Z_NO_FLUSH);
+        if (result == Z_STREAM_ERROR)
+            throw std::runtime_error("zlib deflate error");
+        const auto produced = out.size() - stream.avail_out;
+        if (produced)
+            writePngChunk("IDAT", out.data(), produced);
+        if (last ? result == Z_STREAM_END : stream.avail_out != 0)
+            break;
+    }
+#else
+    static_cast<void>(data);
+    static_cast<void>(size);
+    static_cast<void>(last);
+#endif
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Config.h"
+
+// Page files in Config::textureFormat: PNG, DDS / KTX2 containers or raw dumps holding RGBA8, R8 (coverage) or block
+// compressed texels (Config::textureCompression) that can be mapped and uploaded to the GPU as they are.
+//
+// Raw files have a 16 byte header followed by the texels of the single level (rows or block rows, top to bottom):
+// "FBMT", then little-endian uint32 width, height and the VkFormat of the texels.
+class TextureFile
+{
+public:
+    // File name extension without the dot
+    static std::string getExtension(Config::TextureFormat format);
+
+    // File content of w * h RGBA8 pixels (R in the lowest byte), alpha is meaningful only when hasAlpha.
+    static std::vector<std::uint8_t> encode(const std::uint32_t* pixels, std::uint32_t w, std::uint32_t h, bool hasAlpha, const Config& config);
+
+    // PNG of w * h RGBA8 pixels (R in the lowest byte), RGB when not hasAlpha.
+    static std::vector<std::uint8_t> encodePng(const std::uint32_t* pixels, std::uint32_t w, std::uint32_t h, bool hasAlpha);
+
+    // Texture array (--texture-array) of equally sized layers, DDS or KTX2 only.
+    static std::vector<std::uint8_t> encodeArray(const std::vector<const std::uint32_t*>& layers, std::uint32_t w, std::uint32_t h, bool hasAlpha,
+                                                 const Config& config);
+
+    static void save(const std::string& fileName, const std::uint32_t* pixels, std::uint32_t w, std::uint32_t h, bool hasAlpha, const Config& config);
+    static void saveArray(const std::string& fileName, const std::vector<const std::uint32_t*>& layers, std::uint32_t w, std::uint32_t h, bool hasAlpha,
+                          const Config& config);
+
+    // Page file written strip by strip (--render-strip-height): rows are encoded as they come, the page is never
+    // held as a whole. PNG (needs zlib) and raw files only, strips of block compressed texels are whole block rows.
+    class StripWriter
+    {
+    public:
+        StripWriter(const std::string& fileName, std::uint32_t w, std::uint32_t h, bool hasAlpha, const Config& config);
+        ~StripWriter();
+        StripWriter(const StripWriter&) = delete;
+        StripWriter& operator = (const StripWriter&) = delete;
+
+        // Next rows of w RGBA8 pixels (R in the lowest byte), top to bottom.
+        void write(const std::uint32_t* pixels, std::uint32_t rows);
+        // Ends the file, all h rows must be written.
+        void finish();
+
+    private:
+        struct Deflater;
+
+        void writePngRows(const std::uint32_t* pixels, std::uint32_t rows);
+        void writePngChunk(const char* type, const std::uint8_t* data, std::size_t size);
+        void compress(const std::uint8_t* data, std::size_t size, bool last);
+
+        std::ofstream file;
+        std::string fileName;
+        std::uint32_t w;
+        std::uint32_t h;
+        bool hasAlpha;
+        const Config& config;
+        std::uint32_t writtenRows = 0;
+        std::vector<std::uint8_t> previousRow; // unfiltered, for the PNG filters
+        std::unique_ptr<Deflater> deflater;
+    };
+
+private:
+    struct Level
+    {
+        std::uint32_t w = 0;
+        std::uint32_t h = 0;
+        std::vector<std::uint8_t> data; // texels in the file format
+    };
+
+    static std::vector<Level> encodeLevels(const std::uint32_t* pixels, std::uint32_t w, std::uint32_t h, bool hasAlpha, const Config& config);
+    static std::vector<std::uint8_t> encodeDds(const std::vector<std::vector<Level>>& layers, bool hasAlpha, bool array, const Config& config);
+    static std::vector<std::uint8_t> encodeKtx2(const std::vector<std::vector<Level>>& layers, bool hasAlpha, bool array, const Config& config);
+    static std::vector<std::uint8_t> encodeRaw(const Level& level, bool hasAlpha, const Config& config);
+    static void write(const std::string& fileName, const std::vector<std::uint8_t>& content);
+};
@@ -0,0 +1,126 @@
+#include "external/catch.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "TextureFile.h"
+#include "external/lodepng/lodepng.h"
+
+namespace {
+
+std::vector<std::uint32_t> makePixels(const std::uint32_t w, const std::uint32_t h)
+{
+    // Smooth gradients and noise, so every PNG filter gets picked somewhere
+    std::vector<std::uint32_t> pixels(static_cast<std::size_t>(w) * h);
+    std::uint32_t seed = 12345;
+    for (std::uint32_t y = 0; y < h; ++y)
+        for (std::uint32_t x = 0; x < w; ++x)
+        {
+            seed = seed * 1103515245u + 12345u;
+            const auto noise = (seed >> 16u) & 0xFFu;
+            const auto r = (x * 7) & 0xFFu;
+            const auto g = (y * 11) & 0xFFu;
+            const auto b = x % 5 == 0 ? noise : (x + y) & 0xFFu;
+            const auto a = y % 3 == 0 ? noise : 0xFFu;
+            pixels[static_cast<std::size_t>(y) * w + x] = r | (g << 8u) | (b << 16u) | (a << 24u);
+        }
+    return pixels;
+}
+
+std::vector<std::uint8_t> writeInStrips(const std::string& path, const std::vector<std::uint32_t>& pixels, const std::uint32_t w, const std::uint32_t h,
+                                        const std::uint32_t stripHeight, const bool hasAlpha, const Config& config)
+{
+    {
+        TextureFile::StripWriter writer(path, w, h, hasAlpha, config);
+        for (std::uint32_t top = 0; top < h; top += stripHeight)
+            writer.write(pixels.data() + static_cast<std::size_t>(top) * w, std::min(stripHeight, h - top));
+        writer.finish();
+    }
+    std::ifstream f(path, std::ios::binary);
+    return std::vector<std::uint8_t>((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+}
+
+TEST_CASE("TextureFile::StripWriter")
+{
+    const auto path = (std::filesystem::temp_directory_path() / "fontbm_strip_writer_test.bin").string();
+
+#ifdef FONTBM_WITH_ZLIB
+    SECTION("png strips decode to the whole page")
+    {
+        const std::uint32_t w = 37;
+        const std::uint32_t h = 23;
+        const auto pixels = makePixels(w, h);
+        Config config;
+        config.textureFormat = Config::TextureFormat::Png;
+
+        for (const auto hasAlpha : {true, false})
+        {
+            const auto colorType = hasAlpha ? LCT_RGBA : LCT_RGB;
+            std::vector<std::uint8_t> expected;
+            unsigned expectedW = 0;
+            unsigned expectedH = 0;
+            REQUIRE(lodepng::decode(expected, expectedW, expectedH, TextureFile::encode(pixels.data(), w, h, hasAlpha, config), colorType) == 0);
+
+            for (const std::uint32_t stripHeight : {1u, 5u, 7u, 22u, 23u, 64u})
+            {
+                std::vector<std::uint8_t> decoded;
+                unsigned decodedW = 0;
+                unsigned decodedH = 0;
+                REQUIRE(lodepng::decode(decoded, decodedW, decodedH, writeInStrips(path, pixels, w, h, stripHeight, hasAlpha, config), colorType) == 0);
+                REQUIRE(decodedW == w);
+                REQUIRE(decodedH == h);
+                REQUIRE(decoded == expected);
+            }
+        }
+    }
+#endif
+
+    SECTION("raw strips match the whole page")
+    {
+        Config config;
+        config.textureFormat = Config::TextureFormat::Raw;
+
+        const std::uint32_t w = 37;
+        const std::uint32_t h = 23;
+        const auto pixels = makePixels(w, h);
+        for (const auto channels : {Config::TextureChannels::Rgba, Config::TextureChannels::Alpha})
+        {
+            config.textureChannels = channels;
+            const auto expected = TextureFile::encode(pixels.data(), w, h, true, config);
+            for (const std::uint32_t stripHeight : {1u, 5u, 23u})
+                REQUIRE(writeInStrips(path, pixels, w, h, stripHeight, true, config) == expected);
+        }
+    }
+
+    SECTION("raw block compressed strips match the whole page")
+    {
+        Config config;
+        config.textureFormat = Config::TextureFormat::Raw;
+
+        const std::uint32_t w = 36;
+        const std::uint32_t h = 28;
+        const auto pixels = makePixels(w, h);
+        for (const auto compression : {Config::TextureCompression::Bc4, Config::TextureCompression::Bc7, Config::TextureCompression::Etc2})
+        {
+            config.textureCompression = compression;
+            const auto expected = TextureFile::encode(pixels.data(), w, h, true, config);
+            for (const std::uint32_t stripHeight : {4u, 8u, 12u})
+                REQUIRE(writeInStrips(path, pixels, w, h, stripHeight, true, config) == expected);
+        }
+
+        // Only the bottom strip may end inside a block row
+        config.textureCompression = Config::TextureCompression::Bc7;
+        TextureFile::StripWriter writer(path, w, h, true, config);
+        REQUIRE_THROWS_AS(writer.write(pixels.data(), 6), std::logic_error);
+    }
+
+    SECTION("dds and ktx2 are written as whole pages")
+    {
+        Config config;
+        config.textureFormat = Config::TextureFormat::Dds;
+        REQUIRE_THROWS_AS(TextureFile::StripWriter(path, 4, 4, true, config), std::runtime_error);
+    }
+
+    std::filesystem::remove(path);
+}
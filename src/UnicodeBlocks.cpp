@@ -0,0 +1,341 @@
+#include "UnicodeBlocks.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// Ordered by first code point, generated from Blocks.txt.
+constexpr UnicodeBlocks::Block blocks[] = {
+    {0x0000, 0x007F, "Basic Latin", "Latin"},
+    {0x0080, 0x00FF, "Latin-1 Supplement", "Latin"},
+    {0x0100, 0x017F, "Latin Extended-A", "Latin"},
+    {0x0180, 0x024F, "Latin Extended-B", "Latin"},
+    {0x0250, 0x02AF, "IPA Extensions", "Latin"},
+    {0x02B0, 0x02FF, "Spacing Modifier Letters", "Common"},
+    {0x0300, 0x036F, "Combining Diacritical Marks", "Common"},
+    {0x0370, 0x03FF, "Greek and Coptic", "Greek"},
+    {0x0400, 0x04FF, "Cyrillic", "Cyrillic"},
+    {0x0500, 0x052F, "Cyrillic Supplement", "Cyrillic"},
+    {0x0530, 0x058F, "Armenian", "Armenian"},
+    {0x0590, 0x05FF, "Hebrew", "Hebrew"},
+    {0x0600, 0x06FF, "Arabic", "Arabic"},
+    {0x0700, 0x074F, "Syriac", "Syriac"},
+    {0x0750, 0x077F, "Arabic Supplement", "Arabic"},
+    {0x0780, 0x07BF, "Thaana", "Thaana"},
+    {0x07C0, 0x07FF, "NKo", "NKo"},
+    {0x0800, 0x083F, "Samaritan", "Samaritan"},
+    {0x0840, 0x085F, "Mandaic", "Mandaic"},
+    {0x0860, 0x086F, "Syriac Supplement", "Syriac"},
+    {0x0870, 0x089F, "Arabic Extended-B", "Arabic"},
+    {0x08A0, 0x08FF, "Arabic Extended-A", "Arabic"},
+    {0x0900, 0x097F, "Devanagari", "Devanagari"},
+    {0x0980, 0x09FF, "Bengali", "Bengali"},
+    {0x0A00, 0x0A7F, "Gurmukhi", "Gurmukhi"},
+    {0x0A80, 0x0AFF, "Gujarati", "Gujarati"},
+    {0x0B00, 0x0B7F, "Oriya", "Oriya"},
+    {0x0B80, 0x0BFF, "Tamil", "Tamil"},
+    {0x0C00, 0x0C7F, "Telugu", "Telugu"},
+    {0x0C80, 0x0CFF, "Kannada", "Kannada"},
+    {0x0D00, 0x0D7F, "Malayalam", "Malayalam"},
+    {0x0D80, 0x0DFF, "Sinhala", "Sinhala"},
+    {0x0E00, 0x0E7F, "Thai", "Thai"},
+    {0x0E80, 0x0EFF, "Lao", "Lao"},
+    {0x0F00, 0x0FFF, "Tibetan", "Tibetan"},
+    {0x1000, 0x109F, "Myanmar", "Myanmar"},
+    {0x10A0, 0x10FF, "Georgian", "Georgian"},
+    {0x1100, 0x11FF, "Hangul Jamo", "Hangul"},
+    {0x1200, 0x137F, "Ethiopic", "Ethiopic"},
+    {0x1380, 0x139F, "Ethiopic Supplement", "Ethiopic"},
+    {0x13A0, 0x13FF, "Cherokee", "Cherokee"},
+    {0x1400, 0x167F, "Unified Canadian Aboriginal Syllabics", "Canadian Aboriginal"},
+    {0x1680, 0x169F, "Ogham", "Ogham"},
+    {0x16A0, 0x16FF, "Runic", "Runic"},
+    {0x1700, 0x171F, "Tagalog", "Tagalog"},
+    {0x1720, 0x173F, "Hanunoo", "Hanunoo"},
+    {0x1740, 0x175F, "Buhid", "Buhid"},
+    {0x1760, 0x177F, "Tagbanwa", "Tagbanwa"},
+    {0x1780, 0x17FF, "Khmer", "Khmer"},
+    {0x1800, 0x18AF, "Mongolian", "Mongolian"},
+    {0x18B0, 0x18FF, "Unified Canadian Aboriginal Syllabics Extended", "Canadian Aboriginal"},
+    {0x1900, 0x194F, "Limbu", "Limbu"},
+    {0x1950, 0x197F, "Tai Le", "Tai Le"},
+    {0x1980, 0x19DF, "New Tai Lue", "New Tai Lue"},
+    {0x19E0, 0x19FF, "Khmer Symbols", "Khmer"},
+    {0x1A00, 0x1A1F, "Buginese", "Buginese"},
+    {0x1A20, 0x1AAF, "Tai Tham", "Tai Tham"},
+    {0x1AB0, 0x1AFF, "Combining Diacritical Marks Extended", "Common"},
+    {0x1B00, 0x1B7F, "Balinese", "Balinese"},
+    {0x1B80, 0x1BBF, "Sundanese", "Sundanese"},
+    {0x1BC0, 0x1BFF, "Batak", "Batak"},
+    {0x1C00, 0x1C4F, "Lepcha", "Lepcha"},
+    {0x1C50, 0x1C7F, "Ol Chiki", "Ol Chiki"},
+    {0x1C80, 0x1C8F, "Cyrillic Extended-C", "Cyrillic"},
+    {0x1C90, 0x1CBF, "Georgian Extended", "Georgian"},
+    {0x1CC0, 0x1CCF, "Sundanese Supplement", "Sundanese"},
+    {0x1CD0, 0x1CFF, "Vedic Extensions", "Devanagari"},
+    {0x1D00, 0x1D7F, "Phonetic Extensions", "Latin"},
+    {0x1D80, 0x1DBF, "Phonetic Extensions Supplement", "Latin"},
+    {0x1DC0, 0x1DFF, "Combining Diacritical Marks Supplement", "Common"},
+    {0x1E00, 0x1EFF, "Latin Extended Additional", "Latin"},
+    {0x1F00, 0x1FFF, "Greek Extended", "Greek"},
+    {0x2000, 0x206F, "General Punctuation", "Common"},
+    {0x2070, 0x209F, "Superscripts and Subscripts", "Common"},
+    {0x20A0, 0x20CF, "Currency Symbols", "Common"},
+    {0x20D0, 0x20FF, "Combining Diacritical Marks for Symbols", "Common"},
+    {0x2100, 0x214F, "Letterlike Symbols", "Common"},
+    {0x2150, 0x218F, "Number Forms", "Common"},
+    {0x2190, 0x21FF, "Arrows", "Common"},
+    {0x2200, 0x22FF, "Mathematical Operators", "Common"},
+    {0x2300, 0x23FF, "Miscellaneous Technical", "Common"},
+    {0x2400, 0x243F, "Control Pictures", "Common"},
+    {0x2440, 0x245F, "Optical Character Recognition", "Common"},
+    {0x2460, 0x24FF, "Enclosed Alphanumerics", "Common"},
+    {0x2500, 0x257F, "Box Drawing", "Common"},
+    {0x2580, 0x259F, "Block Elements", "Common"},
+    {0x25A0, 0x25FF, "Geometric Shapes", "Common"},
+    {0x2600, 0x26FF, "Miscellaneous Symbols", "Common"},
+    {0x2700, 0x27BF, "Dingbats", "Common"},
+    {0x27C0, 0x27EF, "Miscellaneous Mathematical Symbols-A", "Common"},
+    {0x27F0, 0x27FF, "Supplemental Arrows-A", "Common"},
+    {0x2800, 0x28FF, "Braille Patterns", "Common"},
+    {0x2900, 0x297F, "Supplemental Arrows-B", "Common"},
+    {0x2980, 0x29FF, "Miscellaneous Mathematical Symbols-B", "Common"},
+    {0x2A00, 0x2AFF, "Supplemental Mathematical Operators", "Common"},
+    {0x2B00, 0x2BFF, "Miscellaneous Symbols and Arrows", "Common"},
+    {0x2C00, 0x2C5F, "Glagolitic", "Glagolitic"},
+    {0x2C60, 0x2C7F, "Latin Extended-C", "Latin"},
+    {0x2C80, 0x2CFF, "Coptic", "Coptic"},
+    {0x2D00, 0x2D2F, "Georgian Supplement", "Georgian"},
+    {0x2D30, 0x2D7F, "Tifinagh", "Tifinagh"},
+    {0x2D80, 0x2DDF, "Ethiopic Extended", "Ethiopic"},
+    {0x2DE0, 0x2DFF, "Cyrillic Extended-A", "Cyrillic"},
+    {0x2E00, 0x2E7F, "Supplemental Punctuation", "Common"},
+    {0x2E80, 0x2EFF, "CJK Radicals Supplement", "Han"},
+    {0x2F00, 0x2FDF, "Kangxi Radicals", "Han"},
+    {0x2FF0, 0x2FFF, "Ideographic Description Characters", "Common"},
+    {0x3000, 0x303F, "CJK Symbols and Punctuation", "Common"},
+    {0x3040, 0x309F, "Hiragana", "Kana"},
+    {0x30A0, 0x30FF, "Katakana", "Kana"},
+    {0x3100, 0x312F, "Bopomofo", "Bopomofo"},
+    {0x3130, 0x318F, "Hangul Compatibility Jamo", "Hangul"},
+    {0x3190, 0x319F, "Kanbun", "Han"},
+    {0x31A0, 0x31BF, "Bopomofo Extended", "Bopomofo"},
+    {0x31C0, 0x31EF, "CJK Strokes", "Han"},
+    {0x31F0, 0x31FF, "Katakana Phonetic Extensions", "Kana"},
+    {0x3200, 0x32FF, "Enclosed CJK Letters and Months", "Common"},
+    {0x3300, 0x33FF, "CJK Compatibility", "Common"},
+    {0x3400, 0x4DBF, "CJK Unified Ideographs Extension A", "Han"},
+    {0x4DC0, 0x4DFF, "Yijing Hexagram Symbols", "Common"},
+    {0x4E00, 0x9FFF, "CJK Unified Ideographs", "Han"},
+    {0xA000, 0xA48F, "Yi Syllables", "Yi"},
+    {0xA490, 0xA4CF, "Yi Radicals", "Yi"},
+    {0xA4D0, 0xA4FF, "Lisu", "Lisu"},
+    {0xA500, 0xA63F, "Vai", "Vai"},
+    {0xA640, 0xA69F, "Cyrillic Extended-B", "Cyrillic"},
+    {0xA6A0, 0xA6FF, "Bamum", "Bamum"},
+    {0xA700, 0xA71F, "Modifier Tone Letters", "Common"},
+    {0xA720, 0xA7FF, "Latin Extended-D", "Latin"},
+    {0xA800, 0xA82F, "Syloti Nagri", "Syloti Nagri"},
+    {0xA830, 0xA83F, "Common Indic Number Forms", "Common"},
+    {0xA840, 0xA87F, "Phags-pa", "Phags-pa"},
+    {0xA880, 0xA8DF, "Saurashtra", "Saurashtra"},
+    {0xA8E0, 0xA8FF, "Devanagari Extended", "Devanagari"},
+    {0xA900, 0xA92F, "Kayah Li", "Kayah Li"},
+    {0xA930, 0xA95F, "Rejang", "Rejang"},
+    {0xA960, 0xA97F, "Hangul Jamo Extended-A", "Hangul"},
+    {0xA980, 0xA9DF, "Javanese", "Javanese"},
+    {0xA9E0, 0xA9FF, "Myanmar Extended-B", "Myanmar"},
+    {0xAA00, 0xAA5F, "Cham", "Cham"},
+    {0xAA60, 0xAA7F, "Myanmar Extended-A", "Myanmar"},
+    {0xAA80, 0xAADF, "Tai Viet", "Tai Viet"},
+    {0xAAE0, 0xAAFF, "Meetei Mayek Extensions", "Meetei Mayek"},
+    {0xAB00, 0xAB2F, "Ethiopic Extended-A", "Ethiopic"},
+    {0xAB30, 0xAB6F, "Latin Extended-E", "Latin"},
+    {0xAB70, 0xABBF, "Cherokee Supplement", "Cherokee"},
+    {0xABC0, 0xABFF, "Meetei Mayek", "Meetei Mayek"},
+    {0xAC00, 0xD7AF, "Hangul Syllables", "Hangul"},
+    {0xD7B0, 0xD7FF, "Hangul Jamo Extended-B", "Hangul"},
+    {0xD800, 0xDB7F, "High Surrogates", "Common"},
+    {0xDB80, 0xDBFF, "High Private Use Surrogates", "Common"},
+    {0xDC00, 0xDFFF, "Low Surrogates", "Common"},
+    {0xE000, 0xF8FF, "Private Use Area", "Common"},
+    {0xF900, 0xFAFF, "CJK Compatibility Ideographs", "Han"},
+    {0xFB00, 0xFB4F, "Alphabetic Presentation Forms", "Latin"},
+    {0xFB50, 0xFDFF, "Arabic Presentation Forms-A", "Arabic"},
+    {0xFE00, 0xFE0F, "Variation Selectors", "Common"},
+    {0xFE10, 0xFE1F, "Vertical Forms", "Common"},
+    {0xFE20, 0xFE2F, "Combining Half Marks", "Common"},
+    {0xFE30, 0xFE4F, "CJK Compatibility Forms", "Common"},
+    {0xFE50, 0xFE6F, "Small Form Variants", "Common"},
+    {0xFE70, 0xFEFF, "Arabic Presentation Forms-B", "Arabic"},
+    {0xFF00, 0xFFEF, "Halfwidth and Fullwidth Forms", "Common"},
+    {0xFFF0, 0xFFFF, "Specials", "Common"},
+    {0x10000, 0x1007F, "Linear B Syllabary", "Linear B"},
+    {0x10080, 0x100FF, "Linear B Ideograms", "Linear B"},
+    {0x10100, 0x1013F, "Aegean Numbers", "Common"},
+    {0x10140, 0x1018F, "Ancient Greek Numbers", "Common"},
+    {0x10190, 0x101CF, "Ancient Symbols", "Common"},
+    {0x101D0, 0x101FF, "Phaistos Disc", "Phaistos Disc"},
+    {0x10280, 0x1029F, "Lycian", "Lycian"},
+    {0x102A0, 0x102DF, "Carian", "Carian"},
+    {0x102E0, 0x102FF, "Coptic Epact Numbers", "Common"},
+    {0x10300, 0x1032F, "Old Italic", "Old Italic"},
+    {0x10330, 0x1034F, "Gothic", "Gothic"},
+    {0x10350, 0x1037F, "Old Permic", "Old Permic"},
+    {0x10380, 0x1039F, "Ugaritic", "Ugaritic"},
+    {0x103A0, 0x103DF, "Old Persian", "Old Persian"},
+    {0x10400, 0x1044F, "Deseret", "Deseret"},
+    {0x10450, 0x1047F, "Shavian", "Shavian"},
+    {0x10480, 0x104AF, "Osmanya", "Osmanya"},
+    {0x104B0, 0x104FF, "Osage", "Osage"},
+    {0x10500, 0x1052F, "Elbasan", "Elbasan"},
+    {0x10530, 0x1056F, "Caucasian Albanian", "Caucasian Albanian"},
+    {0x10570, 0x105BF, "Vithkuqi", "Vithkuqi"},
+    {0x10600, 0x1077F, "Linear A", "Linear A"},
+    {0x10780, 0x107BF, "Latin Extended-F", "Latin"},
+    {0x10800, 0x1083F, "Cypriot Syllabary", "Cypriot"},
+    {0x10840, 0x1085F, "Imperial Aramaic", "Imperial Aramaic"},
+    {0x10860, 0x1087F, "Palmyrene", "Palmyrene"},
+    {0x10880, 0x108AF, "Nabataean", "Nabataean"},
+    {0x108E0, 0x108FF, "Hatran", "Hatran"},
+    {0x10900, 0x1091F, "Phoenician", "Phoenician"},
+    {0x10920, 0x1093F, "Lydian", "Lydian"},
+    {0x10980, 0x1099F, "Meroitic Hieroglyphs", "Meroitic"},
+    {0x109A0, 0x109FF, "Meroitic Cursive", "Meroitic Cursive"},
+    {0x10A00, 0x10A5F, "Kharoshthi", "Kharoshthi"},
+    {0x10A60, 0x10A7F, "Old South Arabian", "Old South Arabian"},
+    {0x10A80, 0x10A9F, "Old North Arabian", "Old North Arabian"},
+    {0x10AC0, 0x10AFF, "Manichaean", "Manichaean"},
+    {0x10B00, 0x10B3F, "Avestan", "Avestan"},
+    {0x10B40, 0x10B5F, "Inscriptional Parthian", "Inscriptional Parthian"},
+    {0x10B60, 0x10B7F, "Inscriptional Pahlavi", "Inscriptional Pahlavi"},
+    {0x10B80, 0x10BAF, "Psalter Pahlavi", "Psalter Pahlavi"},
+    {0x10C00, 0x10C4F, "Old Turkic", "Old Turkic"},
+    {0x10C80, 0x10CFF, "Old Hungarian", "Old Hungarian"},
+    {0x10D00, 0x10D3F, "Hanifi Rohingya", "Hanifi Rohingya"},
+    {0x10E60, 0x10E7F, "Rumi Numeral Symbols", "Common"},
+    {0x10E80, 0x10EBF, "Yezidi", "Yezidi"},
+    {0x10F00, 0x10F2F, "Old Sogdian", "Old Sogdian"},
+    {0x10F30, 0x10F6F, "Sogdian", "Sogdian"},
+    {0x10F70, 0x10FAF, "Old Uyghur", "Old Uyghur"},
+    {0x10FB0, 0x10FDF, "Chorasmian", "Chorasmian"},
+    {0x10FE0, 0x10FFF, "Elymaic", "Elymaic"},
+    {0x11000, 0x1107F, "Brahmi", "Brahmi"},
+    {0x11080, 0x110CF, "Kaithi", "Kaithi"},
+    {0x110D0, 0x110FF, "Sora Sompeng", "Sora Sompeng"},
+    {0x11100, 0x1114F, "Chakma", "Chakma"},
+    {0x11150, 0x1117F, "Mahajani", "Mahajani"},
+    {0x11180, 0x111DF, "Sharada", "Sharada"},
+    {0x111E0, 0x111FF, "Sinhala Archaic Numbers", "Common"},
+    {0x11200, 0x1124F, "Khojki", "Khojki"},
+    {0x11280, 0x112AF, "Multani", "Multani"},
+    {0x112B0, 0x112FF, "Khudawadi", "Khudawadi"},
+    {0x11300, 0x1137F, "Grantha", "Grantha"},
+    {0x11400, 0x1147F, "Newa", "Newa"},
+    {0x11480, 0x114DF, "Tirhuta", "Tirhuta"},
+    {0x11580, 0x115FF, "Siddham", "Siddham"},
+    {0x11600, 0x1165F, "Modi", "Modi"},
+    {0x11660, 0x1167F, "Mongolian Supplement", "Mongolian"},
+    {0x11680, 0x116CF, "Takri", "Takri"},
+    {0x11700, 0x1174F, "Ahom", "Ahom"},
+    {0x11800, 0x1184F, "Dogra", "Dogra"},
+    {0x118A0, 0x118FF, "Warang Citi", "Warang Citi"},
+    {0x11900, 0x1195F, "Dives Akuru", "Dives Akuru"},
+    {0x119A0, 0x119FF, "Nandinagari", "Nandinagari"},
+    {0x11A00, 0x11A4F, "Zanabazar Square", "Zanabazar Square"},
+    {0x11A50, 0x11AAF, "Soyombo", "Soyombo"},
+    {0x11AB0, 0x11ABF, "Unified Canadian Aboriginal Syllabics Extended-A", "Canadian Aboriginal"},
+    {0x11AC0, 0x11AFF, "Pau Cin Hau", "Pau Cin Hau"},
+    {0x11C00, 0x11C6F, "Bhaiksuki", "Bhaiksuki"},
+    {0x11C70, 0x11CBF, "Marchen", "Marchen"},
+    {0x11D00, 0x11D5F, "Masaram Gondi", "Masaram Gondi"},
+    {0x11D60, 0x11DAF, "Gunjala Gondi", "Gunjala Gondi"},
+    {0x11EE0, 0x11EFF, "Makasar", "Makasar"},
+    {0x11FB0, 0x11FBF, "Lisu Supplement", "Lisu"},
+    {0x11FC0, 0x11FFF, "Tamil Supplement", "Tamil"},
+    {0x12000, 0x123FF, "Cuneiform", "Cuneiform"},
+    {0x12400, 0x1247F, "Cuneiform Numbers and Punctuation", "Common"},
+    {0x12480, 0x1254F, "Early Dynastic Cuneiform", "Cuneiform"},
+    {0x12F90, 0x12FFF, "Cypro-Minoan", "Cypro-Minoan"},
+    {0x13000, 0x1342F, "Egyptian Hieroglyphs", "Egyptian"},
+    {0x13430, 0x1343F, "Egyptian Hieroglyph Format Controls", "Egyptian"},
+    {0x14400, 0x1467F, "Anatolian Hieroglyphs", "Anatolian"},
+    {0x16800, 0x16A3F, "Bamum Supplement", "Bamum"},
+    {0x16A40, 0x16A6F, "Mro", "Mro"},
+    {0x16A70, 0x16ACF, "Tangsa", "Tangsa"},
+    {0x16AD0, 0x16AFF, "Bassa Vah", "Bassa Vah"},
+    {0x16B00, 0x16B8F, "Pahawh Hmong", "Pahawh Hmong"},
+    {0x16E40, 0x16E9F, "Medefaidrin", "Medefaidrin"},
+    {0x16F00, 0x16F9F, "Miao", "Miao"},
+    {0x16FE0, 0x16FFF, "Ideographic Symbols and Punctuation", "Common"},
+    {0x17000, 0x187FF, "Tangut", "Tangut"},
+    {0x18800, 0x18AFF, "Tangut Components", "Tangut"},
+    {0x18B00, 0x18CFF, "Khitan Small Script", "Khitan Small Script"},
+    {0x18D00, 0x18D7F, "Tangut Supplement", "Tangut"},
+    {0x1AFF0, 0x1AFFF, "Kana Extended-B", "Kana"},
+    {0x1B000, 0x1B0FF, "Kana Supplement", "Kana"},
+    {0x1B100, 0x1B12F, "Kana Extended-A", "Kana"},
+    {0x1B130, 0x1B16F, "Small Kana Extension", "Kana"},
+    {0x1B170, 0x1B2FF, "Nushu", "Nushu"},
+    {0x1BC00, 0x1BC9F, "Duployan", "Duployan"},
+    {0x1BCA0, 0x1BCAF, "Shorthand Format Controls", "Common"},
+    {0x1CF00, 0x1CFCF, "Znamenny Musical Notation", "Common"},
+    {0x1D000, 0x1D0FF, "Byzantine Musical Symbols", "Common"},
+    {0x1D100, 0x1D1FF, "Musical Symbols", "Common"},
+    {0x1D200, 0x1D24F, "Ancient Greek Musical Notation", "Common"},
+    {0x1D2E0, 0x1D2FF, "Mayan Numerals", "Common"},
+    {0x1D300, 0x1D35F, "Tai Xuan Jing Symbols", "Common"},
+    {0x1D360, 0x1D37F, "Counting Rod Numerals", "Common"},
+    {0x1D400, 0x1D7FF, "Mathematical Alphanumeric Symbols", "Common"},
+    {0x1D800, 0x1DAAF, "Sutton SignWriting", "Sutton SignWriting"},
+    {0x1DF00, 0x1DFFF, "Latin Extended-G", "Latin"},
+    {0x1E000, 0x1E02F, "Glagolitic Supplement", "Glagolitic"},
+    {0x1E100, 0x1E14F, "Nyiakeng Puachue Hmong", "Nyiakeng Puachue Hmong"},
+    {0x1E290, 0x1E2BF, "Toto", "Toto"},
+    {0x1E2C0, 0x1E2FF, "Wancho", "Wancho"},
+    {0x1E7E0, 0x1E7FF, "Ethiopic Extended-B", "Ethiopic"},
+    {0x1E800, 0x1E8DF, "Mende Kikakui", "Mende Kikakui"},
+    {0x1E900, 0x1E95F, "Adlam", "Adlam"},
+    {0x1EC70, 0x1ECBF, "Indic Siyaq Numbers", "Common"},
+    {0x1ED00, 0x1ED4F, "Ottoman Siyaq Numbers", "Common"},
+    {0x1EE00, 0x1EEFF, "Arabic Mathematical Alphabetic Symbols", "Arabic"},
+    {0x1F000, 0x1F02F, "Mahjong Tiles", "Common"},
+    {0x1F030, 0x1F09F, "Domino Tiles", "Common"},
+    {0x1F0A0, 0x1F0FF, "Playing Cards", "Common"},
+    {0x1F100, 0x1F1FF, "Enclosed Alphanumeric Supplement", "Common"},
+    {0x1F200, 0x1F2FF, "Enclosed Ideographic Supplement", "Common"},
+    {0x1F300, 0x1F5FF, "Miscellaneous Symbols and Pictographs", "Common"},
+    {0x1F600, 0x1F64F, "Emoticons", "Common"},
+    {0x1F650, 0x1F67F, "Ornamental Dingbats", "Common"},
+    {0x1F680, 0x1F6FF, "Transport and Map Symbols", "Common"},
+    {0x1F700, 0x1F77F, "Alchemical Symbols", "Common"},
+    {0x1F780, 0x1F7FF, "Geometric Shapes Extended", "Common"},
+    {0x1F800, 0x1F8FF, "Supplemental Arrows-C", "Common"},
+    {0x1F900, 0x1F9FF, "Supplemental Symbols and Pictographs", "Common"},
+    {0x1FA00, 0x1FA6F, "Chess Symbols", "Common"},
+    {0x1FA70, 0x1FAFF, "Symbols and Pictographs Extended-A", "Common"},
+    {0x1FB00, 0x1FBFF, "Symbols for Legacy Computing", "Common"},
+    {0x20000, 0x2A6DF, "CJK Unified Ideographs Extension B", "Han"},
+    {0x2A700, 0x2B73F, "CJK Unified Ideographs Extension C", "Han"},
+    {0x2B740, 0x2B81F, "CJK Unified Ideographs Extension D", "Han"},
+    {0x2B820, 0x2CEAF, "CJK Unified Ideographs Extension E", "Han"},
+    {0x2CEB0, 0x2EBEF, "CJK Unified Ideographs Extension F", "Han"},
+    {0x2F800, 0x2FA1F, "CJK Compatibility Ideographs Supplement", "Han"},
+    {0x30000, 0x3134F, "CJK Unified Ideographs Extension G", "Han"},
+    {0xE0000, 0xE007F, "Tags", "Common"},
+    {0xE0100, 0xE01EF, "Variation Selectors Supplement", "Common"},
+    {0xF0000, 0xFFFFF, "Supplementary Private Use Area-A", "Common"},
+    {0x100000, 0x10FFFF, "Supplementary Private Use Area-B", "Common"},
+};
+
+}
+
+const UnicodeBlocks::Block* UnicodeBlocks::find(const std::uint32_t utf32)
+{
+    const auto it = std::upper_bound(std::begin(blocks), std::end(blocks), utf32,
+                                     [](const std::uint32_t code, const Block& block) { return code < block.first; });
+    if (it == std::begin(blocks))
+        return nullptr;
+    const auto& block = *std::prev(it);
+    return utf32 <= block.last ? &block : nullptr;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+// Unicode 14 blocks (Blocks.txt) with the script their chars are grouped under by --page-groups script.
+// Blocks shared by many scripts (punctuation, symbols, combining marks) are "Common".
+class UnicodeBlocks
+{
+public:
+    struct Block
+    {
+        std::uint32_t first;
+        std::uint32_t last;
+        std::string_view name;
+        std::string_view script;
+    };
+
+    // nullptr for code points outside of any block.
+    static const Block* find(std::uint32_t utf32);
+};
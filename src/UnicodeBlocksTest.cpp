@@ -0,0 +1,26 @@
+#include "external/catch.hpp"
+#include "UnicodeBlocks.h"
+
+TEST_CASE("UnicodeBlocks find")
+{
+    const auto basicLatin = UnicodeBlocks::find('A');
+    REQUIRE(basicLatin);
+    REQUIRE(basicLatin->name == "Basic Latin");
+    REQUIRE(basicLatin->script == "Latin");
+    REQUIRE(UnicodeBlocks::find(0)->first == 0);
+    REQUIRE(UnicodeBlocks::find(0x7F) == basicLatin);
+
+    REQUIRE(UnicodeBlocks::find(0x44F)->name == "Cyrillic");
+    REQUIRE(UnicodeBlocks::find(0x20AC)->script == "Common");
+    REQUIRE(UnicodeBlocks::find(0x3042)->script == "Kana");
+    REQUIRE(UnicodeBlocks::find(0x30A2)->script == "Kana");
+    REQUIRE(UnicodeBlocks::find(0x4E00)->script == "Han");
+    REQUIRE(UnicodeBlocks::find(0xAC00)->name == "Hangul Syllables");
+    REQUIRE(UnicodeBlocks::find(0xAC00)->script == "Hangul");
+    REQUIRE(UnicodeBlocks::find(0x1F600)->script == "Common");
+    REQUIRE(UnicodeBlocks::find(0x10FFFF)->name == "Supplementary Private Use Area-B");
+
+    // Outside of any block
+    REQUIRE(!UnicodeBlocks::find(0x2FE0));
+    REQUIRE(!UnicodeBlocks::find(0x110000));
+}
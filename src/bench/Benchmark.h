@@ -0,0 +1,102 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "../utils/JsonWriter.h"
+
+// Minimal benchmark runner: every case is repeated until minSeconds is spent (at least once),
+// only the benchmarked function is timed (setup is excluded).
+class Benchmark
+{
+public:
+    struct Result
+    {
+        std::string name;
+        std::uint32_t iterations = 0;
+        std::uint64_t meanNs = 0;
+        std::uint64_t minNs = 0;
+    };
+
+    Benchmark(double minSeconds, std::string filter) : minSeconds(minSeconds), filter(std::move(filter)) {}
+
+    bool enabled(const std::string& name) const
+    {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    template<class F>
+    void run(const std::string& name, F fn)
+    {
+        run(name, []() { return 0; }, [&fn](int&) { fn(); });
+    }
+
+    template<class Setup, class F>
+    void run(const std::string& name, Setup setup, F fn)
+    {
+        if (!enabled(name))
+            return;
+
+        Result result;
+        result.name = name;
+        std::uint64_t total = 0;
+        std::uint64_t minNs = std::numeric_limits<std::uint64_t>::max();
+        const auto minNsTotal = static_cast<std::uint64_t>(minSeconds * 1e9);
+        do
+        {
+            auto state = setup();
+            const auto start = std::chrono::steady_clock::now();
+            fn(state);
+            const auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            total += ns;
+            if (ns < minNs)
+                minNs = ns;
+            ++result.iterations;
+        }
+        while (total < minNsTotal);
+
+        result.meanNs = total / result.iterations;
+        result.minNs = minNs;
+        results.push_back(result);
+
+        std::cout << std::left << std::setw(56) << result.name << std::right
+                  << std::setw(8) << result.iterations
+                  << std::setw(14) << std::fixed << std::setprecision(3) << static_cast<double>(result.meanNs) / 1e6
+                  << std::setw(14) << static_cast<double>(result.minNs) / 1e6 << std::endl;
+    }
+
+    static void printHeader()
+    {
+        std::cout << std::left << std::setw(56) << "benchmark" << std::right
+                  << std::setw(8) << "iters" << std::setw(14) << "mean ms" << std::setw(14) << "min ms" << std::endl;
+    }
+
+    void writeToJsonFile(const std::string& fileName) const
+    {
+        std::ofstream f(fileName);
+        if (!f)
+            throw std::runtime_error("can't open " + fileName);
+        JsonWriter j(f);
+        j.beginArray();
+        for (const auto& r : results)
+        {
+            j.beginObject();
+            j.field("name", r.name)
+                .field("iterations", r.iterations)
+                .field("meanNs", r.meanNs)
+                .field("minNs", r.minNs);
+            j.endObject();
+        }
+        j.endArray();
+        f << "\n";
+    }
+
+private:
+    double minSeconds;
+    std::string filter;
+    std::vector<Result> results;
+};
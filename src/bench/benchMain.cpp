@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "../App.h"
+#include "../FontFileRegistry.h"
+#include "../external/cxxopts.hpp"
+#include "../utils/splitStrByDelim.h"
+
+// Benchmarks of the generation pipeline stages over the bundled FreeSans fonts, parameterized by
+// glyph count and texture size. Run from the repository root (or pass --fonts-dir).
+
+namespace
+{
+
+struct Params
+{
+    std::vector<std::uint32_t> glyphCounts;
+    std::vector<std::uint32_t> kerningGlyphCounts;
+    std::vector<std::uint32_t> pageSizes;
+};
+
+std::vector<std::uint32_t> parseList(const std::string& s)
+{
+    std::vector<std::uint32_t> result;
+    for (const auto& v : string_split(s, ","))
+        result.push_back(static_cast<std::uint32_t>(std::stoul(v)));
+    return result;
+}
+
+CharSet firstChars(const CharSet& chars, std::size_t count)
+{
+    CharSet result;
+    for (const auto c : chars)
+    {
+        if (count-- == 0)
+            break;
+        result.insert(c);
+    }
+    return result;
+}
+
+void benchFont(Benchmark& bench, const Params& params, ft::Library& library, FontFileRegistry& fontFiles, const std::filesystem::path& fontFile,
+               const std::filesystem::path& outputDir)
+{
+    const auto fontName = fontFile.stem().string();
+
+    Config config;
+    config.fontFile = fontFile.string();
+    config.fontSize = 32;
+    config.output = (outputDir / fontName).string();
+    config.color = Config::Color{255, 255, 255};
+
+    // Only for the untimed setup calls, every benchmark iteration gets its own Stats so counters and
+    // page lists do not grow with the iteration count
+    Stats stats;
+    const auto fonts = FontChain::load(library, fontFiles, config);
+    const auto& font = fonts.primary();
+    const auto allChars = font.collectChars();
+
+    std::size_t prevCount = 0;
+    for (const auto glyphCount : params.glyphCounts)
+    {
+        const auto count = std::min<std::size_t>(glyphCount, allChars.size());
+        if (count == prevCount)
+            continue;
+        prevCount = count;
+
+        const auto chars = firstChars(allChars, count);
+        config.chars = chars;
+        const auto suffix = "/" + fontName + "/" + std::to_string(count);
+
+        bench.run("shapeGlyphs" + suffix, [&]() {
+            App::shapeGlyphs(fonts, chars, false, false);
+        });
+        bench.run("collectGlyphInfo" + suffix, [&]() {
+            Stats iterationStats;
+            App::collectGlyphInfo(fonts, chars, false, false, iterationStats);
+        });
+
+        const auto glyphs = App::collectGlyphInfo(fonts, chars, false, false, stats);
+
+        for (const auto pageSize : params.pageSizes)
+        {
+            config.textureSizeList = {{pageSize, pageSize}};
+            const auto pageSuffix = suffix + "/" + std::to_string(pageSize) + "x" + std::to_string(pageSize);
+
+            bench.run("arrangeGlyphs" + pageSuffix, [&]() { return glyphs; }, [&](App::Glyphs& g) {
+                Stats iterationStats;
+                App::arrangeGlyphs(g, config, iterationStats);
+            });
+
+            auto arranged = glyphs;
+            const auto pages = App::arrangeGlyphs(arranged, config, stats);
+
+            bench.run("renderTextures" + pageSuffix, [&]() {
+                Stats iterationStats;
+                for (std::uint32_t page = 0; page < pages.size(); ++page)
+                    App::renderPage(arranged, config, fonts, pages[page], page, iterationStats);
+            });
+
+            const auto surface = App::renderPage(arranged, config, fonts, pages.front(), 0, stats);
+            const auto pngFile = config.output + "_bench.png";
+            bench.run("savePng" + pageSuffix, [&]() {
+                App::savePng(pngFile, surface.data(), pages.front().w, pages.front().h, true);
+            });
+        }
+    }
+
+    config.textureSizeList = {{4096, 4096}};
+    for (const auto count : params.kerningGlyphCounts)
+    {
+        const auto chars = firstChars(allChars, count);
+        config.chars = chars;
+        auto glyphs = App::collectGlyphInfo(fonts, chars, false, false, stats);
+        const auto pages = App::arrangeGlyphs(glyphs, config, stats);
+        const auto suffix = "/" + fontName + "/" + std::to_string(chars.size());
+
+        const std::vector<std::pair<std::string, Config::KerningPairs>> modes = {
+            {"basic", Config::KerningPairs::Basic},
+            {"regular", Config::KerningPairs::Regular},
+            {"extended", Config::KerningPairs::Extended},
+        };
+        for (const auto& mode : modes)
+        {
+            config.kerningPairs = mode.second;
+            bench.run("kerning/" + mode.first + suffix, [&]() {
+                Stats iterationStats;
+                App::getKerningPairs(glyphs, config, font, iterationStats);
+            });
+        }
+
+        config.kerningPairs = Config::KerningPairs::Regular;
+        const std::vector<std::string> fileNames(pages.size(), fontName + "_0.png");
+        const auto fontInfo = App::buildFontInfo(glyphs, config, font, fileNames, pages, stats);
+        const auto dataFile = config.output + "_bench.fnt";
+
+        bench.run("writeToTextFile" + suffix, [&]() { fontInfo.writeToTextFile(dataFile); });
+        bench.run("writeToXmlFile" + suffix, [&]() { fontInfo.writeToXmlFile(dataFile); });
+        bench.run("writeToBinFile" + suffix, [&]() { fontInfo.writeToBinFile(dataFile); });
+        bench.run("writeToJsonFile" + suffix, [&]() { fontInfo.writeToJsonFile(dataFile); });
+        bench.run("writeToCborFile" + suffix, [&]() { fontInfo.writeToCborFile(dataFile); });
+
+        // Reading back each format (--incremental, --convert), the file holds the last written one
+        const std::vector<std::pair<std::string, void (FontInfo::*)(const std::string&) const>> formats = {
+            {"Text", &FontInfo::writeToTextFile},
+            {"Xml", &FontInfo::writeToXmlFile},
+            {"Bin", &FontInfo::writeToBinFile},
+            {"Json", &FontInfo::writeToJsonFile},
+            {"Cbor", &FontInfo::writeToCborFile},
+        };
+        for (const auto& format : formats)
+        {
+            (fontInfo.*format.second)(dataFile);
+            bench.run("readFrom" + format.first + "File" + suffix, [&]() { FontInfo::readFromFile(dataFile); });
+        }
+    }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        std::string fontsDir;
+        std::string filter;
+        std::string jsonFile;
+        double minTime = 0.2;
+        std::string glyphCounts;
+        std::string kerningGlyphCounts;
+        std::string pageSizes;
+
+        cxxopts::Options options("benchmarks", "fontbm generation pipeline benchmarks");
+        options.add_options()
+            ("help", "produce help message")
+            ("fonts-dir", "directory with FreeSans*.ttf fonts, default: tests/fonts", cxxopts::value<std::string>(fontsDir)->default_value("tests/fonts"))
+            ("filter", "run only benchmarks containing this substring", cxxopts::value<std::string>(filter))
+            ("min-time", "minimal time spent in each benchmark (seconds), default: 0.2", cxxopts::value<double>(minTime)->default_value("0.2"))
+            ("glyph-counts", "comma separated glyph counts, default: 100,1000,4000", cxxopts::value<std::string>(glyphCounts)->default_value("100,1000,4000"))
+            ("kerning-glyph-counts", "comma separated glyph counts for kerning and data file benchmarks, default: 100,400", cxxopts::value<std::string>(kerningGlyphCounts)->default_value("100,400"))
+            ("page-sizes", "comma separated (square) texture sizes, default: 256,1024", cxxopts::value<std::string>(pageSizes)->default_value("256,1024"))
+            ("json", "write results to JSON file", cxxopts::value<std::string>(jsonFile))
+            ;
+        const auto result = options.parse(argc, argv);
+        if (result.count("help"))
+        {
+            std::cout << options.help() << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        Params params;
+        params.glyphCounts = parseList(glyphCounts);
+        params.kerningGlyphCounts = parseList(kerningGlyphCounts);
+        params.pageSizes = parseList(pageSizes);
+
+        std::vector<std::filesystem::path> fonts;
+        for (const auto& entry : std::filesystem::directory_iterator(fontsDir))
+        {
+            const auto name = entry.path().filename().string();
+            if (name.rfind("FreeSans", 0) == 0 && entry.path().extension() == ".ttf")
+                fonts.push_back(entry.path());
+        }
+        if (fonts.empty())
+            throw std::runtime_error("no FreeSans*.ttf fonts found in " + fontsDir);
+        std::sort(fonts.begin(), fonts.end());
+
+        const auto outputDir = std::filesystem::temp_directory_path() / "fontbm_bench";
+        std::filesystem::create_directories(outputDir);
+
+        Benchmark bench(minTime, filter);
+        Benchmark::printHeader();
+        ft::Library library;
+        FontFileRegistry fontFiles;
+        for (const auto& font : fonts)
+            benchFont(bench, params, library, fontFiles, font, outputDir);
+
+        if (!jsonFile.empty())
+            bench.writeToJsonFile(jsonFile);
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
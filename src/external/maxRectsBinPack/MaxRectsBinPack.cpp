@@ -121,6 +121,31 @@ namespace rbp
 		}
 	}
 
+	void MaxRectsBinPack::InsertInOrder(std::vector<RectSize>& rects, std::vector<Rect>& dst, FreeRectChoiceHeuristic method)
+	{
+		dst.clear();
+
+		size_t inserted = 0;
+		for (; inserted < rects.size(); ++inserted)
+		{
+			Rect newNode = Insert(rects[inserted].width, rects[inserted].height, method);
+			if (newNode.height == 0)
+				break;
+			newNode.tag = rects[inserted].tag;
+			dst.push_back(newNode);
+		}
+		rects.erase(rects.begin(), rects.begin() + inserted);
+	}
+
+	bool MaxRectsBinPack::Reserve(const Rect& rect)
+	{
+		// The free rectangles are maximal, so a free area lies inside one of them
+		if (std::none_of(freeRectangles.begin(), freeRectangles.end(), [&](const Rect& free) { return IsContainedIn(rect, free); }))
+			return false;
+		PlaceRect(rect);
+		return true;
+	}
+
 	void MaxRectsBinPack::PlaceRect(const Rect& node)
 	{
 		size_t numRectanglesToProcess = freeRectangles.size();
@@ -40,9 +40,19 @@ public:
 	/// @param method The rectangle placement rule to use when packing.
 	void Insert(std::vector<RectSize> &rects, std::vector<Rect> &dst, FreeRectChoiceHeuristic method);
 
+	/// Inserts the given list of rectangles online, in their order, until one of them does not fit.
+	/// @param rects The list of rectangles to insert. The inserted ones are removed from its front.
+	/// @param dst [out] This list will contain the packed rectangles, in the order of rects.
+	/// @param method The rectangle placement rule to use when packing.
+	void InsertInOrder(std::vector<RectSize> &rects, std::vector<Rect> &dst, FreeRectChoiceHeuristic method);
+
 	/// Inserts a single rectangle into the bin, possibly rotated.
 	Rect Insert(int width, int height, FreeRectChoiceHeuristic method);
 
+	/// Marks the given rectangle (e.g. one kept from a previous packing) as used, so that following inserts place around it.
+	/// @return false (and nothing is reserved) if the rectangle is not free: outside the bin or overlapping a used one.
+	bool Reserve(const Rect &rect);
+
 	/// Computes the ratio of used surface area to the total bin area.
 	float Occupancy() const;
 
@@ -1,10 +1,18 @@
 #pragma once
+#include <algorithm>
+#include <cctype>
 #include <cmath>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <hb-ft.h>  // HarfBuzz FreeType integration
 #include <hb.h>
 
+#include "../CharSet.h"
+#include "../utils/MappedFile.h"
 #include "../utils/StringMaker.h"
 #include "FtException.h"
 #include "FtInclude.h"
@@ -41,123 +49,105 @@ class Font {
                                    // of a string of text.
         std::int32_t lsbDelta;
         std::int32_t rsbDelta;
+        bool color = false;         // RGBA color glyph (setColorGlyphs), rendered as it is instead of tinted coverage
     };
 
-    Font(Library& library, const std::string& fontFile, int ptsize, const int faceIndex,
+    // The font data is not copied, it must outlive the font.
+    Font(Library& library, const std::uint8_t* data, std::size_t size, int ptsize, const int faceIndex,
          const bool monochrome, const bool light_hinting, const bool no_hinting)
         : library(library), monochrome_(monochrome), light_hinting_(light_hinting), no_hinting_(no_hinting) {
 
         valid = false; // Set to valid once we go through the entire constructor
 
-        if (fontFile.length() == 0) // Keep empty and invalid
+        if (!data || !size) // Keep empty and invalid
             return;
 
         if (!library.library)
             throw std::runtime_error("Library is not initialized");
 
-        auto error = FT_New_Face(library.library, fontFile.c_str(), faceIndex, &face);
+        auto error = FT_New_Memory_Face(library.library, data, static_cast<FT_Long>(size), faceIndex, &face);
         if (error == FT_Err_Unknown_File_Format)
             throw Exception("Unsupported font format", error);
         if (error)
-            throw Exception("Couldn't load font file", error);
+            throw Exception("Couldn't load font data", error);
 
-        if (!face->charmap) {
-            FT_Done_Face(face);
-            throw std::runtime_error("Font doesn't contain a Unicode charmap");
-        }
-
-        if (FT_IS_SCALABLE(face)) {
-            /* Set the character size and use default DPI (72) */
-            error = FT_Set_Pixel_Sizes(face, ptsize, ptsize);
-            if (error) {
-                FT_Done_Face(face);
-                throw Exception("Couldn't set font size", error);
-            }
-
-            /* Get the scalable font metrics for this font */
-            const auto scale = face->size->metrics.y_scale;
-            yMin = FT_FLOOR(FT_MulFix(face->bbox.yMin, scale));
-            yMax = FT_CEIL(FT_MulFix(face->bbox.yMax, scale));
-            // height  = FT_CEIL(FT_MulFix(face->height, scale));
-            height = std::lround(static_cast<float>(face->size->metrics.height) / static_cast<float>(1 << 6));
-            // height =  std::lround(FT_MulFix(face->height, scale) / static_cast<float>(1 << 6));
-            ascent = FT_CEIL(FT_MulFix(face->ascender, scale));
-            // ascent = std::lround(FT_MulFix(face->ascender, scale) / static_cast<float>(1 << 6));
-            descent = FT_FLOOR(FT_MulFix(face->descender, scale));
-        } else {
-            /* Non-scalable font case.  ptsize determines which family
-             * or series of fonts to grab from the non-scalable format.
-             * It is not the point size of the font.
-             * */
-            if (ptsize >= face->num_fixed_sizes)
-                ptsize = face->num_fixed_sizes - 1;
-            font_size_family = ptsize;
-            error =
-                FT_Set_Pixel_Sizes(face, static_cast<FT_UInt>(face->available_sizes[ptsize].width), static_cast<FT_UInt>(face->available_sizes[ptsize].height));
-            // TODO: check error, free font
-
-            /* With non-scalale fonts, Freetype2 likes to fill many of the
-             * font metrics with the value of 0.  The size of the
-             * non-scalable fonts must be determined differently
-             * or sometimes cannot be determined.
-             * */
-            height = face->available_sizes[ptsize].height;
-            yMax = height;
-            yMin = 0;
-            ascent = height;
-            descent = 0;
-        }
-
-        /* Initialize the font face style */
-        face_style = TTF_STYLE_NORMAL;
-        if (face->style_flags & FT_STYLE_FLAG_BOLD)
-            face_style |= TTF_STYLE_BOLD;
-
-        if (face->style_flags & FT_STYLE_FLAG_ITALIC)
-            face_style |= TTF_STYLE_ITALIC;
-
-        /* Set the default font style */
-        style = face_style;
-        outline = 0;
-        kerning = 1;
-        glyph_overhang = face->size->metrics.y_ppem / 10;
-        /* x offset = cos(((90.0-12)/360)*2*M_PI), or 12 degree angle */
-        glyph_italics = 0.207f;
-        glyph_italics *= height;
-
-        totalHeight = yMax - yMin;
+        init(ptsize);
+    }
 
-        valid = true;
+    // Keeps the mapped file alive as long as the font, a null file keeps the font empty and invalid.
+    Font(Library& library, std::shared_ptr<const MappedFile> file, int ptsize, const int faceIndex,
+         const bool monochrome, const bool light_hinting, const bool no_hinting)
+        : Font(library, file ? file->data() : nullptr, file ? file->size() : 0, ptsize, faceIndex, monochrome, light_hinting, no_hinting) {
+        file_ = std::move(file);
     }
 
+    Font(const Font&) = delete;
+    Font& operator = (const Font&) = delete;
+
     ~Font() {
         FT_Done_Face(face);
     }
 
-    GlyphMetrics renderGlyph(std::uint32_t* buffer, std::uint32_t surfaceW, std::uint32_t surfaceH, int x, int y, std::uint32_t glyph, std::uint32_t color) const {
-        FT_Int32 loadFlags = FT_LOAD_RENDER;
+    // subpixelShift moves the outline right by 1/64 pixel units before rasterizing (subpixel positioned
+    // variants), horiBearingX then follows the rendered bitmap. Bitmap glyphs are not shifted.
+    GlyphMetrics renderGlyph(std::uint32_t* buffer, std::uint32_t surfaceW, std::uint32_t surfaceH, int x, int y, std::uint32_t glyph, std::uint32_t color,
+                             int subpixelShift = 0) const {
+        FT_Int32 loadFlags = subpixelShift ? FT_LOAD_DEFAULT : FT_LOAD_RENDER;
+        if (color_glyphs_)
+            loadFlags |= FT_LOAD_COLOR;
         if (monochrome_)
             loadFlags |= FT_LOAD_TARGET_MONO | (no_hinting_ ? 0 : FT_LOAD_FORCE_AUTOHINT);
         else
             loadFlags |= (light_hinting_ ? FT_LOAD_TARGET_LIGHT : (no_hinting_ ? 0 : FT_LOAD_FORCE_AUTOHINT));
 
-        const int error = FT_Load_Glyph(face, glyph, loadFlags);
+        int error = FT_Load_Glyph(face, glyph, loadFlags);
         if (error)
             throw std::runtime_error(StringMaker() << "Error Load glyph " << glyph << " " << error);
 
         auto slot = face->glyph;
         const auto metrics = &slot->metrics;
 
+        // Whole pixels the bitmap moved by the shift
+        int shiftedLeft = 0;
+        if (subpixelShift) {
+            const bool outline = slot->format == FT_GLYPH_FORMAT_OUTLINE;
+            FT_BBox box{};
+            if (outline) {
+                FT_Outline_Get_CBox(&slot->outline, &box);
+                FT_Outline_Translate(&slot->outline, subpixelShift, 0);
+            }
+            error = FT_Render_Glyph(slot, static_cast<FT_Render_Mode>(FT_LOAD_TARGET_MODE(loadFlags)));
+            if (error)
+                throw std::runtime_error(StringMaker() << "Error Render glyph " << glyph << " " << error);
+            if (outline)
+                shiftedLeft = slot->bitmap_left - FT_FLOOR(box.xMin);
+        }
+
         GlyphMetrics glyphMetrics;
         glyphMetrics.width = slot->bitmap.width;
         glyphMetrics.height = slot->bitmap.rows;
-        glyphMetrics.horiBearingX = FT_FLOOR(metrics->horiBearingX);
+        glyphMetrics.horiBearingX = FT_FLOOR(metrics->horiBearingX) + shiftedLeft;
         glyphMetrics.horiBearingY = FT_FLOOR(metrics->horiBearingY);
         glyphMetrics.horiAdvance = FT_CEIL(metrics->horiAdvance);
         glyphMetrics.lsbDelta = slot->lsb_delta;
         glyphMetrics.rsbDelta = slot->rsb_delta;
+        glyphMetrics.color = slot->bitmap.pixel_mode == FT_PIXEL_MODE_BGRA;
+
+        if (buffer && glyphMetrics.color) {
+            const auto dst_check = buffer + surfaceW * surfaceH;
 
-        if (buffer) {
+            // Premultiplied BGRA (CBDT/sbix bitmaps, COLR layers) to straight RGBA
+            for (std::uint32_t row = 0; row < glyphMetrics.height; ++row) {
+                std::uint32_t* dst = buffer + (y + row) * surfaceW + x;
+                const std::uint8_t* src = slot->bitmap.buffer + slot->bitmap.pitch * static_cast<int>(row);
+                for (std::uint32_t col = 0; col < glyphMetrics.width && dst < dst_check; ++col, src += 4) {
+                    const std::uint32_t alpha = src[3];
+                    const auto unpremultiply = [alpha](const std::uint32_t c) { return alpha ? std::min(c * 255u / alpha, 255u) : 0u; };
+                    *dst++ = unpremultiply(src[2]) | (unpremultiply(src[1]) << 8u) | (unpremultiply(src[0]) << 16u) | (alpha << 24u);
+                }
+            }
+        }
+        else if (buffer) {
             const auto dst_check = buffer + surfaceW * surfaceH;
             color &= 0xffffffu;
 
@@ -183,14 +173,83 @@ class Font {
         return glyphMetrics;
     }
 
+    // 8 bit coverage of a glyph outline grown by radius (1/64 pixel units) with FT_Stroker (--outline).
+    // left and top place it relative to the bitmap renderGlyph makes with the same subpixelShift.
+    struct StrokeBitmap {
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        int left = 0;
+        int top = 0;
+        std::vector<std::uint8_t> pixels;
+    };
+
+    // Empty for glyphs without an outline (bitmap fonts).
+    StrokeBitmap renderStroke(std::uint32_t glyph, int radius, int subpixelShift = 0) const {
+        FT_Int32 loadFlags = FT_LOAD_DEFAULT;
+        if (monochrome_)
+            loadFlags |= FT_LOAD_TARGET_MONO | (no_hinting_ ? 0 : FT_LOAD_FORCE_AUTOHINT);
+        else
+            loadFlags |= (light_hinting_ ? FT_LOAD_TARGET_LIGHT : (no_hinting_ ? 0 : FT_LOAD_FORCE_AUTOHINT));
+
+        int error = FT_Load_Glyph(face, glyph, loadFlags);
+        if (error)
+            throw std::runtime_error(StringMaker() << "Error Load glyph " << glyph << " " << error);
+        const auto slot = face->glyph;
+        if (slot->format != FT_GLYPH_FORMAT_OUTLINE)
+            return StrokeBitmap();
+        if (subpixelShift)
+            FT_Outline_Translate(&slot->outline, subpixelShift, 0);
+
+        const auto done = [](FT_Glyph* g) { FT_Done_Glyph(*g); };
+        FT_Glyph fill = nullptr;
+        FT_Glyph stroke = nullptr;
+        if (FT_Get_Glyph(slot, &fill))
+            throw std::runtime_error(StringMaker() << "Error Get glyph " << glyph);
+        const std::unique_ptr<FT_Glyph, decltype(done)> fillGuard(&fill, done);
+        if (FT_Glyph_Copy(fill, &stroke))
+            throw std::runtime_error(StringMaker() << "Error Copy glyph " << glyph);
+        const std::unique_ptr<FT_Glyph, decltype(done)> strokeGuard(&stroke, done);
+
+        FT_Stroker stroker = nullptr;
+        if (FT_Stroker_New(library.library, &stroker))
+            throw std::runtime_error("Error create stroker");
+        FT_Stroker_Set(stroker, radius, FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
+        error = FT_Glyph_StrokeBorder(&stroke, stroker, false, true);
+        FT_Stroker_Done(stroker);
+        if (error)
+            throw std::runtime_error(StringMaker() << "Error Stroke glyph " << glyph << " " << error);
+
+        // The fill is rendered again only for its position, the same way renderGlyph places it
+        const auto renderMode = static_cast<FT_Render_Mode>(FT_LOAD_TARGET_MODE(loadFlags));
+        if (FT_Glyph_To_Bitmap(&fill, renderMode, nullptr, true) || FT_Glyph_To_Bitmap(&stroke, renderMode, nullptr, true))
+            throw std::runtime_error(StringMaker() << "Error Render glyph " << glyph);
+        const auto fillBitmap = reinterpret_cast<FT_BitmapGlyph>(fill);
+        const auto strokeBitmap = reinterpret_cast<FT_BitmapGlyph>(stroke);
+        const auto& bitmap = strokeBitmap->bitmap;
+
+        StrokeBitmap result;
+        result.width = bitmap.width;
+        result.height = bitmap.rows;
+        result.left = strokeBitmap->left - fillBitmap->left;
+        result.top = fillBitmap->top - strokeBitmap->top;
+        result.pixels.resize(static_cast<std::size_t>(result.width) * result.height);
+        for (std::uint32_t row = 0; row < result.height; ++row) {
+            const std::uint8_t* src = bitmap.buffer + bitmap.pitch * static_cast<int>(row);
+            auto dst = result.pixels.data() + static_cast<std::size_t>(row) * result.width;
+            for (std::uint32_t col = 0; col < result.width; ++col)
+                dst[col] = bitmap.pixel_mode == FT_PIXEL_MODE_MONO ? ((src[col / 8] & (0x80u >> (col % 8))) ? 0xff : 0x00) : src[col];
+        }
+        return result;
+    }
+
     enum class KerningMode {
         Basic,
         Regular,
         Extended
     };
 
-    std::set<std::uint32_t> collectChars() const {
-        std::set<std::uint32_t> chars;
+    CharSet collectChars() const {
+        CharSet chars;
         FT_UInt glyphIndex = 0;
         uint32_t utf32 = FT_Get_First_Char(face, &glyphIndex);
         while(glyphIndex) {
@@ -295,11 +354,82 @@ class Font {
     }
 
     std::string getStyleNameOr(const std::string& defaultName) const {
+        if (!instanceName_.empty())
+            return instanceName_;
         if (!face->style_name)
             return defaultName;
         return std::string(face->style_name);
     }
 
+    // Variable fonts: selects the named instance with the given subfamily name (like "SemiBold", case
+    // insensitive, empty for the default instance), then overrides axes by tag (like "wght", clamped to the
+    // axis range) with FT_Set_Var_Design_Coordinates. Metrics are updated, createHbFont() gets the same variations.
+    void setVariations(const std::string& instanceName, const std::vector<std::pair<std::string, float>>& axes) {
+        FT_MM_Var* mmVar = nullptr;
+        if (!FT_HAS_MULTIPLE_MASTERS(face) || FT_Get_MM_Var(face, &mmVar))
+            throw std::runtime_error("font has no variation axes");
+        const auto done = [this](FT_MM_Var* p) { FT_Done_MM_Var(library.library, p); };
+        const std::unique_ptr<FT_MM_Var, decltype(done)> mm(mmVar, done);
+
+        std::vector<FT_Fixed> coords(mm->num_axis);
+        for (FT_UInt i = 0; i < mm->num_axis; ++i)
+            coords[i] = mm->axis[i].def;
+
+        if (!instanceName.empty()) {
+            FT_UInt n = 0;
+            const auto hasName = [&](const FT_UInt nameId) {
+                const auto names = getSfntNames(nameId);
+                return std::any_of(names.begin(), names.end(), [&](const std::string& name) { return equalNames(name, instanceName); });
+            };
+            while (n < mm->num_namedstyles && !hasName(mm->namedstyle[n].strid))
+                ++n;
+            if (n == mm->num_namedstyles)
+                throw std::runtime_error("named instance " + instanceName + " not found");
+            std::copy(mm->namedstyle[n].coords, mm->namedstyle[n].coords + mm->num_axis, coords.begin());
+        }
+
+        for (const auto& axis : axes) {
+            std::string tag = axis.first;
+            tag.resize(4, ' ');
+            const auto ftTag = FT_MAKE_TAG(tag[0], tag[1], tag[2], tag[3]);
+            FT_UInt i = 0;
+            while (i < mm->num_axis && mm->axis[i].tag != ftTag)
+                ++i;
+            if (i == mm->num_axis)
+                throw std::runtime_error("variation axis " + axis.first + " not found");
+            coords[i] = std::clamp(static_cast<FT_Fixed>(std::lround(axis.second * 65536.0f)), mm->axis[i].minimum, mm->axis[i].maximum);
+        }
+
+        const auto error = FT_Set_Var_Design_Coordinates(face, mm->num_axis, coords.data());
+        if (error)
+            throw Exception("Couldn't set variation coordinates", error);
+
+        variations_.clear();
+        for (FT_UInt i = 0; i < mm->num_axis; ++i)
+            variations_.push_back({static_cast<hb_tag_t>(mm->axis[i].tag), static_cast<float>(coords[i]) / 65536.0f});
+        instanceName_ = instanceName;
+
+        initMetrics(ptsize_);
+    }
+
+    // HarfBuzz font of the face with the variations of setVariations(), release with hb_font_destroy().
+    hb_font_t* createHbFont() const {
+        auto hbFont = hb_ft_font_create(face, nullptr);
+        if (!variations_.empty())
+            hb_font_set_variations(hbFont, variations_.data(), static_cast<unsigned int>(variations_.size()));
+        return hbFont;
+    }
+
+    // Faces in the font file (more than 1 for TTC/OTC collections).
+    int getFaceCount() const {
+        return valid ? static_cast<int>(face->num_faces) : 0;
+    }
+
+    // Loads glyphs with FT_LOAD_COLOR: color bitmaps (CBDT, sbix) and COLR layers are rendered in color.
+    void setColorGlyphs(const bool colorGlyphs) {
+        color_glyphs_ = colorGlyphs;
+    }
+
     bool isBold() const {
         return (style & TTF_STYLE_BOLD) != 0;
     }
@@ -327,6 +457,7 @@ class Font {
     bool monochrome_;
     bool light_hinting_;
     bool no_hinting_;
+    bool color_glyphs_ = false;
 
     /* Whether kerning is desired */
     int kerning;
@@ -336,6 +467,122 @@ class Font {
     float glyph_italics;
 
     bool valid;
+
+private:
+    std::shared_ptr<const MappedFile> file_; // set when the face is created over a mapped file
+    int ptsize_ = 0;
+    std::vector<hb_variation_t> variations_;
+    std::string instanceName_;
+
+    // Name table entries of every language (Windows UTF-16BE and Mac Roman names), non ASCII characters read as '?'.
+    std::vector<std::string> getSfntNames(const FT_UInt nameId) const {
+        std::vector<std::string> result;
+        const auto count = FT_Get_Sfnt_Name_Count(face);
+        for (FT_UInt i = 0; i < count; ++i) {
+            FT_SfntName name;
+            if (FT_Get_Sfnt_Name(face, i, &name) || name.name_id != nameId)
+                continue;
+            if (name.platform_id == TT_PLATFORM_MICROSOFT) {
+                std::string s;
+                for (FT_UInt k = 0; k + 1 < name.string_len; k += 2)
+                    s.push_back(name.string[k] ? '?' : static_cast<char>(name.string[k + 1]));
+                result.push_back(s);
+            } else if (name.platform_id == TT_PLATFORM_MACINTOSH) {
+                result.emplace_back(reinterpret_cast<const char*>(name.string), name.string_len);
+            }
+        }
+        return result;
+    }
+
+    static bool equalNames(const std::string& a, const std::string& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const char x, const char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+
+    void init(int ptsize) {
+        if (!face->charmap) {
+            FT_Done_Face(face);
+            throw std::runtime_error("Font doesn't contain a Unicode charmap");
+        }
+
+        // The destructor does not run for a throwing constructor, the face is freed here
+        try {
+            initMetrics(ptsize);
+        } catch (...) {
+            FT_Done_Face(face);
+            throw;
+        }
+
+        /* Initialize the font face style */
+        face_style = TTF_STYLE_NORMAL;
+        if (face->style_flags & FT_STYLE_FLAG_BOLD)
+            face_style |= TTF_STYLE_BOLD;
+
+        if (face->style_flags & FT_STYLE_FLAG_ITALIC)
+            face_style |= TTF_STYLE_ITALIC;
+
+        /* Set the default font style */
+        style = face_style;
+        outline = 0;
+        kerning = 1;
+
+        valid = true;
+    }
+
+    // Sets the size and the metrics following from it (and from the variations). Never frees the face,
+    // so setVariations() can call it again on a constructed font.
+    void initMetrics(int ptsize) {
+        FT_Error error;
+        ptsize_ = ptsize;
+
+        if (FT_IS_SCALABLE(face)) {
+            /* Set the character size and use default DPI (72) */
+            error = FT_Set_Pixel_Sizes(face, ptsize, ptsize);
+            if (error)
+                throw Exception("Couldn't set font size", error);
+
+            /* Get the scalable font metrics for this font */
+            const auto scale = face->size->metrics.y_scale;
+            yMin = FT_FLOOR(FT_MulFix(face->bbox.yMin, scale));
+            yMax = FT_CEIL(FT_MulFix(face->bbox.yMax, scale));
+            // height  = FT_CEIL(FT_MulFix(face->height, scale));
+            height = std::lround(static_cast<float>(face->size->metrics.height) / static_cast<float>(1 << 6));
+            // height =  std::lround(FT_MulFix(face->height, scale) / static_cast<float>(1 << 6));
+            ascent = FT_CEIL(FT_MulFix(face->ascender, scale));
+            // ascent = std::lround(FT_MulFix(face->ascender, scale) / static_cast<float>(1 << 6));
+            descent = FT_FLOOR(FT_MulFix(face->descender, scale));
+        } else {
+            /* Non-scalable font case.  ptsize determines which family
+             * or series of fonts to grab from the non-scalable format.
+             * It is not the point size of the font.
+             * */
+            if (ptsize >= face->num_fixed_sizes)
+                ptsize = face->num_fixed_sizes - 1;
+            font_size_family = ptsize;
+            error =
+                FT_Set_Pixel_Sizes(face, static_cast<FT_UInt>(face->available_sizes[ptsize].width), static_cast<FT_UInt>(face->available_sizes[ptsize].height));
+            // TODO: check error, free font
+
+            /* With non-scalale fonts, Freetype2 likes to fill many of the
+             * font metrics with the value of 0.  The size of the
+             * non-scalable fonts must be determined differently
+             * or sometimes cannot be determined.
+             * */
+            height = face->available_sizes[ptsize].height;
+            yMax = height;
+            yMin = 0;
+            ascent = height;
+            descent = 0;
+        }
+
+        glyph_overhang = face->size->metrics.y_ppem / 10;
+        /* x offset = cos(((90.0-12)/360)*2*M_PI), or 12 degree angle */
+        glyph_italics = 0.207f;
+        glyph_italics *= height;
+
+        totalHeight = yMax - yMin;
+    }
 };
 
 }  // namespace ft
@@ -4,30 +4,18 @@
 
 namespace ft {
 
-int Library::initialized = 0;
-
+// Every instance owns its FreeType library, so independent generations (e.g. in different threads) do not share state.
 Library::Library()
 {
-    if (!initialized)
-    {
-        const auto error = FT_Init_FreeType(&library);
-        if (error)
-            throw Exception("Couldn't init FreeType engine", error);
-    }
-
-    ++initialized;
+    const auto error = FT_Init_FreeType(&library);
+    if (error)
+        throw Exception("Couldn't init FreeType engine", error);
 }
 
 Library::~Library()
 {
-    if (initialized)
-    {
-        if (--initialized == 0)
-        {
-            FT_Done_FreeType(library);
-            library = nullptr;
-        }
-    }
+    FT_Done_FreeType(library);
+    library = nullptr;
 }
 
 std::string Library::getVersionString() const
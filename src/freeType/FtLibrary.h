@@ -18,9 +18,6 @@ public:
     Library& operator=(Library&&) = delete;
 
     std::string getVersionString() const;
-
-private:
-    static int initialized;
 };
 
 }
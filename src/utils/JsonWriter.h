@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Streaming JSON writer, output is formatted the same way as nlohmann::json::dump(indent)
+// (keys are written in the order they are given, so callers must sort them to get identical output).
+class JsonWriter
+{
+public:
+    explicit JsonWriter(std::ostream& os, unsigned int indent = 4) : os(os), indent(indent) {}
+
+    void beginObject()
+    {
+        beginValue();
+        os << '{';
+        counts.push_back(0);
+    }
+
+    void endObject()
+    {
+        end('}');
+    }
+
+    void beginArray()
+    {
+        beginValue();
+        os << '[';
+        counts.push_back(0);
+    }
+
+    void endArray()
+    {
+        end(']');
+    }
+
+    void key(const std::string& name)
+    {
+        beginValue();
+        writeString(name);
+        os << ": ";
+        afterKey = true;
+    }
+
+    template<class T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    void value(T v)
+    {
+        beginValue();
+        if (std::is_signed<T>::value)
+            os << static_cast<std::int64_t>(v);
+        else
+            os << static_cast<std::uint64_t>(v);
+    }
+
+    void value(const std::string& s)
+    {
+        beginValue();
+        writeString(s);
+    }
+
+    void value(const char* s)
+    {
+        value(std::string(s));
+    }
+
+    template<class T>
+    JsonWriter& field(const std::string& name, const T& v)
+    {
+        key(name);
+        value(v);
+        return *this;
+    }
+
+private:
+    void beginValue()
+    {
+        if (afterKey)
+        {
+            afterKey = false;
+            return;
+        }
+        if (counts.empty())
+            return;
+        if (counts.back()++)
+            os << ',';
+        newLine(counts.size());
+    }
+
+    void end(char bracket)
+    {
+        const auto count = counts.back();
+        counts.pop_back();
+        if (count)
+            newLine(counts.size());
+        os << bracket;
+    }
+
+    void newLine(std::size_t level)
+    {
+        os << '\n';
+        for (std::size_t i = 0; i < level * indent; ++i)
+            os << ' ';
+    }
+
+    void writeString(const std::string& s)
+    {
+        static const char hex[] = "0123456789abcdef";
+        os << '"';
+        for (const char ch : s)
+        {
+            const auto c = static_cast<unsigned char>(ch);
+            switch (c)
+            {
+                case '"': os << "\\\""; break;
+                case '\\': os << "\\\\"; break;
+                case '\b': os << "\\b"; break;
+                case '\f': os << "\\f"; break;
+                case '\n': os << "\\n"; break;
+                case '\r': os << "\\r"; break;
+                case '\t': os << "\\t"; break;
+                default:
+                    if (c < 0x20)
+                        os << "\\u00" << hex[c >> 4u] << hex[c & 0xfu];
+                    else
+                        os << ch;
+            }
+        }
+        os << '"';
+    }
+
+    std::ostream& os;
+    const unsigned int indent;
+    std::vector<std::size_t> counts;
+    bool afterKey = false;
+};
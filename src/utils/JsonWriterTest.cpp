@@ -0,0 +1,45 @@
+#include <sstream>
+#include "../external/catch.hpp"
+#include "../external/json.hpp"
+#include "JsonWriter.h"
+
+TEST_CASE("JsonWriter")
+{
+    {
+        std::stringstream ss;
+        JsonWriter j(ss);
+        j.beginObject();
+        j.endObject();
+        REQUIRE(ss.str() == nlohmann::json::object().dump(4));
+    }
+
+    {
+        std::stringstream ss;
+        JsonWriter j(ss);
+        j.beginObject();
+        j.key("a");
+        j.beginArray();
+        j.endArray();
+        j.key("b");
+        j.beginArray();
+        j.value(1);
+        j.value(-2);
+        j.endArray();
+        j.field("c", "q\"\\\n\x01 \xd0\xb6");
+        j.key("d");
+        j.beginArray();
+        j.beginObject();
+        j.field("x", std::uint8_t(200)).field("y", std::int8_t(-5));
+        j.endObject();
+        j.endArray();
+        j.endObject();
+
+        nlohmann::json e;
+        e["a"] = nlohmann::json::array();
+        e["b"] = {1, -2};
+        e["c"] = "q\"\\\n\x01 \xd0\xb6";
+        e["d"] = nlohmann::json::array();
+        e["d"].push_back({{"x", 200}, {"y", -5}});
+        REQUIRE(ss.str() == e.dump(4));
+    }
+}
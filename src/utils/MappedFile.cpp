@@ -0,0 +1,88 @@
+#include "MappedFile.h"
+#include <stdexcept>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+    {
+        file_ = nullptr;
+        throw std::runtime_error("can not open file " + path);
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size))
+    {
+        CloseHandle(file_);
+        throw std::runtime_error("can not get size of file " + path);
+    }
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    if (!size_)
+        return; // empty files can not be mapped
+
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_)
+        data_ = static_cast<const std::uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!data_)
+    {
+        if (mapping_)
+            CloseHandle(mapping_);
+        CloseHandle(file_);
+        throw std::runtime_error("can not map file " + path);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    if (file_)
+        CloseHandle(file_);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("can not open file " + path);
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+    {
+        close(fd);
+        throw std::runtime_error("can not get size of file " + path);
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_)
+    {
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("can not map file " + path);
+        }
+        data_ = static_cast<const std::uint8_t*>(p);
+    }
+    close(fd); // the mapping stays valid
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+        munmap(const_cast<std::uint8_t*>(data_), size_);
+}
+
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+inline std::string encodeBase64(const std::uint8_t* data, const std::size_t size)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string result;
+    result.reserve((size + 2) / 3 * 4);
+    std::size_t i = 0;
+    for (; i + 2 < size; i += 3)
+    {
+        const std::uint32_t v = (data[i] << 16u) | (data[i + 1] << 8u) | data[i + 2];
+        result += alphabet[v >> 18u];
+        result += alphabet[(v >> 12u) & 0x3fu];
+        result += alphabet[(v >> 6u) & 0x3fu];
+        result += alphabet[v & 0x3fu];
+    }
+    if (i < size)
+    {
+        const std::uint32_t v = (data[i] << 16u) | (i + 1 < size ? data[i + 1] << 8u : 0u);
+        result += alphabet[v >> 18u];
+        result += alphabet[(v >> 12u) & 0x3fu];
+        result += i + 1 < size ? alphabet[(v >> 6u) & 0x3fu] : '=';
+        result += '=';
+    }
+
+    return result;
+}
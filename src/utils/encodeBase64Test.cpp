@@ -0,0 +1,21 @@
+#include "../external/catch.hpp"
+#include "encodeBase64.h"
+
+TEST_CASE("encodeBase64")
+{
+    const auto encode = [](const std::string& s)
+    {
+        return encodeBase64(reinterpret_cast<const std::uint8_t*>(s.data()), s.size());
+    };
+
+    REQUIRE(encode("") == "");
+    REQUIRE(encode("f") == "Zg==");
+    REQUIRE(encode("fo") == "Zm8=");
+    REQUIRE(encode("foo") == "Zm9v");
+    REQUIRE(encode("foob") == "Zm9vYg==");
+    REQUIRE(encode("fooba") == "Zm9vYmE=");
+    REQUIRE(encode("foobar") == "Zm9vYmFy");
+
+    const std::uint8_t bytes[] = {0x00, 0xff, 0xfe, 0x80};
+    REQUIRE(encodeBase64(bytes, sizeof(bytes)) == "AP/+gA==");
+}